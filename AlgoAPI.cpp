@@ -8,10 +8,22 @@
 #include "AlgoAPI.hpp"
 #include "log.h"
 #include <dlfcn.h>
+#include <stdlib.h>
+#include <time.h>
 
 namespace test
 {
+    static inline uint64_t clock_ns(clockid_t clock_id)
+    {
+        struct timespec ts;
+        clock_gettime(clock_id, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+
     AlgoAPI::AlgoAPI(char *lib_name)
+        : shared_lib_handle(NULL), get_version(NULL), init(NULL), deinit(NULL),
+          set_param(NULL), get_param(NULL), process(NULL), process_planar(NULL), scratch(NULL),
+          scratch_capacity(0), stats(NULL), profiling(false)
     {
         shared_lib_handle = dlopen(lib_name, RTLD_LAZY);
         if (!shared_lib_handle) {
@@ -56,10 +68,23 @@ namespace test
             LOGE("Failed to get algo_process");
             return;
         }
+
+        // the optional entries last, a plugin without them is still usable
+        get_param = (AlgoGetParamFunc)dlsym(shared_lib_handle, "algo_get_param");
+        if (!get_param) {
+            LOGI("%s has no algo_get_param, its params can not be read back", lib_name);
+        }
+
+        process_planar = (AlgoProcessPlanarFunc)dlsym(shared_lib_handle, "algo_process_planar");
+        if (!process_planar) {
+            LOGI("%s has no algo_process_planar, it takes one handle per channel", lib_name);
+        }
     }
 
     AlgoAPI::~AlgoAPI()
     {
+        delete stats;
+        free(scratch);
         if (shared_lib_handle) {
             dlclose(shared_lib_handle);
         }
@@ -89,6 +114,9 @@ namespace test
             LOGE("deinit is NULL");
             return;
         }
+        if (stats) {
+            stats->release(algo_handle);
+        }
         deinit(algo_handle);
     }
 
@@ -101,12 +129,173 @@ namespace test
         return set_param(algo_handle, cmd, param, param_size);
     }
 
+    int AlgoAPI::get_algo_param(void *algo_handle, algo_param_t cmd, void *param, uint32_t param_size)
+    {
+        if (get_param == NULL) {
+            LOGW("get_param is NULL, the library has no algo_get_param");
+            return -1;
+        }
+        return get_param(algo_handle, cmd, param, param_size);
+    }
+
     int AlgoAPI::algo_process(void *algo_handle, void *input, void *output, int block_size)
     {
         if (process == NULL) {
-            LOGE("process is NULL");
+            LOGE_RATE(1, "process is NULL");
             return -1;
         }
+        if (__builtin_expect(profiling.load(std::memory_order_acquire), 0)) {
+            return profiled_process(algo_handle, input, output, block_size);
+        }
         return process(algo_handle, input, output, block_size);
     }
+
+    bool AlgoAPI::has_get_param()
+    {
+        return get_param != NULL;
+    }
+
+    bool AlgoAPI::has_planar_process()
+    {
+        return process_planar != NULL;
+    }
+
+    // interleaved callers need planar staging, allocate it here and not on the audio thread
+    int AlgoAPI::prepare_interleaved(int max_channels, int max_frames)
+    {
+        if (max_channels <= 0 || max_channels > ALGO_MAX_CHANNELS || max_frames <= 0) {
+            LOGE("max_channels %d or max_frames %d is invalid", max_channels, max_frames);
+            return -1;
+        }
+        if ((size_t)max_channels * max_frames <= scratch_capacity) {
+            return 0;
+        }
+        float *buf = (float *)calloc((size_t)max_channels * max_frames, sizeof(float));
+        if (buf == NULL) {
+            LOGE("allocate %d x %d samples failed", max_channels, max_frames);
+            return -1;
+        }
+        free(scratch);
+        scratch = buf;
+        scratch_capacity = (size_t)max_channels * max_frames;
+        return 0;
+    }
+
+    int AlgoAPI::run_planar(void *algo_handle, const float *const *input, float *const *output, int channels, int frames)
+    {
+        if (process_planar) {
+            return process_planar(algo_handle, input, output, channels, frames);
+        }
+        // a mono plugin keeps filter and delay state per handle, one handle can not take several channels
+        if (channels != 1) {
+            LOGE_RATE(1, "%d channels need algo_process_planar, the plugin only has algo_process", channels);
+            return -1;
+        }
+        return process(algo_handle, (void *)input[0], output[0], frames);
+    }
+
+    int AlgoAPI::algo_process_planar(void *algo_handle, const float *const *input, float *const *output,
+                                     int channels, int frames)
+    {
+        if (process == NULL) {
+            LOGE_RATE(1, "process is NULL");
+            return -1;
+        }
+        if (__builtin_expect(profiling.load(std::memory_order_acquire), 0)) {
+            uint64_t wall_start = clock_ns(CLOCK_MONOTONIC);
+            uint64_t cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+            int ret = run_planar(algo_handle, input, output, channels, frames);
+            uint64_t cpu_end = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+            stats->record(algo_handle, frames, clock_ns(CLOCK_MONOTONIC) - wall_start, cpu_end - cpu_start);
+            return ret;
+        }
+        return run_planar(algo_handle, input, output, channels, frames);
+    }
+
+    int AlgoAPI::algo_process_interleaved(void *algo_handle, const float *input, float *output, int channels, int frames)
+    {
+        if (process == NULL) {
+            LOGE_RATE(1, "process is NULL");
+            return -1;
+        }
+        if (channels == 1) {
+            // mono interleaved is already planar, no staging
+            return algo_process(algo_handle, (void *)input, output, frames);
+        }
+        if (channels <= 0 || channels > ALGO_MAX_CHANNELS || frames <= 0 ||
+            (size_t)channels * frames > scratch_capacity) {
+            LOGE_RATE(1, "%d x %d does not fit, call prepare_interleaved first", channels, frames);
+            return -1;
+        }
+
+        // one pass to split, the plugin works in place on the staging planes, one pass to merge
+        const float *in_planes[ALGO_MAX_CHANNELS];
+        float *planes[ALGO_MAX_CHANNELS];
+        for (int ch = 0; ch < channels; ch++) {
+            planes[ch] = scratch + (size_t)ch * frames;
+            in_planes[ch] = planes[ch];
+        }
+        for (int i = 0; i < frames; i++) {
+            const float *frame = input + (size_t)i * channels;
+            for (int ch = 0; ch < channels; ch++) {
+                planes[ch][i] = frame[ch];
+            }
+        }
+        int ret = algo_process_planar(algo_handle, in_planes, planes, channels, frames);
+        for (int i = 0; i < frames; i++) {
+            float *frame = output + (size_t)i * channels;
+            for (int ch = 0; ch < channels; ch++) {
+                frame[ch] = planes[ch][i];
+            }
+        }
+        return ret;
+    }
+
+    int AlgoAPI::profiled_process(void *algo_handle, void *input, void *output, int block_size)
+    {
+        uint64_t wall_start = clock_ns(CLOCK_MONOTONIC);
+        uint64_t cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+        int ret = process(algo_handle, input, output, block_size);
+        uint64_t cpu_end = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+        uint64_t wall_end = clock_ns(CLOCK_MONOTONIC);
+        stats->record(algo_handle, block_size, wall_end - wall_start, cpu_end - cpu_start);
+        return ret;
+    }
+
+    // block_size passed to algo_process is taken as frames at sample_rate to derive the budget
+    int AlgoAPI::enable_profiling(int sample_rate, int dump_interval_ms)
+    {
+        if (stats == NULL) {
+            stats = new AlgoStats(sample_rate);
+        }
+        if (dump_interval_ms > 0) {
+            stats->start_dump("algo", dump_interval_ms);
+        }
+        profiling.store(true, std::memory_order_release);
+        return 0;
+    }
+
+    void AlgoAPI::disable_profiling()
+    {
+        profiling.store(false, std::memory_order_release);
+        if (stats) {
+            stats->stop_dump();
+        }
+    }
+
+    int AlgoAPI::get_algo_stats(void *algo_handle, algo_stats_t *algo_stats)
+    {
+        if (stats == NULL) {
+            LOGE("profiling is not enabled");
+            return -1;
+        }
+        return stats->get_stats(algo_handle, algo_stats);
+    }
+
+    void AlgoAPI::reset_algo_stats(void *algo_handle)
+    {
+        if (stats) {
+            stats->reset(algo_handle);
+        }
+    }
 }
@@ -9,6 +9,8 @@
 #ifndef _ALGO_API_H
 #define _ALGO_API_H
 
+#include "AlgoStats.hpp"
+#include "algo_limits.h"
 #include <stdint.h>
 
 typedef enum algo_param {
@@ -27,7 +29,10 @@ namespace test
     typedef void *(*AlgoInitFunc)();
     typedef void (*AlgoDeinitFunc)(void *algo_handle);
     typedef int (*AlgoSetParamFunc)(void *algo_handle, algo_param_t cmd, void *param, uint32_t param_size);
+    typedef int (*AlgoGetParamFunc)(void *algo_handle, algo_param_t cmd, void *param, uint32_t param_size);
     typedef int (*AlgoProcessFunc)(void *algo_handle, void *input, void *output, int block_size);
+    typedef int (*AlgoProcessPlanarFunc)(void *algo_handle, const float *const *input, float *const *output,
+                                         int channels, int frames);
 #ifdef __cplusplus
     }
 #endif
@@ -41,15 +46,35 @@ namespace test
         void *algo_init();
         void algo_deinit(void *algo_handle);
         int set_algo_param(void *algo_handle, algo_param_t cmd, void *param, uint32_t param_size);
+        int get_algo_param(void *algo_handle, algo_param_t cmd, void *param, uint32_t param_size);
         int algo_process(void *algo_handle, void *input, void *output, int block_size);
+        bool has_get_param();
+        bool has_planar_process();
+        int prepare_interleaved(int max_channels, int max_frames);
+        int algo_process_planar(void *algo_handle, const float *const *input, float *const *output,
+                                int channels, int frames);
+        int algo_process_interleaved(void *algo_handle, const float *input, float *output, int channels, int frames);
+        int enable_profiling(int sample_rate, int dump_interval_ms);
+        void disable_profiling();
+        int get_algo_stats(void *algo_handle, algo_stats_t *stats);
+        void reset_algo_stats(void *algo_handle);
         void *shared_lib_handle;
 
     private:
+        int profiled_process(void *algo_handle, void *input, void *output, int block_size);
+        int run_planar(void *algo_handle, const float *const *input, float *const *output, int channels, int frames);
+
         AlgoGetVersionFunc get_version;
         AlgoInitFunc init;
         AlgoDeinitFunc deinit;
         AlgoSetParamFunc set_param;
+        AlgoGetParamFunc get_param;           // optional, NULL when params can not be read back
         AlgoProcessFunc process;
+        AlgoProcessPlanarFunc process_planar; // optional, NULL for mono only plugins
+        float *scratch;                       // planar staging for interleaved callers
+        size_t scratch_capacity;              // samples in scratch, any channels x frames up to it fits
+        AlgoStats *stats;     // kept until destruction, the audio thread may still hold it
+        std::atomic<bool> profiling;
     };
 
 }
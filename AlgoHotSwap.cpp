@@ -0,0 +1,228 @@
+/* **************************************************************
+ * @Description: hot swap of algorithm shared libraries
+ * @Date: 2026-10-19 10:20:05
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+#include "AlgoHotSwap.hpp"
+#include "log.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MAX_MIGRATE_PARAM_SIZE 1024
+
+namespace test
+{
+    AlgoHotSwap::AlgoHotSwap(char *lib_name, int max_block_size, int crossfade_samples)
+        : swap_state(SWAP_IDLE), max_block_size(max_block_size),
+          crossfade_samples(crossfade_samples > 0 ? crossfade_samples : 1), fade_pos(0), fade_buf(NULL)
+    {
+        active.api = NULL;
+        active.handle = NULL;
+        next = retired = active;
+
+        if (max_block_size <= 0) {
+            LOGE("max_block_size %d is invalid", max_block_size);
+            return;
+        }
+        // the crossfade scratch buffer is the only audio buffer, allocate it up front
+        fade_buf = (float *)calloc(max_block_size, sizeof(float));
+        if (fade_buf == NULL) {
+            LOGE("allocate %d samples for fade_buf failed", max_block_size);
+            return;
+        }
+
+        active.api = new AlgoAPI(lib_name);
+        if (active.api->shared_lib_handle == NULL || (active.handle = active.api->algo_init()) == NULL) {
+            LOGE("Failed to start %s", lib_name);
+            release_slot(&active);
+        }
+    }
+
+    AlgoHotSwap::~AlgoHotSwap()
+    {
+        release_slot(&retired);
+        release_slot(&next);
+        release_slot(&active);
+        free(fade_buf);
+    }
+
+    void AlgoHotSwap::release_slot(algo_slot_t *slot)
+    {
+        if (slot->api) {
+            if (slot->handle) {
+                slot->api->algo_deinit(slot->handle);
+            }
+            delete slot->api;
+        }
+        slot->api = NULL;
+        slot->handle = NULL;
+    }
+
+    bool AlgoHotSwap::is_ready()
+    {
+        return fade_buf != NULL && active.handle != NULL;
+    }
+
+    int AlgoHotSwap::get_algo_version(char *version)
+    {
+        if (!is_ready() || swap_state.load(std::memory_order_acquire) != SWAP_IDLE) {
+            return -1;
+        }
+        return active.api->get_algo_version(version);
+    }
+
+    int AlgoHotSwap::set_algo_param(algo_param_t cmd, void *param, uint32_t param_size)
+    {
+        reclaim();
+        // during a swap the audio thread owns the choice of active library
+        if (!is_ready() || swap_state.load(std::memory_order_acquire) != SWAP_IDLE) {
+            LOGE("set param cmd %d rejected, swap in progress", cmd);
+            return -1;
+        }
+        return active.api->set_algo_param(active.handle, cmd, param, param_size);
+    }
+
+    int AlgoHotSwap::get_algo_param(algo_param_t cmd, void *param, uint32_t param_size)
+    {
+        reclaim();
+        if (!is_ready() || swap_state.load(std::memory_order_acquire) != SWAP_IDLE) {
+            LOGE("get param cmd %d rejected, swap in progress", cmd);
+            return -1;
+        }
+        return active.api->get_algo_param(active.handle, cmd, param, param_size);
+    }
+
+    int AlgoHotSwap::swap_library(char *lib_name, const algo_param_desc_t *params, int param_count)
+    {
+        reclaim();
+        if (!is_ready()) {
+            LOGE("hot swap is not ready");
+            return -1;
+        }
+        if (swap_state.load(std::memory_order_acquire) != SWAP_IDLE) {
+            LOGE("previous swap still in progress");
+            return -1;
+        }
+
+        // loaded next to the old one, so the old library keeps its own symbols
+        algo_slot_t slot = {new AlgoAPI(lib_name), NULL};
+        if (slot.api->shared_lib_handle == NULL || (slot.handle = slot.api->algo_init()) == NULL) {
+            LOGE("Failed to start %s", lib_name);
+            release_slot(&slot);
+            return -1;
+        }
+
+        char version[128] = {0};
+        if (slot.api->get_algo_version(version) == 0) {
+            LOGI("swap to %s version %s", lib_name, version);
+        }
+
+        char param_buf[MAX_MIGRATE_PARAM_SIZE];
+        if (param_count > 0 && !active.api->has_get_param()) {
+            LOGW("old library has no algo_get_param, new library keeps its defaults");
+            param_count = 0;
+        }
+        for (int i = 0; i < param_count; i++) {
+            if (params[i].param_size > sizeof(param_buf)) {
+                LOGE("param cmd %d size %u is too large to migrate", params[i].cmd, params[i].param_size);
+                continue;
+            }
+            memset(param_buf, 0, sizeof(param_buf));
+            if (active.api->get_algo_param(active.handle, params[i].cmd, param_buf, params[i].param_size) != 0) {
+                LOGW("get param cmd %d from old library failed, keep default", params[i].cmd);
+                continue;
+            }
+            if (slot.api->set_algo_param(slot.handle, params[i].cmd, param_buf, params[i].param_size) != 0) {
+                LOGW("set param cmd %d to new library failed", params[i].cmd);
+            }
+        }
+
+        next = slot;
+        swap_state.store(SWAP_PENDING, std::memory_order_release);
+        return 0;
+    }
+
+    int AlgoHotSwap::reclaim()
+    {
+        if (swap_state.load(std::memory_order_acquire) != SWAP_RETIRED) {
+            return 0;
+        }
+        release_slot(&retired);
+        swap_state.store(SWAP_IDLE, std::memory_order_release);
+        LOGI("old library released");
+        return 1;
+    }
+
+    bool AlgoHotSwap::wait_swap_done(int timeout_ms)
+    {
+        for (int waited = 0;; waited++) {
+            reclaim();
+            if (swap_state.load(std::memory_order_acquire) == SWAP_IDLE) {
+                return true;
+            }
+            if (waited >= timeout_ms) {
+                return false;
+            }
+            usleep(1000);
+        }
+    }
+
+    int AlgoHotSwap::algo_process(const float *input, float *output, int block_size)
+    {
+        if (active.handle == NULL) {
+            return -1;
+        }
+
+        int state = swap_state.load(std::memory_order_acquire);
+        if (state == SWAP_PENDING) {
+            fade_pos = 0;
+            state = SWAP_FADING;
+            swap_state.store(SWAP_FADING, std::memory_order_relaxed);
+        }
+        if (state != SWAP_FADING) {
+            return active.api->algo_process(active.handle, (void *)input, output, block_size);
+        }
+
+        // run both libraries and ramp linearly from old to new, in chunks that fit fade_buf.
+        // the new one runs first, output may be input and the old one overwrites it
+        int ret = 0;
+        for (int done = 0; done < block_size;) {
+            int n = block_size - done;
+            if (n > max_block_size) {
+                n = max_block_size;
+            }
+            float *out = output + done;
+            if (next.api->algo_process(next.handle, (void *)(input + done), fade_buf, n) != 0) {
+                // new library cannot process, abort the swap and keep the old one
+                retired = next;
+                next.api = NULL;
+                next.handle = NULL;
+                swap_state.store(SWAP_RETIRED, std::memory_order_release);
+                return ret | active.api->algo_process(active.handle, (void *)(input + done), out, block_size - done);
+            }
+            ret |= active.api->algo_process(active.handle, (void *)(input + done), out, n);
+            float step = 1.0f / crossfade_samples;
+            float gain = fade_pos * step;
+            for (int i = 0; i < n; i++) {
+                if (gain > 1.0f) {
+                    gain = 1.0f;
+                }
+                out[i] += gain * (fade_buf[i] - out[i]);
+                gain += step;
+            }
+            fade_pos += n;
+            done += n;
+        }
+
+        if (fade_pos >= crossfade_samples) {
+            retired = active;
+            active = next;
+            next.api = NULL;
+            next.handle = NULL;
+            swap_state.store(SWAP_RETIRED, std::memory_order_release);
+        }
+        return ret;
+    }
+}
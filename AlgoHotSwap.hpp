@@ -0,0 +1,77 @@
+/* **************************************************************
+ * @Description: hot swap of algorithm shared libraries
+ * @Date: 2026-10-19 10:12:40
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+
+#ifndef _ALGO_HOT_SWAP_H
+#define _ALGO_HOT_SWAP_H
+
+#include "AlgoAPI.hpp"
+#include <atomic>
+
+namespace test
+{
+    // one parameter to carry over from the old library to the new one
+    typedef struct algo_param_desc {
+        algo_param_t cmd;
+        uint32_t param_size;
+    } algo_param_desc_t;
+
+    /*
+     * Keeps one algorithm running while a new version of its shared library
+     * is loaded beside it.
+     *
+     * Control thread: swap_library() loads and initializes the new library,
+     * migrates parameters and stages it. reclaim() deinits and dlcloses the
+     * old library once the audio thread has let go of it.
+     *
+     * Audio thread: algo_process() runs both libraries for crossfade_samples
+     * and then switches over. It never allocates, locks or dlcloses. output
+     * may be input, as with the libraries themselves.
+     */
+    class AlgoHotSwap
+    {
+    public:
+        AlgoHotSwap(char *lib_name, int max_block_size, int crossfade_samples);
+        ~AlgoHotSwap();
+        bool is_ready();
+        int get_algo_version(char *version);
+        int set_algo_param(algo_param_t cmd, void *param, uint32_t param_size);
+        int get_algo_param(algo_param_t cmd, void *param, uint32_t param_size);
+        int swap_library(char *lib_name, const algo_param_desc_t *params, int param_count);
+        int reclaim();
+        bool wait_swap_done(int timeout_ms);
+        int algo_process(const float *input, float *output, int block_size);
+
+    private:
+        enum {
+            SWAP_IDLE,     // only active is in use
+            SWAP_PENDING,  // next staged by control thread
+            SWAP_FADING,   // audio thread runs active and next
+            SWAP_RETIRED,  // audio thread moved to next, retired can be freed
+        };
+
+        typedef struct algo_slot {
+            AlgoAPI *api;
+            void *handle;
+        } algo_slot_t;
+
+        static void release_slot(algo_slot_t *slot);
+
+        algo_slot_t active;
+        algo_slot_t next;
+        algo_slot_t retired;
+        std::atomic<int> swap_state;
+        int max_block_size;
+        int crossfade_samples;
+        int fade_pos;
+        float *fade_buf;
+
+        AlgoHotSwap(const AlgoHotSwap &) = delete;
+        AlgoHotSwap &operator=(const AlgoHotSwap &) = delete;
+    };
+}
+#endif // _ALGO_HOT_SWAP_H
@@ -0,0 +1,481 @@
+/* **************************************************************
+ * @Description: run an algorithm plugin in a child process
+ * @Date: 2026-10-19 12:58:44
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+#include "AlgoProcessHost.hpp"
+#include "log.h"
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ALGO_HOST_MAGIC 0x414c4748 // "ALGH"
+#define ALGO_HOST_START_TIMEOUT_MS 2000
+#define ALGO_HOST_CTRL_TIMEOUT_MS 1000
+#define ALGO_HOST_DEFAULT_TIMEOUT_US 2000
+#define ALGO_HOST_MIN_FD 10 // the inherited shm fd is moved above stdio and what the child opens early
+
+extern char **environ;
+
+namespace test
+{
+    // shared futexes, the words are in memory mapped by both processes
+    static void futex_wake(std::atomic<uint32_t> *word)
+    {
+        syscall(SYS_futex, (uint32_t *)word, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+    }
+
+    static void futex_wait(std::atomic<uint32_t> *word, uint32_t expected, long timeout_ns)
+    {
+        struct timespec ts = {timeout_ns / 1000000000L, timeout_ns % 1000000000L};
+        syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT, expected, timeout_ns >= 0 ? &ts : NULL, NULL, 0);
+    }
+
+    static long now_ns()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000000L + ts.tv_nsec;
+    }
+
+    // wait until word != value, false on timeout
+    static bool wait_changed(std::atomic<uint32_t> *word, uint32_t value, long timeout_ns)
+    {
+        long deadline = now_ns() + timeout_ns;
+        uint32_t current;
+        while ((current = word->load(std::memory_order_acquire)) == value) {
+            long remain = deadline - now_ns();
+            if (remain <= 0) {
+                return false;
+            }
+            futex_wait(word, current, remain);
+        }
+        return true;
+    }
+
+    static size_t header_size()
+    {
+        return (sizeof(algo_host_shm_t) + 63) & ~(size_t)63;
+    }
+
+    static algo_host_slot_t *shm_slot(algo_host_shm_t *shm, uint32_t seq)
+    {
+        return (algo_host_slot_t *)((char *)shm + header_size() +
+                                    (size_t)(seq & (ALGO_HOST_SLOT_COUNT - 1)) * shm->slot_size);
+    }
+
+    AlgoProcessHost::AlgoProcessHost(char *lib_name, int max_frames, const char *host_exe)
+        : saved_param_count(0), max_frames(max_frames), shm_size(0), shm_fd(-1), shm(NULL), child_pid(-1),
+          alive(false), timeout_us(ALGO_HOST_DEFAULT_TIMEOUT_US), prev_valid(false), prev_seq(0),
+          prev_generation(0), input_acquired(false), drop_buf(NULL), missed_blocks(0)
+    {
+        snprintf(this->lib_name, sizeof(this->lib_name), "%s", lib_name);
+        snprintf(this->host_exe, sizeof(this->host_exe), "%s", host_exe ? host_exe : ALGO_HOST_DEFAULT_EXE);
+        if (max_frames <= 0) {
+            LOGE("max_frames %d is invalid", max_frames);
+            return;
+        }
+
+        size_t slot_size = (sizeof(algo_host_slot_t) + 2 * max_frames * sizeof(float) + 63) & ~(size_t)63;
+        shm_size = header_size() + ALGO_HOST_SLOT_COUNT * slot_size;
+
+        char shm_name[64] = {0};
+        snprintf(shm_name, sizeof(shm_name), "/algo_host.%d.%p", (int)getpid(), (void *)this);
+        int fd = shm_open(shm_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd == -1) {
+            LOGE("Failed to create shared memory: %s. %s", shm_name, strerror(errno));
+            return;
+        }
+        // every child gets the fd, the name is not needed any more
+        shm_unlink(shm_name);
+        shm_fd = fcntl(fd, F_DUPFD_CLOEXEC, ALGO_HOST_MIN_FD);
+        close(fd);
+        if (shm_fd == -1 || ftruncate(shm_fd, shm_size) == -1) {
+            LOGE("Failed to set size of shared memory: %s. %s", shm_name, strerror(errno));
+            return;
+        }
+        void *shm_ptr = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+        if (shm_ptr == MAP_FAILED) {
+            LOGE("Failed to map shared memory %s. %s", shm_name, strerror(errno));
+            return;
+        }
+        // touch every page now so the audio thread never faults them in
+        memset(shm_ptr, 0, shm_size);
+        shm = (algo_host_shm_t *)shm_ptr;
+        shm->magic = ALGO_HOST_MAGIC;
+        shm->max_frames = max_frames;
+        shm->slot_size = slot_size;
+
+        drop_buf = (float *)calloc(max_frames, sizeof(float));
+        if (drop_buf == NULL) {
+            LOGE("allocate %d samples for drop_buf failed", max_frames);
+            return;
+        }
+        start_child();
+    }
+
+    AlgoProcessHost::~AlgoProcessHost()
+    {
+        stop_child();
+        if (shm) {
+            munmap(shm, shm_size);
+        }
+        if (shm_fd != -1) {
+            close(shm_fd);
+        }
+        free(drop_buf);
+    }
+
+    algo_host_slot_t *AlgoProcessHost::slot(uint32_t seq)
+    {
+        return shm_slot(shm, seq);
+    }
+
+    // control thread, the audio thread may be submitting into the ring meanwhile
+    int AlgoProcessHost::start_child()
+    {
+        // the audio thread owns head, a new child just starts from where the producer is
+        shm->tail.store(shm->head.load(std::memory_order_acquire), std::memory_order_release);
+        shm->ctrl_ack.store(shm->ctrl_seq.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        shm->child_ready.store(0);
+        shm->quit.store(0);
+
+        // the new fd number is only known here, it is passed on the command line
+        char fd_arg[16], parent_arg[16];
+        snprintf(fd_arg, sizeof(fd_arg), "%d", shm_fd);
+        snprintf(parent_arg, sizeof(parent_arg), "%d", (int)getpid());
+        char *argv[] = {host_exe, lib_name, fd_arg, parent_arg, NULL};
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        // dup2 onto itself clears FD_CLOEXEC, so only the shm fd is inherited
+        posix_spawn_file_actions_adddup2(&actions, shm_fd, shm_fd);
+        pid_t pid = -1;
+        int err = posix_spawn(&pid, host_exe, &actions, NULL, argv, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (err != 0) {
+            LOGE("spawn %s failed. %s", host_exe, strerror(err));
+            return -1;
+        }
+
+        child_pid.store(pid, std::memory_order_release);
+        if (!wait_changed(&shm->child_ready, 0, ALGO_HOST_START_TIMEOUT_MS * 1000000L) ||
+            shm->child_ready.load() != 1) {
+            LOGE("plugin host for %s failed to start", lib_name);
+            stop_child();
+            return -1;
+        }
+        alive.store(true, std::memory_order_release);
+        LOGI("plugin host for %s running as pid %d", lib_name, (int)pid);
+        return 0;
+    }
+
+    void AlgoProcessHost::stop_child()
+    {
+        alive.store(false, std::memory_order_release);
+        pid_t pid = child_pid.load(std::memory_order_acquire);
+        if (pid <= 0) {
+            return;
+        }
+        shm->quit.store(1, std::memory_order_release);
+        shm->doorbell.fetch_add(1, std::memory_order_release);
+        futex_wake(&shm->doorbell);
+        for (int i = 0; i < 100; i++) {
+            if (waitpid(pid, NULL, WNOHANG) == pid) {
+                child_pid.store(-1, std::memory_order_release);
+                return;
+            }
+            usleep(5000);
+        }
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+        child_pid.store(-1, std::memory_order_release);
+    }
+
+    int AlgoProcessHost::serve(const char *lib_name, int shm_fd, pid_t parent)
+    {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid() != parent) {
+            return 1;
+        }
+        struct stat st;
+        if (fstat(shm_fd, &st) != 0 || (size_t)st.st_size < sizeof(algo_host_shm_t)) {
+            LOGE("fd %d is not the plugin host shared memory", shm_fd);
+            return 1;
+        }
+        void *shm_ptr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+        close(shm_fd);
+        if (shm_ptr == MAP_FAILED) {
+            LOGE("Failed to map the plugin host shared memory. %s", strerror(errno));
+            return 1;
+        }
+        algo_host_shm_t *shm = (algo_host_shm_t *)shm_ptr;
+        if (shm->magic != ALGO_HOST_MAGIC) {
+            LOGE("bad plugin host shared memory magic 0x%x", shm->magic);
+            munmap(shm_ptr, st.st_size);
+            return 1;
+        }
+
+        AlgoAPI api((char *)lib_name);
+        void *handle = api.shared_lib_handle ? api.algo_init() : NULL;
+        shm->child_ready.store(handle ? 1 : 2, std::memory_order_release);
+        futex_wake(&shm->child_ready);
+        if (handle == NULL) {
+            munmap(shm_ptr, st.st_size);
+            return 1;
+        }
+
+        uint32_t tail = shm->tail.load(std::memory_order_acquire);
+        while (!shm->quit.load(std::memory_order_acquire)) {
+            uint32_t bell = shm->doorbell.load(std::memory_order_acquire);
+
+            uint32_t seq = shm->ctrl_seq.load(std::memory_order_acquire);
+            if (seq != shm->ctrl_ack.load(std::memory_order_relaxed)) {
+                if (shm->ctrl_get) {
+                    shm->ctrl_result = api.get_algo_param(handle, (algo_param_t)shm->ctrl_cmd, shm->ctrl_data, shm->ctrl_size);
+                } else {
+                    shm->ctrl_result = api.set_algo_param(handle, (algo_param_t)shm->ctrl_cmd, shm->ctrl_data, shm->ctrl_size);
+                }
+                shm->ctrl_ack.store(seq, std::memory_order_release);
+                futex_wake(&shm->ctrl_ack);
+            }
+
+            // in place: the slot input is processed into the slot output
+            while (tail != shm->head.load(std::memory_order_acquire)) {
+                algo_host_slot_t *s = shm_slot(shm, tail);
+                s->result = api.algo_process(handle, s->input(), s->input() + shm->max_frames, s->frames);
+                tail++;
+                shm->tail.store(tail, std::memory_order_release);
+                futex_wake(&shm->tail);
+            }
+
+            futex_wait(&shm->doorbell, bell, -1);
+        }
+        api.algo_deinit(handle);
+        munmap(shm_ptr, st.st_size);
+        return 0;
+    }
+
+    // control thread only, it is the one that reaps the child
+    bool AlgoProcessHost::child_exited()
+    {
+        pid_t pid = child_pid.load(std::memory_order_acquire);
+        if (pid <= 0) {
+            return true;
+        }
+        int status = 0;
+        if (waitpid(pid, &status, WNOHANG) != pid) {
+            return false;
+        }
+        if (WIFSIGNALED(status)) {
+            LOGE("plugin host for %s killed by signal %d", lib_name, WTERMSIG(status));
+        } else {
+            LOGE("plugin host for %s exited with %d", lib_name, WEXITSTATUS(status));
+        }
+        child_pid.store(-1, std::memory_order_release);
+        return true;
+    }
+
+    bool AlgoProcessHost::is_alive()
+    {
+        if (alive.load(std::memory_order_acquire) && child_exited()) {
+            alive.store(false, std::memory_order_release);
+        }
+        return alive.load(std::memory_order_acquire);
+    }
+
+    int AlgoProcessHost::restart()
+    {
+        if (shm == NULL || drop_buf == NULL) {
+            return -1;
+        }
+        stop_child();
+        // blocks still in flight to the dead child are dropped by the audio thread, not read back
+        shm->generation.fetch_add(1, std::memory_order_release);
+        if (start_child() != 0) {
+            return -1;
+        }
+        for (int i = 0; i < saved_param_count; i++) {
+            if (control(false, (algo_param_t)saved_params[i].cmd, saved_params[i].data, saved_params[i].size) != 0) {
+                LOGW("replay param cmd %d to restarted host failed", saved_params[i].cmd);
+            }
+        }
+        return 0;
+    }
+
+    void AlgoProcessHost::set_timeout_us(int timeout_us)
+    {
+        this->timeout_us = timeout_us > 0 ? timeout_us : ALGO_HOST_DEFAULT_TIMEOUT_US;
+    }
+
+    int AlgoProcessHost::control(bool get, algo_param_t cmd, void *param, uint32_t param_size)
+    {
+        if (!is_alive()) {
+            LOGE("plugin host for %s is not running", lib_name);
+            return -1;
+        }
+        if (param == NULL || param_size > ALGO_HOST_MAX_PARAM_SIZE) {
+            LOGE("param size %u is invalid", param_size);
+            return -1;
+        }
+        shm->ctrl_get = get;
+        shm->ctrl_cmd = cmd;
+        shm->ctrl_size = param_size;
+        if (!get) {
+            memcpy(shm->ctrl_data, param, param_size);
+        }
+        uint32_t seq = shm->ctrl_seq.load(std::memory_order_relaxed) + 1;
+        shm->ctrl_seq.store(seq, std::memory_order_release);
+        shm->doorbell.fetch_add(1, std::memory_order_release);
+        futex_wake(&shm->doorbell);
+
+        uint32_t ack;
+        long deadline = now_ns() + ALGO_HOST_CTRL_TIMEOUT_MS * 1000000L;
+        while ((ack = shm->ctrl_ack.load(std::memory_order_acquire)) != seq) {
+            long remain = deadline - now_ns();
+            if (remain <= 0 || child_exited()) {
+                LOGE("plugin host for %s did not answer cmd %d", lib_name, cmd);
+                return -1;
+            }
+            futex_wait(&shm->ctrl_ack, ack, remain < 10000000L ? remain : 10000000L);
+        }
+        if (get && shm->ctrl_result == 0) {
+            memcpy(param, shm->ctrl_data, param_size);
+        }
+        return shm->ctrl_result;
+    }
+
+    int AlgoProcessHost::set_algo_param(algo_param_t cmd, void *param, uint32_t param_size)
+    {
+        int ret = control(false, cmd, param, param_size);
+        if (ret != 0) {
+            return ret;
+        }
+        int i = 0;
+        while (i < saved_param_count && saved_params[i].cmd != cmd) {
+            i++;
+        }
+        if (i == ALGO_HOST_MAX_SAVED_PARAMS) {
+            LOGW("param cmd %d will not survive a restart", cmd);
+            return ret;
+        }
+        saved_params[i].cmd = cmd;
+        saved_params[i].size = param_size;
+        memcpy(saved_params[i].data, param, param_size);
+        if (i == saved_param_count) {
+            saved_param_count++;
+        }
+        return ret;
+    }
+
+    int AlgoProcessHost::get_algo_param(algo_param_t cmd, void *param, uint32_t param_size)
+    {
+        return control(true, cmd, param, param_size);
+    }
+
+    float *AlgoProcessHost::acquire_input()
+    {
+        if (shm == NULL) {
+            return NULL;
+        }
+        uint32_t head = shm->head.load(std::memory_order_relaxed);
+        uint32_t tail = shm->tail.load(std::memory_order_acquire);
+        input_acquired = alive.load(std::memory_order_acquire) && head - tail < ALGO_HOST_SLOT_COUNT;
+        // with the ring full the block is written to a scratch buffer and dropped
+        return input_acquired ? slot(head)->input() : drop_buf;
+    }
+
+    const float *AlgoProcessHost::submit_and_get_output(int frames, int *out_frames)
+    {
+        *out_frames = 0;
+        if (shm == NULL) {
+            return NULL;
+        }
+        if (frames > max_frames) {
+            frames = max_frames;
+        }
+
+        bool submitted = false;
+        uint32_t generation = shm->generation.load(std::memory_order_acquire);
+        uint32_t head = shm->head.load(std::memory_order_relaxed);
+        if (input_acquired) {
+            slot(head)->frames = frames;
+            shm->head.store(head + 1, std::memory_order_release);
+            shm->doorbell.fetch_add(1, std::memory_order_release);
+            futex_wake(&shm->doorbell);
+            submitted = true;
+            input_acquired = false;
+        }
+
+        // output of the previous block, always exactly one block behind
+        const float *output = NULL;
+        if (prev_valid) {
+            long deadline = now_ns() + timeout_us * 1000L;
+            uint32_t tail;
+            while ((int32_t)((tail = shm->tail.load(std::memory_order_acquire)) - prev_seq) <= 0) {
+                long remain = deadline - now_ns();
+                if (remain <= 0) {
+                    break;
+                }
+                futex_wait(&shm->tail, tail, remain);
+            }
+            // a restart moves tail past blocks the old child never ran, the generation tells them apart
+            if ((int32_t)(tail - prev_seq) > 0 &&
+                shm->generation.load(std::memory_order_acquire) == prev_generation) {
+                algo_host_slot_t *s = slot(prev_seq);
+                if (s->result == 0) {
+                    output = slot_output(s);
+                    *out_frames = s->frames;
+                }
+            } else {
+                missed_blocks.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        prev_valid = submitted;
+        prev_seq = head;
+        prev_generation = generation;
+        return output;
+    }
+
+    int AlgoProcessHost::algo_process(const float *input, float *output, int block_size)
+    {
+        if (block_size <= 0 || block_size > max_frames) {
+            return -1;
+        }
+        float *ring_input = acquire_input();
+        if (ring_input == NULL) {
+            memset(output, 0, block_size * sizeof(float));
+            return -1;
+        }
+        memcpy(ring_input, input, block_size * sizeof(float));
+        int out_frames = 0;
+        const float *ring_output = submit_and_get_output(block_size, &out_frames);
+        if (ring_output == NULL) {
+            memset(output, 0, block_size * sizeof(float));
+            return alive.load(std::memory_order_relaxed) ? 0 : -1;
+        }
+        int n = out_frames < block_size ? out_frames : block_size;
+        memcpy(output, ring_output, n * sizeof(float));
+        if (n < block_size) {
+            memset(output + n, 0, (block_size - n) * sizeof(float));
+        }
+        return 0;
+    }
+}
+
+/* Compile Command:
+Linux:
+    g++ -c -fPIC AlgoProcessHost.cpp AlgoAPI.cpp AlgoStats.cpp log.c
+    link with -ldl -lpthread -lrt
+    g++ algo_host.cpp AlgoProcessHost.cpp AlgoAPI.cpp AlgoStats.cpp log.c -ldl -lpthread -lrt -o algo_host
+*/
@@ -0,0 +1,130 @@
+/* **************************************************************
+ * @Description: run an algorithm plugin in a child process
+ * @Date: 2026-10-19 12:31:07
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+
+#ifndef _ALGO_PROCESS_HOST_H
+#define _ALGO_PROCESS_HOST_H
+
+#include "AlgoAPI.hpp"
+#include <atomic>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define ALGO_HOST_SLOT_COUNT 4     // must be a power of two
+#define ALGO_HOST_MAX_PARAM_SIZE 1024
+#define ALGO_HOST_MAX_SAVED_PARAMS 8  // params replayed into a restarted child
+#define ALGO_HOST_DEFAULT_EXE "./algo_host" // built from algo_host.cpp
+
+namespace test
+{
+    typedef struct algo_host_slot {
+        int32_t frames;
+        int32_t result;
+        float *input()                 { return (float *)(this + 1); }
+    } algo_host_slot_t;
+
+    // lives at the start of the shared memory, slots follow it
+    typedef struct algo_host_shm {
+        uint32_t magic;
+        uint32_t max_frames;
+        uint32_t slot_size;
+        alignas(64) std::atomic<uint32_t> doorbell;   // bumped by server for blocks and commands, child waits on it
+        alignas(64) std::atomic<uint32_t> head;       // blocks submitted by server
+        alignas(64) std::atomic<uint32_t> tail;       // blocks finished by child, server waits on it
+        alignas(64) std::atomic<uint32_t> ctrl_seq;   // command posted by server
+        std::atomic<uint32_t> ctrl_ack;               // command finished by child
+        std::atomic<uint32_t> child_ready;            // 1 running, 2 failed to load the plugin
+        std::atomic<uint32_t> quit;
+        std::atomic<uint32_t> generation;             // bumped by every restart
+        int32_t ctrl_get;
+        int32_t ctrl_cmd;
+        int32_t ctrl_size;
+        int32_t ctrl_result;
+        char ctrl_data[ALGO_HOST_MAX_PARAM_SIZE];
+    } algo_host_shm_t;
+
+    /*
+     * Out-of-process replacement for AlgoAPI. The plugin is dlopened only in
+     * a separate host executable, started with posix_spawn and handed the
+     * shared memory as an inherited fd. Nothing runs between fork and exec,
+     * so the locks other threads of this process hold can not deadlock it.
+     * Blocks travel through a shared memory SPSC ring. The child processes a
+     * block in place, from the input to the output of the same slot, and
+     * each side wakes the other with a futex.
+     *
+     * The server side is pipelined. Each call submits block n and returns the
+     * output of block n-1, so the host adds exactly one block of latency. If
+     * the child misses the deadline or dies, that block is output as silence
+     * and counted, and the audio thread never blocks for longer than the
+     * timeout.
+     *
+     * acquire_input, submit_and_get_output and algo_process belong to the
+     * audio thread. Everything else belongs to one control thread, which is
+     * also the only one that reaps the child. restart() leaves the ring
+     * indices to the audio thread and bumps a generation instead, so a block
+     * submitted to the dead child is dropped and never read back stale.
+     */
+    class AlgoProcessHost
+    {
+    public:
+        AlgoProcessHost(char *lib_name, int max_frames, const char *host_exe = ALGO_HOST_DEFAULT_EXE);
+        ~AlgoProcessHost();
+        bool is_alive();
+        int restart();
+        void set_timeout_us(int timeout_us);
+        int set_algo_param(algo_param_t cmd, void *param, uint32_t param_size);
+        int get_algo_param(algo_param_t cmd, void *param, uint32_t param_size);
+
+        // zero copy path: write straight into the ring, read straight out of it
+        float *acquire_input();
+        const float *submit_and_get_output(int frames, int *out_frames);
+
+        // drop-in path for AlgoAPI style callers, one copy in and one copy out
+        int algo_process(const float *input, float *output, int block_size);
+
+        uint64_t get_missed_blocks() { return missed_blocks.load(std::memory_order_relaxed); }
+
+        // main of the host executable, serves the plugin over the shared memory in shm_fd
+        static int serve(const char *lib_name, int shm_fd, pid_t parent);
+
+    private:
+        int start_child();
+        void stop_child();
+        bool child_exited();
+        int control(bool get, algo_param_t cmd, void *param, uint32_t param_size);
+        algo_host_slot_t *slot(uint32_t seq);
+        float *slot_output(algo_host_slot_t *s) { return s->input() + shm->max_frames; }
+
+        typedef struct saved_param {
+            int cmd;
+            uint32_t size;
+            char data[ALGO_HOST_MAX_PARAM_SIZE];
+        } saved_param_t;
+
+        char lib_name[256];
+        char host_exe[256];
+        saved_param_t saved_params[ALGO_HOST_MAX_SAVED_PARAMS];
+        int saved_param_count;
+        int max_frames;
+        size_t shm_size;
+        int shm_fd;
+        algo_host_shm_t *shm;
+        std::atomic<pid_t> child_pid;
+        std::atomic<bool> alive;
+        int timeout_us;
+        bool prev_valid;
+        uint32_t prev_seq;
+        uint32_t prev_generation;   // generation prev_seq was submitted in
+        bool input_acquired;
+        float *drop_buf;
+        std::atomic<uint64_t> missed_blocks;
+
+        AlgoProcessHost(const AlgoProcessHost &) = delete;
+        AlgoProcessHost &operator=(const AlgoProcessHost &) = delete;
+    };
+}
+#endif // _ALGO_PROCESS_HOST_H
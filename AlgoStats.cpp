@@ -0,0 +1,240 @@
+/* **************************************************************
+ * @Description: per handle latency statistics for algorithm API
+ * @Date: 2026-10-19 11:20:51
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+#include "AlgoStats.hpp"
+#include "log.h"
+#include <chrono>
+
+namespace test
+{
+    AlgoLatencyHistogram::AlgoLatencyHistogram()
+    {
+        reset();
+    }
+
+    int AlgoLatencyHistogram::bucket_index(uint64_t ns)
+    {
+        if (ns < ALGO_HIST_SUB_COUNT) {
+            return (int)ns;
+        }
+        int msb = 63 - __builtin_clzll(ns);
+        int shift = msb - ALGO_HIST_SUB_BITS;
+        return ((shift + 1) << ALGO_HIST_SUB_BITS) + (int)((ns >> shift) - ALGO_HIST_SUB_COUNT);
+    }
+
+    // highest value that falls into the bucket
+    uint64_t AlgoLatencyHistogram::bucket_value(int index)
+    {
+        if (index < ALGO_HIST_SUB_COUNT) {
+            return (uint64_t)index;
+        }
+        int shift = (index >> ALGO_HIST_SUB_BITS) - 1;
+        uint64_t sub = (uint64_t)(index & (ALGO_HIST_SUB_COUNT - 1)) + ALGO_HIST_SUB_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void AlgoLatencyHistogram::record(uint64_t ns)
+    {
+        buckets[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        uint64_t old_max = max_ns.load(std::memory_order_relaxed);
+        while (ns > old_max && !max_ns.compare_exchange_weak(old_max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    void AlgoLatencyHistogram::reset()
+    {
+        for (int i = 0; i < ALGO_HIST_BUCKETS; i++) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+        total.store(0, std::memory_order_relaxed);
+        max_ns.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t AlgoLatencyHistogram::count()
+    {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    uint64_t AlgoLatencyHistogram::max()
+    {
+        return max_ns.load(std::memory_order_relaxed);
+    }
+
+    uint64_t AlgoLatencyHistogram::percentile(double quantile)
+    {
+        uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)(quantile * n);
+        if (rank >= n) {
+            rank = n - 1;
+        }
+        uint64_t seen = 0;
+        for (int i = 0; i < ALGO_HIST_BUCKETS; i++) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen > rank) {
+                uint64_t value = bucket_value(i);
+                return value < max() ? value : max();
+            }
+        }
+        return max();
+    }
+
+    void AlgoLatencyHistogram::get_latency(algo_latency_t *latency)
+    {
+        latency->p50_us = percentile(0.5) / 1000.0;
+        latency->p99_us = percentile(0.99) / 1000.0;
+        latency->p999_us = percentile(0.999) / 1000.0;
+        latency->max_us = max() / 1000.0;
+    }
+
+    AlgoStats::AlgoStats(int sample_rate)
+        : sample_rate(sample_rate > 0 ? sample_rate : 48000), dump_running(false)
+    {
+        for (int i = 0; i < ALGO_STATS_MAX_HANDLES; i++) {
+            slots[i].handle.store(NULL, std::memory_order_relaxed);
+            slots[i].budget_ns.store(0, std::memory_order_relaxed);
+        }
+        reset(NULL);
+    }
+
+    AlgoStats::~AlgoStats()
+    {
+        stop_dump();
+    }
+
+    algo_handle_stats_t *AlgoStats::find(void *algo_handle, bool claim)
+    {
+        for (int i = 0; i < ALGO_STATS_MAX_HANDLES; i++) {
+            if (slots[i].handle.load(std::memory_order_acquire) == algo_handle) {
+                return &slots[i];
+            }
+        }
+        if (!claim) {
+            return NULL;
+        }
+        // every claimer tries the free slots in the same order, so whoever loses the CAS
+        // on a slot sees there the handle another thread just claimed for the same caller
+        for (int i = 0; i < ALGO_STATS_MAX_HANDLES; i++) {
+            void *expected = NULL;
+            if (slots[i].handle.compare_exchange_strong(expected, algo_handle, std::memory_order_acq_rel) ||
+                expected == algo_handle) {
+                return &slots[i];
+            }
+        }
+        return NULL;
+    }
+
+    void AlgoStats::record(void *algo_handle, int block_size, uint64_t wall_ns, uint64_t cpu_ns)
+    {
+        algo_handle_stats_t *slot = find(algo_handle, true);
+        if (slot == NULL || block_size <= 0) {
+            return;
+        }
+        uint64_t budget_ns = (uint64_t)block_size * 1000000000ULL / sample_rate;
+        slot->wall.record(wall_ns);
+        slot->cpu.record(cpu_ns);
+        slot->wall_ns_sum.fetch_add(wall_ns, std::memory_order_relaxed);
+        slot->audio_ns_sum.fetch_add(budget_ns, std::memory_order_relaxed);
+        slot->budget_ns.store(budget_ns, std::memory_order_relaxed);
+        if (wall_ns > budget_ns) {
+            slot->overruns.fetch_add(1, std::memory_order_relaxed);
+        }
+        uint64_t rtf_ppm = wall_ns * 1000000ULL / (budget_ns ? budget_ns : 1);
+        uint64_t old_ppm = slot->rtf_max_ppm.load(std::memory_order_relaxed);
+        while (rtf_ppm > old_ppm && !slot->rtf_max_ppm.compare_exchange_weak(old_ppm, rtf_ppm, std::memory_order_relaxed)) {
+        }
+    }
+
+    int AlgoStats::get_stats(void *algo_handle, algo_stats_t *stats)
+    {
+        algo_handle_stats_t *slot = find(algo_handle, false);
+        if (slot == NULL || stats == NULL) {
+            return -1;
+        }
+        uint64_t audio_ns = slot->audio_ns_sum.load(std::memory_order_relaxed);
+        stats->calls = slot->wall.count();
+        stats->overruns = slot->overruns.load(std::memory_order_relaxed);
+        stats->budget_us = slot->budget_ns.load(std::memory_order_relaxed) / 1000.0;
+        stats->rtf = audio_ns ? (double)slot->wall_ns_sum.load(std::memory_order_relaxed) / audio_ns : 0.0;
+        stats->rtf_max = slot->rtf_max_ppm.load(std::memory_order_relaxed) / 1000000.0;
+        slot->wall.get_latency(&stats->wall);
+        slot->cpu.get_latency(&stats->cpu);
+        return 0;
+    }
+
+    void AlgoStats::reset(void *algo_handle)
+    {
+        for (int i = 0; i < ALGO_STATS_MAX_HANDLES; i++) {
+            algo_handle_stats_t *slot = &slots[i];
+            if (algo_handle != NULL && slot->handle.load(std::memory_order_acquire) != algo_handle) {
+                continue;
+            }
+            slot->overruns.store(0, std::memory_order_relaxed);
+            slot->wall_ns_sum.store(0, std::memory_order_relaxed);
+            slot->audio_ns_sum.store(0, std::memory_order_relaxed);
+            slot->rtf_max_ppm.store(0, std::memory_order_relaxed);
+            slot->wall.reset();
+            slot->cpu.reset();
+        }
+    }
+
+    void AlgoStats::release(void *algo_handle)
+    {
+        algo_handle_stats_t *slot = find(algo_handle, false);
+        if (slot) {
+            reset(algo_handle);
+            slot->handle.store(NULL, std::memory_order_release);
+        }
+    }
+
+    void AlgoStats::dump(const char *tag)
+    {
+        for (int i = 0; i < ALGO_STATS_MAX_HANDLES; i++) {
+            void *handle = slots[i].handle.load(std::memory_order_acquire);
+            algo_stats_t stats = {};
+            if (handle == NULL || get_stats(handle, &stats) != 0 || stats.calls == 0) {
+                continue;
+            }
+            LOGI("%s handle %p calls %llu overruns %llu budget %.1fus rtf %.3f rtf_max %.3f", tag, handle,
+                 (unsigned long long)stats.calls, (unsigned long long)stats.overruns, stats.budget_us,
+                 stats.rtf, stats.rtf_max);
+            LOGI("%s handle %p wall p50 %.1fus p99 %.1fus p99.9 %.1fus max %.1fus", tag, handle,
+                 stats.wall.p50_us, stats.wall.p99_us, stats.wall.p999_us, stats.wall.max_us);
+            LOGI("%s handle %p cpu  p50 %.1fus p99 %.1fus p99.9 %.1fus max %.1fus", tag, handle,
+                 stats.cpu.p50_us, stats.cpu.p99_us, stats.cpu.p999_us, stats.cpu.max_us);
+        }
+    }
+
+    int AlgoStats::start_dump(const char *tag, int interval_ms)
+    {
+        if (interval_ms <= 0 || dump_running.exchange(true)) {
+            return -1;
+        }
+        dump_thread = std::thread([this, tag, interval_ms]() {
+            int waited = 0;
+            while (dump_running.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                waited += 10;
+                if (waited >= interval_ms) {
+                    dump(tag);
+                    waited = 0;
+                }
+            }
+        });
+        return 0;
+    }
+
+    void AlgoStats::stop_dump()
+    {
+        if (dump_running.exchange(false) && dump_thread.joinable()) {
+            dump_thread.join();
+        }
+    }
+}
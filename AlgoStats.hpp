@@ -0,0 +1,99 @@
+/* **************************************************************
+ * @Description: per handle latency statistics for algorithm API
+ * @Date: 2026-10-19 11:02:18
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+
+#ifndef _ALGO_STATS_H
+#define _ALGO_STATS_H
+
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+#define ALGO_STATS_MAX_HANDLES 16
+#define ALGO_HIST_SUB_BITS 4                        // 16 linear steps per power of two, ~6% precision
+#define ALGO_HIST_SUB_COUNT (1 << ALGO_HIST_SUB_BITS)
+#define ALGO_HIST_BUCKETS (64 * ALGO_HIST_SUB_COUNT)
+
+namespace test
+{
+    typedef struct algo_latency {
+        double p50_us;
+        double p99_us;
+        double p999_us;
+        double max_us;
+    } algo_latency_t;
+
+    typedef struct algo_stats {
+        uint64_t calls;
+        uint64_t overruns;      // calls whose wall time exceeded the block budget
+        double budget_us;       // budget of the last block
+        double rtf;             // total wall time / total audio time
+        double rtf_max;         // worst single block
+        algo_latency_t wall;
+        algo_latency_t cpu;
+    } algo_stats_t;
+
+    // HDR-style log-linear histogram of nanoseconds, safe to record from several threads
+    class AlgoLatencyHistogram
+    {
+    public:
+        AlgoLatencyHistogram();
+        void record(uint64_t ns);
+        void reset();
+        uint64_t count();
+        uint64_t max();
+        uint64_t percentile(double quantile);
+        void get_latency(algo_latency_t *latency);
+
+    private:
+        static int bucket_index(uint64_t ns);
+        static uint64_t bucket_value(int index);
+
+        std::atomic<uint64_t> buckets[ALGO_HIST_BUCKETS];
+        std::atomic<uint64_t> total;
+        std::atomic<uint64_t> max_ns;
+    };
+
+    typedef struct algo_handle_stats {
+        std::atomic<void *> handle;
+        std::atomic<uint64_t> overruns;
+        std::atomic<uint64_t> wall_ns_sum;
+        std::atomic<uint64_t> audio_ns_sum;
+        std::atomic<uint64_t> rtf_max_ppm;
+        std::atomic<uint64_t> budget_ns;
+        AlgoLatencyHistogram wall;
+        AlgoLatencyHistogram cpu;
+    } algo_handle_stats_t;
+
+    /*
+     * Statistics of every handle of one AlgoAPI. Slots are claimed with a CAS
+     * on first use and then only touched with relaxed atomics, so the audio
+     * thread never locks or allocates.
+     */
+    class AlgoStats
+    {
+    public:
+        AlgoStats(int sample_rate);
+        ~AlgoStats();
+        void record(void *algo_handle, int block_size, uint64_t wall_ns, uint64_t cpu_ns);
+        int get_stats(void *algo_handle, algo_stats_t *stats);
+        void reset(void *algo_handle);
+        void release(void *algo_handle);
+        void dump(const char *tag);
+        int start_dump(const char *tag, int interval_ms);
+        void stop_dump();
+
+    private:
+        algo_handle_stats_t *find(void *algo_handle, bool claim);
+
+        int sample_rate;
+        algo_handle_stats_t slots[ALGO_STATS_MAX_HANDLES];
+        std::atomic<bool> dump_running;
+        std::thread dump_thread;
+    };
+}
+#endif // _ALGO_STATS_H
@@ -6,14 +6,63 @@
  * @Copyright (c) 2024 by @Panda-Young, All Rights Reserved.
  **************************************************************/
 #include "AlgoAPI.hpp"
+#include "AlgoHotSwap.hpp"
 #include <stdio.h>
 
 #define SAMPLE_COUNT 8
+#define SWAP_BLOCK_SIZE 256
+#define SWAP_CROSSFADE_SAMPLES 1024
 
-int main()
+// keep processing blocks while the library is replaced under the running stream
+static int hot_swap_demo(char *old_lib, char *new_lib)
+{
+    test::AlgoHotSwap hot_swap(old_lib, SWAP_BLOCK_SIZE, SWAP_CROSSFADE_SAMPLES);
+    if (!hot_swap.is_ready()) {
+        printf("Failed to load %s.\n", old_lib);
+        return 1;
+    }
+
+    float param2 = -6.0f;
+    hot_swap.set_algo_param(SET_PARAM2, &param2, sizeof(param2));
+
+    const test::algo_param_desc_t params[] = {
+        {SET_PARAM1, sizeof(char)},
+        {SET_PARAM2, sizeof(float)},
+        {SET_PARAM3, 128},
+    };
+    if (hot_swap.swap_library(new_lib, params, sizeof(params) / sizeof(params[0])) != 0) {
+        printf("Failed to stage %s.\n", new_lib);
+        return 1;
+    }
+
+    float input[SWAP_BLOCK_SIZE];
+    float output[SWAP_BLOCK_SIZE];
+    for (int i = 0; i < SWAP_BLOCK_SIZE; i++) {
+        input[i] = 1.0f;
+    }
+    for (int block = 0; block < SWAP_CROSSFADE_SAMPLES / SWAP_BLOCK_SIZE + 1; block++) {
+        hot_swap.algo_process(input, output, SWAP_BLOCK_SIZE);
+        printf("block %d: first %f last %f\n", block, output[0], output[SWAP_BLOCK_SIZE - 1]);
+    }
+
+    if (!hot_swap.wait_swap_done(100)) {
+        printf("Swap did not finish.\n");
+        return 1;
+    }
+    char version[128] = {0};
+    if (hot_swap.get_algo_version(version) == 0) {
+        printf("Algorithm Version after swap: %s\n", version);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
 {
     void *m_algo_handle = NULL;
     char LIB_NAME[] = "libalgo_example.so";
+    if (argc > 1) {
+        return hot_swap_demo(LIB_NAME, argv[1]);
+    }
     test::AlgoAPI *algo_instance = new test::AlgoAPI(LIB_NAME);
     if (!algo_instance) {
         printf("Failed to create AlgoAPI instance.\n");
@@ -38,11 +87,11 @@ int main()
         printf("Algorithm init success. m_algo_handle: %p\n", m_algo_handle);
     }
 
-    int param2 = 2;
-    if (algo_instance->set_algo_param(m_algo_handle, SET_PARAM2, (void *)&param2, sizeof(int)) != 0) {
-        printf("Failed to set algo param cmd %d size %lu.\n", SET_PARAM2, sizeof(int));
+    float param2 = 2.0f;
+    if (algo_instance->set_algo_param(m_algo_handle, SET_PARAM2, (void *)&param2, sizeof(float)) != 0) {
+        printf("Failed to set algo param cmd %d size %lu.\n", SET_PARAM2, sizeof(float));
     } else {
-        printf("Algorithm set param cmd %d size %lu Bytes success.\n", SET_PARAM2, sizeof(int));
+        printf("Algorithm set param cmd %d size %lu Bytes success.\n", SET_PARAM2, sizeof(float));
     }
 
     char param3[] = "param3";
@@ -52,18 +101,43 @@ int main()
         printf("Algorithm set param cmd %d size %lu Bytes success.\n", SET_PARAM3, sizeof(param3));
     }
 
-    int input[SAMPLE_COUNT] = {0, 1, 2, 3, 4, 5, 6, 7};
-    int output[SAMPLE_COUNT] = {0};
-    if (algo_instance->algo_process(m_algo_handle, input, output, SAMPLE_COUNT * sizeof(int)) != 0) {
+    algo_instance->enable_profiling(48000, 0);
+    float input[SAMPLE_COUNT] = {0, 1, 2, 3, 4, 5, 6, 7};
+    float output[SAMPLE_COUNT] = {0};
+    if (algo_instance->algo_process(m_algo_handle, input, output, SAMPLE_COUNT) != 0) {
         printf("Failed to process algo.\n");
         return 1;
     }
 
     for (int i = 0; i < SAMPLE_COUNT; i++) {
-        printf("%d ", output[i]);
+        printf("%.3f ", output[i]);
     }
     printf("\n");
 
+    // the same eight samples as interleaved stereo, split and merged by AlgoAPI
+    if (algo_instance->has_planar_process()) {
+        float stereo[SAMPLE_COUNT] = {0};
+        if (algo_instance->prepare_interleaved(2, SAMPLE_COUNT / 2) != 0 ||
+            algo_instance->algo_process_interleaved(m_algo_handle, input, stereo, 2, SAMPLE_COUNT / 2) != 0) {
+            printf("Failed to process interleaved stereo.\n");
+            return 1;
+        }
+        printf("stereo: ");
+        for (int i = 0; i < SAMPLE_COUNT; i++) {
+            printf("%.3f ", stereo[i]);
+        }
+        printf("\n");
+    } else {
+        printf("stereo skipped, a mono only plugin needs a handle per channel\n");
+    }
+
+    test::algo_stats_t stats = {};
+    if (algo_instance->get_algo_stats(m_algo_handle, &stats) == 0) {
+        printf("calls %llu overruns %llu rtf %.4f wall p50 %.2fus max %.2fus cpu p50 %.2fus\n",
+               (unsigned long long)stats.calls, (unsigned long long)stats.overruns, stats.rtf,
+               stats.wall.p50_us, stats.wall.max_us, stats.cpu.p50_us);
+    }
+
     algo_instance->algo_deinit(m_algo_handle);
 
     delete algo_instance;
@@ -73,4 +147,6 @@ int main()
 
 /*Add library path:
     export LD_LIBRARY_PATH=.
+Hot swap to another build of the library:
+    g++ AlgoUse.cpp AlgoAPI.cpp AlgoStats.cpp AlgoHotSwap.cpp log.c -ldl -lpthread -o AlgoUse && ./AlgoUse ./libalgo_example_v2.so
 */
@@ -1,16 +1,25 @@
 #ifndef __ChimeConfigXMLParser_H
 #define __ChimeConfigXMLParser_H
 
+#include "chime_reload.h"
 #include "log.h"
-#include <libxml/parser.h>
-#include <libxml/xmlmemory.h>
-#include <map>
+#include <assert.h>
 #include <stdint.h>
-#include <string>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+// parses chime3D.xml once in memory, no thread is started and no file written
 int32_t parseChimeConfigXML(const char *xml_file_path);
-char *get_3dc_file_Path(int soundposition);
+/* flags are CHIME_RELOAD_WATCH to reload chime3D.xml in the background when
+ * it changes and CHIME_RELOAD_CACHE to keep the parsed mapping in a cache
+ * file next to it. */
+int32_t parseChimeConfigXMLEx(const char *xml_file_path, int flags);
+/* filePath + fileName of the position, NULL when it is unknown or has no
+ * file. Must be called inside chime_reload_enter() / chime_reload_exit(),
+ * the string is valid until that exit. Asserts the section in debug builds
+ * and returns NULL outside of one otherwise. Real-time safe. */
+const char *get_3dc_file_Path(int soundposition);
 
 #endif // __ChimeConfigXMLParser_H
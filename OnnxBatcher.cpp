@@ -0,0 +1,332 @@
+/* **************************************************************
+ * @Description: batched ONNX Runtime inference across streams
+ * @Date: 2026-10-20 00:21:37
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+#include "OnnxBatcher.hpp"
+#include "log.h"
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define BUFFER_ALIGN 64
+
+namespace test
+{
+    static Ort::Env &ort_env()
+    {
+        static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "onnx_batcher");
+        return env;
+    }
+
+    uint64_t OnnxBatcher::now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    OnnxBatcher::OnnxBatcher(const onnx_batch_config_t *config)
+        : session(NULL), run_options(NULL), filling(0), stream_state(NULL), stopping(false), ready(false),
+          blocks(0), batches(0), full_batches(0), run_ns_sum(0), reset_ns(now_ns())
+    {
+        memset(buffers, 0, sizeof(buffers));
+        memset(&this->config, 0, sizeof(this->config));
+        if (config == NULL || config->model == NULL || config->frames <= 0 || config->max_streams <= 0 ||
+            config->max_batch <= 0 || config->deadline_us < 0) {
+            LOGE("batch config is invalid");
+            return;
+        }
+        this->config = *config;
+        if (load(config) != 0) {
+            return;
+        }
+        stream_state = (int *)calloc(config->max_streams, sizeof(int));
+        if (stream_state == NULL || bind_buffer(&buffers[0]) != 0 || bind_buffer(&buffers[1]) != 0) {
+            LOGE("allocate batches of %d x %d failed", config->max_batch, config->frames);
+            return;
+        }
+        ready = true;
+        worker = std::thread(&OnnxBatcher::run_worker, this);
+        LOGI("batching %s, %d streams, batch %d, deadline %dus, %d intra-op threads%s", config->model,
+             config->max_streams, config->max_batch, config->deadline_us, config->intra_threads,
+             config->pointwise ? ", pointwise" : "");
+    }
+
+    OnnxBatcher::~OnnxBatcher()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        work_cv.notify_all();
+        done_cv.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+        for (int b = 0; b < 2; b++) {
+            if (buffers[b].bindings) {
+                for (int n = 0; n < config.max_batch; n++) {
+                    delete buffers[b].bindings[n];
+                }
+            }
+            free(buffers[b].bindings);
+            free(buffers[b].input);
+            free(buffers[b].output);
+            free(buffers[b].streams);
+            free(buffers[b].targets);
+            free(buffers[b].submit_ns);
+        }
+        free(stream_state);
+        delete run_options;
+        delete session;
+    }
+
+    int OnnxBatcher::load(const onnx_batch_config_t *config)
+    {
+        try {
+            Ort::SessionOptions options;
+            options.SetIntraOpNumThreads(config->intra_threads);
+            options.SetInterOpNumThreads(1);
+            options.SetExecutionMode(ORT_SEQUENTIAL);
+            options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+            session = new Ort::Session(ort_env(), config->model, options);
+            run_options = new Ort::RunOptions();
+
+            Ort::TypeInfo type = session->GetInputTypeInfo(0);
+            std::vector<int64_t> shape = type.GetTensorTypeAndShapeInfo().GetShape();
+            if (session->GetInputCount() != 1 || session->GetOutputCount() != 1 || shape.size() != 2 ||
+                type.GetTensorTypeAndShapeInfo().GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT) {
+                LOGE("%s is not a model of one float [batch, samples] input and one output", config->model);
+                return -1;
+            }
+            if (config->pointwise ? shape[1] >= 0 : (shape[0] >= 0 || (shape[1] >= 0 && shape[1] != config->frames))) {
+                LOGE("%s has input shape [%lld, %lld], batches of %d need %s", config->model, (long long)shape[0],
+                     (long long)shape[1], config->frames,
+                     config->pointwise ? "a dynamic sample count" : "a dynamic batch dimension");
+                return -1;
+            }
+        } catch (const Ort::Exception &e) {
+            LOGE("load %s failed: %s", config->model, e.what());
+            return -1;
+        }
+        return 0;
+    }
+
+    // allocates one buffer and binds every batch size of it
+    int OnnxBatcher::bind_buffer(batch_buffer_t *buffer)
+    {
+        size_t bytes = (size_t)config.max_batch * config.frames * sizeof(float);
+        void *input = NULL, *output = NULL;
+        if (posix_memalign(&input, BUFFER_ALIGN, bytes) != 0 || posix_memalign(&output, BUFFER_ALIGN, bytes) != 0) {
+            free(input);
+            return -1;
+        }
+        buffer->input = (float *)input;
+        buffer->output = (float *)output;
+        memset(buffer->input, 0, bytes);
+        memset(buffer->output, 0, bytes);
+        buffer->streams = (int *)calloc(config.max_batch, sizeof(int));
+        buffer->targets = (float **)calloc(config.max_batch, sizeof(float *));
+        buffer->submit_ns = (uint64_t *)calloc(config.max_batch, sizeof(uint64_t));
+        buffer->bindings = (Ort::IoBinding **)calloc(config.max_batch, sizeof(Ort::IoBinding *));
+        if (!buffer->streams || !buffer->targets || !buffer->submit_ns || !buffer->bindings) {
+            return -1;
+        }
+
+        char input_name[64], output_name[64];
+        try {
+            Ort::AllocatorWithDefaultOptions allocator;
+            snprintf(input_name, sizeof(input_name), "%s", session->GetInputNameAllocated(0, allocator).get());
+            snprintf(output_name, sizeof(output_name), "%s", session->GetOutputNameAllocated(0, allocator).get());
+            Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+            for (int n = 1; n <= config.max_batch; n++) {
+                size_t count = (size_t)n * config.frames;
+                int64_t shape[2] = {n, config.frames};
+                if (config.pointwise) {
+                    shape[0] = 1;
+                    shape[1] = (int64_t)count;
+                }
+                Ort::Value in = Ort::Value::CreateTensor<float>(memory_info, buffer->input, count, shape, 2);
+                Ort::Value out = Ort::Value::CreateTensor<float>(memory_info, buffer->output, count, shape, 2);
+                buffer->bindings[n - 1] = new Ort::IoBinding(*session);
+                buffer->bindings[n - 1]->BindInput(input_name, in);
+                buffer->bindings[n - 1]->BindOutput(output_name, out);
+            }
+        } catch (const Ort::Exception &e) {
+            LOGE("bind batches failed: %s", e.what());
+            return -1;
+        }
+        return 0;
+    }
+
+    bool OnnxBatcher::is_ready()
+    {
+        return ready;
+    }
+
+    // queues one block of frames samples, its result is written to output before wait() returns
+    int OnnxBatcher::submit(int stream, const float *input, float *output)
+    {
+        if (!ready || stream < 0 || stream >= config.max_streams || input == NULL || output == NULL) {
+            LOGE("stream %d can't submit", stream);
+            return -1;
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        if (stream_state[stream] == STREAM_QUEUED) {
+            LOGE("stream %d submitted again before its result was taken", stream);
+            return -1;
+        }
+        // both buffers busy, one filled and one running
+        done_cv.wait(guard, [this] { return stopping || buffers[filling].count < config.max_batch; });
+        if (stopping) {
+            return -1;
+        }
+        batch_buffer_t *buffer = &buffers[filling];
+        int row = buffer->count++;
+        memcpy(buffer->input + (size_t)row * config.frames, input, config.frames * sizeof(float));
+        buffer->streams[row] = stream;
+        buffer->targets[row] = output;
+        buffer->submit_ns[row] = now_ns();
+        stream_state[stream] = STREAM_QUEUED;
+        if (row == 0 || buffer->count == config.max_batch) {
+            work_cv.notify_one();
+        }
+        return 0;
+    }
+
+    int OnnxBatcher::wait(int stream)
+    {
+        if (!ready || stream < 0 || stream >= config.max_streams) {
+            return -1;
+        }
+        std::unique_lock<std::mutex> guard(lock);
+        if (stream_state[stream] == STREAM_IDLE) {
+            LOGE("stream %d waits without a block submitted", stream);
+            return -1;
+        }
+        done_cv.wait(guard, [this, stream] { return stopping || stream_state[stream] != STREAM_QUEUED; });
+        int ret = stream_state[stream] == STREAM_DONE ? 0 : -1;
+        if (stream_state[stream] != STREAM_QUEUED) {
+            stream_state[stream] = STREAM_IDLE;
+        }
+        return ret;
+    }
+
+    int OnnxBatcher::process(int stream, const float *input, float *output)
+    {
+        int ret = submit(stream, input, output);
+        return ret == 0 ? wait(stream) : ret;
+    }
+
+    void OnnxBatcher::run_worker()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while (!stopping) {
+            batch_buffer_t *buffer = &buffers[filling];
+            if (buffer->count == 0) {
+                work_cv.wait(guard);
+                continue;
+            }
+            uint64_t deadline = buffer->submit_ns[0] + (uint64_t)config.deadline_us * 1000;
+            if (buffer->count < config.max_batch && now_ns() < deadline) {
+                work_cv.wait_until(guard, std::chrono::steady_clock::time_point(
+                                              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                  std::chrono::nanoseconds(deadline))));
+                continue;
+            }
+            // the other buffer is empty, the worker left it that way after running it
+            filling ^= 1;
+            if (buffer->count == config.max_batch) {
+                full_batches.fetch_add(1, std::memory_order_relaxed);
+                done_cv.notify_all(); // submitters held back by a full buffer
+            }
+            guard.unlock();
+            int ret = run_batch(buffer);
+            uint64_t end = now_ns();
+            guard.lock();
+            for (int row = 0; row < buffer->count; row++) {
+                stream_state[buffer->streams[row]] = ret == 0 ? STREAM_DONE : STREAM_FAILED;
+                added.record(end - buffer->submit_ns[row]);
+            }
+            blocks.fetch_add(buffer->count, std::memory_order_relaxed);
+            batches.fetch_add(1, std::memory_order_relaxed);
+            buffer->count = 0;
+            done_cv.notify_all();
+        }
+        for (int b = 0; b < 2; b++) {
+            for (int row = 0; row < buffers[b].count; row++) {
+                stream_state[buffers[b].streams[row]] = STREAM_FAILED;
+            }
+        }
+    }
+
+    // runs the rows of buffer and scatters them, called without the lock
+    int OnnxBatcher::run_batch(batch_buffer_t *buffer)
+    {
+        uint64_t start = now_ns();
+        try {
+            session->Run(*run_options, *buffer->bindings[buffer->count - 1]);
+        } catch (const Ort::Exception &e) {
+            LOGE("run batch of %d failed: %s", buffer->count, e.what());
+            return -1;
+        }
+        uint64_t elapsed = now_ns() - start;
+        run.record(elapsed);
+        run_ns_sum.fetch_add(elapsed, std::memory_order_relaxed);
+        for (int row = 0; row < buffer->count; row++) {
+            memcpy(buffer->targets[row], buffer->output + (size_t)row * config.frames, config.frames * sizeof(float));
+        }
+        return 0;
+    }
+
+    int OnnxBatcher::get_stats(onnx_batch_stats_t *stats)
+    {
+        if (stats == NULL) {
+            return -1;
+        }
+        memset(stats, 0, sizeof(*stats));
+        stats->blocks = blocks.load(std::memory_order_relaxed);
+        stats->batches = batches.load(std::memory_order_relaxed);
+        stats->full_batches = full_batches.load(std::memory_order_relaxed);
+        stats->deadline_batches = stats->batches > stats->full_batches ? stats->batches - stats->full_batches : 0;
+        if (stats->batches) {
+            stats->mean_batch = (double)stats->blocks / stats->batches;
+        }
+        if (stats->blocks) {
+            stats->run_us_per_block = run_ns_sum.load(std::memory_order_relaxed) / 1e3 / stats->blocks;
+        }
+        double elapsed = (now_ns() - reset_ns.load(std::memory_order_relaxed)) / 1e9;
+        stats->blocks_per_s = elapsed > 0 ? stats->blocks / elapsed : 0;
+        added.get_latency(&stats->added);
+        run.get_latency(&stats->run);
+        return 0;
+    }
+
+    void OnnxBatcher::reset_stats()
+    {
+        blocks.store(0, std::memory_order_relaxed);
+        batches.store(0, std::memory_order_relaxed);
+        full_batches.store(0, std::memory_order_relaxed);
+        run_ns_sum.store(0, std::memory_order_relaxed);
+        reset_ns.store(now_ns(), std::memory_order_relaxed);
+        added.reset();
+        run.reset();
+    }
+
+    void OnnxBatcher::dump(const char *tag)
+    {
+        onnx_batch_stats_t stats;
+        get_stats(&stats);
+        LOGI("%s blocks %llu batches %llu (full %llu, deadline %llu) mean batch %.2f %.0f blocks/s run %.1fus/block",
+             tag, (unsigned long long)stats.blocks, (unsigned long long)stats.batches,
+             (unsigned long long)stats.full_batches, (unsigned long long)stats.deadline_batches, stats.mean_batch,
+             stats.blocks_per_s, stats.run_us_per_block);
+        LOGI("%s added p50 %.1fus p99 %.1fus p99.9 %.1fus max %.1fus", tag, stats.added.p50_us, stats.added.p99_us,
+             stats.added.p999_us, stats.added.max_us);
+        LOGI("%s run   p50 %.1fus p99 %.1fus p99.9 %.1fus max %.1fus", tag, stats.run.p50_us, stats.run.p99_us,
+             stats.run.p999_us, stats.run.max_us);
+    }
+}
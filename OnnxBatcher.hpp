@@ -0,0 +1,124 @@
+/* **************************************************************
+ * @Description: batched ONNX Runtime inference across streams
+ * @Date: 2026-10-20 00:21:37
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+
+#ifndef _ONNX_BATCHER_H
+#define _ONNX_BATCHER_H
+
+#include "AlgoStats.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <onnxruntime_cxx_api.h>
+#include <stdint.h>
+#include <thread>
+
+namespace test
+{
+    typedef struct onnx_batch_config {
+        const char *model;
+        int frames;             // samples per block of every stream
+        int max_streams;        // stream ids run from 0 to max_streams - 1
+        int max_batch;          // blocks per session.Run at most
+        int deadline_us;        // longest the first block of a batch waits for others
+        int intra_threads;      // intra-op threads of the session, 0 lets ONNX Runtime pick
+        bool pointwise;         // the model maps every sample on its own, see OnnxBatcher
+    } onnx_batch_config_t;
+
+    typedef struct onnx_batch_stats {
+        uint64_t blocks;
+        uint64_t batches;
+        uint64_t full_batches;      // ran as soon as max_batch blocks were in
+        uint64_t deadline_batches;  // ran when the first block's deadline passed
+        double mean_batch;
+        double blocks_per_s;        // since the last reset
+        double run_us_per_block;    // session time divided over the blocks it ran
+        algo_latency_t added;       // submit to result, all that batching adds to a block
+        algo_latency_t run;         // one session.Run
+    } onnx_batch_stats_t;
+
+    /*
+     * Runs blocks of many streams through one session in batches.
+     *
+     * Streams call submit() and then wait(), or process() for both, from any
+     * thread. Blocks gather in a [max_batch, frames] input tensor. A worker
+     * thread runs it once it is full or deadline_us after its first block
+     * arrived, then writes each row straight into its stream's output. While
+     * one batch runs the next one fills in a second buffer.
+     *
+     * Every batch size has its IoBinding made up front over those buffers,
+     * so running a batch of any size allocates nothing.
+     *
+     * The model's first input dimension has to be dynamic. reduce_15db.onnx
+     * fixes it at 1 and only leaves the sample count free. A model like that
+     * which maps every sample on its own, as a gain does, can still be
+     * batched with pointwise set: the rows are the same memory as one
+     * [1, count * frames] block.
+     */
+    class OnnxBatcher
+    {
+    public:
+        OnnxBatcher(const onnx_batch_config_t *config);
+        ~OnnxBatcher();
+        bool is_ready();
+        int submit(int stream, const float *input, float *output);
+        int wait(int stream);
+        int process(int stream, const float *input, float *output);
+        int get_stats(onnx_batch_stats_t *stats);
+        void reset_stats();
+        void dump(const char *tag);
+
+    private:
+        enum {
+            STREAM_IDLE,
+            STREAM_QUEUED,
+            STREAM_DONE,
+            STREAM_FAILED,
+        };
+
+        typedef struct batch_buffer {
+            float *input;           // max_batch * frames
+            float *output;
+            int count;
+            int *streams;           // stream of each row
+            float **targets;        // caller output of each row
+            uint64_t *submit_ns;
+            Ort::IoBinding **bindings; // one per batch size, [count - 1] runs count rows
+        } batch_buffer_t;
+
+        int load(const onnx_batch_config_t *config);
+        int bind_buffer(batch_buffer_t *buffer);
+        void run_worker();
+        int run_batch(batch_buffer_t *buffer);
+        static uint64_t now_ns();
+
+        onnx_batch_config_t config;
+        Ort::Session *session;
+        Ort::RunOptions *run_options;
+        batch_buffer_t buffers[2];
+        int filling;                // buffer that takes submitted blocks
+        int *stream_state;
+        bool stopping;
+        bool ready;
+        std::mutex lock;
+        std::condition_variable work_cv;    // wakes the worker
+        std::condition_variable done_cv;    // wakes streams waiting for results or space
+        std::thread worker;
+
+        std::atomic<uint64_t> blocks;
+        std::atomic<uint64_t> batches;
+        std::atomic<uint64_t> full_batches;
+        std::atomic<uint64_t> run_ns_sum;
+        std::atomic<uint64_t> reset_ns;
+        AlgoLatencyHistogram added;
+        AlgoLatencyHistogram run;
+
+        OnnxBatcher(const OnnxBatcher &) = delete;
+        OnnxBatcher &operator=(const OnnxBatcher &) = delete;
+    };
+}
+#endif // _ONNX_BATCHER_H
@@ -0,0 +1,474 @@
+/* **************************************************************
+ * @Description: offline benchmark of algorithm plugins through AlgoAPI
+ * @Date: 2026-10-19 11:48:32
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+#include "AlgoAPI.hpp"
+#include "AlgoStats.hpp"
+#include "audio_primitives.h"
+#include "wav.h"
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#define MAX_SWEEP 16
+#define DEFAULT_SAMPLE_RATE 48000
+#define DEFAULT_SECONDS 10
+#define DEFAULT_WARMUP_BLOCKS 64
+
+typedef struct bench_config {
+    char *lib_name;
+    const char *input_file;
+    const char *golden_file;
+    const char *output_file;
+    const char *signal;        // sine or noise when no input file
+    int sample_rate;
+    int seconds;
+    int warmup_blocks;
+    int passes;
+    float param2;
+    int set_param2;
+    float tolerance;
+    int block_sizes[MAX_SWEEP];
+    int block_size_count;
+    int channels[MAX_SWEEP];
+    int channel_count;
+} bench_config_t;
+
+static struct option long_options[] = {
+    {"lib", required_argument, 0, 'l'},
+    {"input", required_argument, 0, 'i'},
+    {"signal", required_argument, 0, 's'},
+    {"rate", required_argument, 0, 'r'},
+    {"seconds", required_argument, 0, 'd'},
+    {"blocks", required_argument, 0, 'b'},
+    {"channels", required_argument, 0, 'c'},
+    {"warmup", required_argument, 0, 'w'},
+    {"passes", required_argument, 0, 'n'},
+    {"param2", required_argument, 0, 'p'},
+    {"golden", required_argument, 0, 'g'},
+    {"output", required_argument, 0, 'o'},
+    {"tolerance", required_argument, 0, 't'},
+    {"help", no_argument, 0, 'h'},
+    {0, 0, 0, 0}};
+
+static void display_help(const char *prog)
+{
+    printf("Usage:\n");
+    printf("  %s -l <libalgo.so> [-i <input.wav> | -s sine|noise -r <rate> -d <seconds>]\n", prog);
+    printf("     [-b 64,128,256] [-c 1,2,6] [-w <warmup blocks>] [-n <passes>] [-p <param2>]\n");
+    printf("     [-o <output.wav>] [-g <golden.wav> -t <tolerance>]\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("  -l, --lib        Algorithm shared library to benchmark\n");
+    printf("  -i, --input      Input wav file (16 bit PCM or 32 bit float)\n");
+    printf("  -s, --signal     Synthetic signal when no input file: sine (default) or noise\n");
+    printf("  -r, --rate       Sample rate of the synthetic signal, default %d\n", DEFAULT_SAMPLE_RATE);
+    printf("  -d, --seconds    Length of the synthetic signal, default %d\n", DEFAULT_SECONDS);
+    printf("  -b, --blocks     Comma separated block sizes in frames to sweep\n");
+    printf("  -c, --channels   Comma separated channel counts to sweep\n");
+    printf("  -w, --warmup     Blocks processed before measuring, default %d\n", DEFAULT_WARMUP_BLOCKS);
+    printf("  -n, --passes     Times the whole signal is processed per configuration, default 1\n");
+    printf("  -p, --param2     Value set through SET_PARAM2 (float) before processing\n");
+    printf("  -o, --output     Write the output of the first configuration as float wav\n");
+    printf("  -g, --golden     Compare every configuration against this float wav\n");
+    printf("  -t, --tolerance  Max absolute error allowed against golden, default 1e-6\n");
+}
+
+static int parse_list(const char *arg, int *list, int max_count)
+{
+    int count = 0;
+    const char *p = arg;
+    while (*p && count < max_count) {
+        int value = atoi(p);
+        if (value <= 0) {
+            return -1;
+        }
+        list[count++] = value;
+        p = strchr(p, ',');
+        if (p == NULL) {
+            break;
+        }
+        p++;
+    }
+    return count;
+}
+
+static double now_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// load the source as planar float, one plane per channel of the file
+static int load_source(bench_config_t *config, std::vector<std::vector<float>> &planes)
+{
+    if (config->input_file == NULL) {
+        size_t frames = (size_t)config->sample_rate * config->seconds;
+        planes.assign(1, std::vector<float>(frames));
+        uint32_t seed = 12345;
+        for (size_t i = 0; i < frames; i++) {
+            if (strcmp(config->signal, "noise") == 0) {
+                seed = seed * 1664525u + 1013904223u;
+                planes[0][i] = ((seed >> 8) / 8388608.0f - 1.0f) * 0.5f;
+            } else {
+                planes[0][i] = 0.5f * sinf(2.0f * (float)M_PI * 1000.0f * i / config->sample_rate);
+            }
+        }
+        return 0;
+    }
+
+    WavFile *wav = wav_open(config->input_file, WAV_OPEN_READ);
+    if (wav == NULL || wav_err()->code != WAV_OK) {
+        printf("Failed to open %s: %s\n", config->input_file, wav_err()->message);
+        return -1;
+    }
+    int channels = wav_get_num_channels(wav);
+    size_t frames = wav_get_length(wav);
+    size_t sample_size = wav_get_sample_size(wav);
+    WavU16 format = wav_get_format(wav);
+    if (!((format == WAV_FORMAT_PCM && sample_size == 2) || (format == WAV_FORMAT_IEEE_FLOAT && sample_size == 4))) {
+        printf("Unsupported wav format %d with %zu bytes per sample\n", format, sample_size);
+        wav_close(wav);
+        return -1;
+    }
+    std::vector<unsigned char> raw(frames * channels * sample_size);
+    frames = wav_read(wav, raw.data(), frames);
+    config->sample_rate = wav_get_sample_rate(wav);
+    wav_close(wav);
+
+    std::vector<float> interleaved(frames * channels);
+    if (sample_size == 2) {
+        memcpy_to_float_from_i16(interleaved.data(), (const int16_t *)raw.data(), interleaved.size());
+    } else {
+        memcpy(interleaved.data(), raw.data(), interleaved.size() * sizeof(float));
+    }
+    planes.assign(channels, std::vector<float>(frames));
+    for (size_t i = 0; i < frames; i++) {
+        for (int ch = 0; ch < channels; ch++) {
+            planes[ch][i] = interleaved[i * channels + ch];
+        }
+    }
+    return 0;
+}
+
+static int load_golden(const char *file_name, std::vector<std::vector<float>> &planes)
+{
+    WavFile *wav = wav_open(file_name, WAV_OPEN_READ);
+    if (wav == NULL || wav_err()->code != WAV_OK) {
+        printf("Failed to open golden %s: %s\n", file_name, wav_err()->message);
+        return -1;
+    }
+    if (wav_get_format(wav) != WAV_FORMAT_IEEE_FLOAT || wav_get_sample_size(wav) != 4) {
+        printf("Golden %s must be 32 bit float wav\n", file_name);
+        wav_close(wav);
+        return -1;
+    }
+    int channels = wav_get_num_channels(wav);
+    size_t frames = wav_get_length(wav);
+    std::vector<float> interleaved(frames * channels);
+    frames = wav_read(wav, interleaved.data(), frames);
+    wav_close(wav);
+    planes.assign(channels, std::vector<float>(frames));
+    for (size_t i = 0; i < frames; i++) {
+        for (int ch = 0; ch < channels; ch++) {
+            planes[ch][i] = interleaved[i * channels + ch];
+        }
+    }
+    return 0;
+}
+
+static int save_output(const char *file_name, int sample_rate, const std::vector<std::vector<float>> &planes)
+{
+    WavFile *wav = wav_open(file_name, WAV_OPEN_WRITE);
+    if (wav == NULL || wav_err()->code != WAV_OK) {
+        printf("Failed to create %s\n", file_name);
+        return -1;
+    }
+    int channels = (int)planes.size();
+    size_t frames = planes[0].size();
+    wav_set_format(wav, WAV_FORMAT_IEEE_FLOAT);
+    wav_set_sample_size(wav, sizeof(float));
+    wav_set_num_channels(wav, channels);
+    wav_set_sample_rate(wav, sample_rate);
+    std::vector<float> interleaved(frames * channels);
+    for (size_t i = 0; i < frames; i++) {
+        for (int ch = 0; ch < channels; ch++) {
+            interleaved[i * channels + ch] = planes[ch][i];
+        }
+    }
+    size_t written = wav_write(wav, interleaved.data(), frames);
+    wav_close(wav);
+    return written == frames ? 0 : -1;
+}
+
+// process the whole signal once, measuring every block across all channels
+static int run_pass(test::AlgoAPI *algo, std::vector<void *> &handles, int block_size,
+                    std::vector<std::vector<float>> &in, std::vector<std::vector<float>> &out,
+                    test::AlgoLatencyHistogram *hist, int warmup_blocks)
+{
+    int channels = (int)in.size();
+    size_t frames = in[0].size();
+    const float *in_planes[ALGO_MAX_CHANNELS];
+    float *out_planes[ALGO_MAX_CHANNELS];
+    for (size_t pos = 0, block = 0; pos < frames; pos += block_size, block++) {
+        int n = (int)(frames - pos < (size_t)block_size ? frames - pos : block_size);
+        for (int ch = 0; ch < channels; ch++) {
+            in_planes[ch] = &in[ch][pos];
+            out_planes[ch] = &out[ch][pos];
+        }
+        double start = now_seconds();
+        if (handles.size() == 1 && channels > 1) {
+            if (algo->algo_process_planar(handles[0], in_planes, out_planes, channels, n) != 0) {
+                return -1;
+            }
+        } else {
+            for (int ch = 0; ch < channels; ch++) {
+                if (algo->algo_process(handles[ch], (void *)in_planes[ch], out_planes[ch], n) != 0) {
+                    return -1;
+                }
+            }
+        }
+        double elapsed = now_seconds() - start;
+        if (hist && block >= (size_t)warmup_blocks) {
+            hist->record((uint64_t)(elapsed * 1e9));
+        }
+    }
+    return 0;
+}
+
+static int compare_golden(const std::vector<std::vector<float>> &out, const std::vector<std::vector<float>> &golden,
+                          float tolerance, double *max_err)
+{
+    *max_err = 0.0;
+    for (size_t ch = 0; ch < out.size(); ch++) {
+        const std::vector<float> &ref = golden[ch % golden.size()];
+        if (ref.size() != out[ch].size()) {
+            return -2;
+        }
+        for (size_t i = 0; i < ref.size(); i++) {
+            double err = fabs((double)out[ch][i] - ref[i]);
+            if (err > *max_err) {
+                *max_err = err;
+            }
+        }
+    }
+    return *max_err <= tolerance ? 0 : -1;
+}
+
+static int bench_config(test::AlgoAPI *algo, bench_config_t *config, const std::vector<std::vector<float>> &source,
+                        const std::vector<std::vector<float>> &golden, int block_size, int channels, bool save)
+{
+    std::vector<std::vector<float>> in(channels);
+    std::vector<std::vector<float>> out(channels, std::vector<float>(source[0].size()));
+    for (int ch = 0; ch < channels; ch++) {
+        in[ch] = source[ch % source.size()];
+    }
+
+    // a planar plugin takes every channel in one call, a mono one gets a handle per channel
+    std::vector<void *> handles(algo->has_planar_process() ? 1 : channels, (void *)NULL);
+    int ret = 0;
+    for (size_t ch = 0; ch < handles.size() && ret == 0; ch++) {
+        handles[ch] = algo->algo_init();
+        if (handles[ch] == NULL) {
+            printf("algo_init failed\n");
+            ret = -1;
+        } else if (config->set_param2 &&
+                   algo->set_algo_param(handles[ch], SET_PARAM2, &config->param2, sizeof(float)) != 0) {
+            printf("set param2 failed\n");
+            ret = -1;
+        }
+    }
+
+    test::AlgoLatencyHistogram *hist = new test::AlgoLatencyHistogram();
+    double elapsed = 0.0;
+    if (ret == 0) {
+        // warm up caches, branch predictors and lazy plugin state before measuring
+        std::vector<std::vector<float>> warm_in(channels), warm_out(channels);
+        size_t warm_frames = (size_t)block_size * config->warmup_blocks;
+        for (int ch = 0; ch < channels; ch++) {
+            warm_in[ch].assign(in[ch].begin(), in[ch].begin() + (warm_frames < in[ch].size() ? warm_frames : in[ch].size()));
+            warm_out[ch].resize(warm_in[ch].size());
+        }
+        if (!warm_in[0].empty()) {
+            ret = run_pass(algo, handles, block_size, warm_in, warm_out, NULL, 0);
+        }
+    }
+    for (int pass = 0; pass < config->passes && ret == 0; pass++) {
+        double start = now_seconds();
+        ret = run_pass(algo, handles, block_size, in, out, hist, 0);
+        elapsed += now_seconds() - start;
+    }
+
+    if (ret == 0) {
+        double audio_seconds = (double)source[0].size() / config->sample_rate * config->passes;
+        double samples = (double)source[0].size() * channels * config->passes;
+        test::algo_latency_t latency;
+        hist->get_latency(&latency);
+        printf("%6d %4d %10.2f %8.4f %9.2f %9.2f %9.2f %9.2f", block_size, channels, samples / elapsed / 1e6,
+               elapsed / audio_seconds, latency.p50_us, latency.p99_us, latency.p999_us, latency.max_us);
+        if (!golden.empty()) {
+            double max_err = 0.0;
+            int cmp = compare_golden(out, golden, config->tolerance, &max_err);
+            if (cmp == -2) {
+                printf("  FAIL (golden has %zu frames)", golden[0].size());
+            } else {
+                printf("  %s (max err %.3g)", cmp == 0 ? "PASS" : "FAIL", max_err);
+            }
+            ret = cmp;
+        }
+        printf("\n");
+        if (save && config->output_file) {
+            if (save_output(config->output_file, config->sample_rate, out) != 0) {
+                printf("Failed to write %s\n", config->output_file);
+                ret = -1;
+            }
+        }
+    } else {
+        printf("%6d %4d  process failed\n", block_size, channels);
+    }
+
+    delete hist;
+    for (size_t ch = 0; ch < handles.size(); ch++) {
+        if (handles[ch]) {
+            algo->algo_deinit(handles[ch]);
+        }
+    }
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    bench_config_t config = {};
+    config.signal = "sine";
+    config.sample_rate = DEFAULT_SAMPLE_RATE;
+    config.seconds = DEFAULT_SECONDS;
+    config.warmup_blocks = DEFAULT_WARMUP_BLOCKS;
+    config.passes = 1;
+    config.tolerance = 1e-6f;
+    config.block_size_count = parse_list("64,128,256,512,1024", config.block_sizes, MAX_SWEEP);
+    config.channel_count = parse_list("1,2", config.channels, MAX_SWEEP);
+
+    int opt;
+    int option_index = 0;
+    while ((opt = getopt_long(argc, argv, "l:i:s:r:d:b:c:w:n:p:g:o:t:h", long_options, &option_index)) != -1) {
+        switch (opt) {
+        case 'l':
+            config.lib_name = optarg;
+            break;
+        case 'i':
+            config.input_file = optarg;
+            break;
+        case 's':
+            config.signal = optarg;
+            break;
+        case 'r':
+            config.sample_rate = atoi(optarg);
+            break;
+        case 'd':
+            config.seconds = atoi(optarg);
+            break;
+        case 'b':
+            config.block_size_count = parse_list(optarg, config.block_sizes, MAX_SWEEP);
+            break;
+        case 'c':
+            config.channel_count = parse_list(optarg, config.channels, MAX_SWEEP);
+            break;
+        case 'w':
+            config.warmup_blocks = atoi(optarg);
+            break;
+        case 'n':
+            config.passes = atoi(optarg);
+            break;
+        case 'p':
+            config.param2 = (float)atof(optarg);
+            config.set_param2 = 1;
+            break;
+        case 'g':
+            config.golden_file = optarg;
+            break;
+        case 'o':
+            config.output_file = optarg;
+            break;
+        case 't':
+            config.tolerance = (float)atof(optarg);
+            break;
+        case 'h':
+            display_help(argv[0]);
+            return 0;
+        default:
+            display_help(argv[0]);
+            return 1;
+        }
+    }
+
+    if (config.lib_name == NULL || config.block_size_count <= 0 || config.channel_count <= 0 ||
+        config.sample_rate <= 0 || config.seconds <= 0 || config.passes <= 0 || config.warmup_blocks < 0) {
+        display_help(argv[0]);
+        return 1;
+    }
+    for (int i = 0; i < config.channel_count; i++) {
+        if (config.channels[i] > ALGO_MAX_CHANNELS) {
+            printf("channel count %d is larger than %d\n", config.channels[i], ALGO_MAX_CHANNELS);
+            return 1;
+        }
+    }
+
+    test::AlgoAPI *algo = new test::AlgoAPI(config.lib_name);
+    if (algo->shared_lib_handle == NULL) {
+        printf("Failed to load shared library %s.\n", config.lib_name);
+        delete algo;
+        return 1;
+    }
+    char version[128] = {0};
+    if (algo->get_algo_version(version) == 0) {
+        printf("Library %s version %s\n", config.lib_name, version);
+    }
+
+    std::vector<std::vector<float>> source, golden;
+    if (load_source(&config, source) != 0 || source[0].empty()) {
+        delete algo;
+        return 1;
+    }
+    if (config.golden_file && load_golden(config.golden_file, golden) != 0) {
+        delete algo;
+        return 1;
+    }
+    printf("Source %s: %zu frames, %zu channel(s), %d Hz, %d pass(es), %d warmup blocks\n",
+           config.input_file ? config.input_file : config.signal, source[0].size(), source.size(),
+           config.sample_rate, config.passes, config.warmup_blocks);
+    printf("%6s %4s %10s %8s %9s %9s %9s %9s\n", "block", "ch", "Msmp/s", "RTF", "p50(us)", "p99(us)", "p99.9(us)",
+           "max(us)");
+
+    int failed = 0;
+    for (int b = 0; b < config.block_size_count; b++) {
+        for (int c = 0; c < config.channel_count; c++) {
+            if (bench_config(algo, &config, source, golden, config.block_sizes[b], config.channels[c],
+                             b == 0 && c == 0) != 0) {
+                failed++;
+            }
+        }
+    }
+
+    delete algo;
+    if (failed) {
+        printf("%d configuration(s) failed\n", failed);
+        return 1;
+    }
+    return 0;
+}
+
+/* Compile Command:
+Linux:
+    gcc -O2 -c wav.c
+    g++ -O2 algo_bench.cpp AlgoAPI.cpp AlgoStats.cpp wav.o audio_primitives.c log.c -ldl -lpthread -o algo_bench
+    ./algo_bench -l ./libalgo_example.so -p -6 -b 64,256,1024 -c 1,2,6 -o golden.wav
+    ./algo_bench -l ./libalgo_example_v2.so -p -6 -b 64,256,1024 -c 1,2,6 -g golden.wav
+*/
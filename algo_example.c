@@ -10,6 +10,14 @@
 #include "log.h"
 #include <math.h>
 
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define ALGO_USE_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ALGO_USE_NEON 1
+#endif
+
 #define VERSION "0.1.2"
 #define MAX_BUF_SIZE 1024
 
@@ -18,12 +26,38 @@ typedef struct algo_handle {
     float param2;
     char param3[MAX_BUF_SIZE];
     float *param4;
+    float gain; // linear gain of param2, computed when param2 is set
 } algo_handle_t, *p_algo_handle_t;
 
 float dBToGain(float dbValue) {
   return (dbValue == 0.0f) ? 1.0f : powf(10.0f, dbValue / 20.0f);
 }
 
+static void apply_gain(const float *input, float *output, float gain, int count)
+{
+    int i = 0;
+#if ALGO_USE_SSE
+    __m128 g = _mm_set1_ps(gain);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_loadu_ps(input + i);
+        __m128 b = _mm_loadu_ps(input + i + 4);
+        _mm_storeu_ps(output + i, _mm_mul_ps(a, g));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(b, g));
+    }
+#elif ALGO_USE_NEON
+    float32x4_t g = vdupq_n_f32(gain);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vld1q_f32(input + i);
+        float32x4_t b = vld1q_f32(input + i + 4);
+        vst1q_f32(output + i, vmulq_f32(a, g));
+        vst1q_f32(output + i + 4, vmulq_f32(b, g));
+    }
+#endif
+    for (; i < count; i++) {
+        output[i] = input[i] * gain;
+    }
+}
+
 static int validate_param_size(int received_size, int expected_size, const char *param_name)
 {
     if (received_size != expected_size) {
@@ -52,6 +86,7 @@ void *algo_init()
         return NULL;
     }
     memset(algo_handle, 0, sizeof(algo_handle_t));
+    algo_handle->gain = 1.0f;
     LOGI("algo_init OK");
     return algo_handle;
 }
@@ -96,6 +131,7 @@ int algo_set_param(void *algo_handle, algo_param_t cmd, void *param, int param_s
         ret = validate_param_size(param_size, sizeof(float), "param2");
         if (ret == E_OK) {
             algo_handle_ptr->param2 = *(float *)param;
+            algo_handle_ptr->gain = dBToGain(algo_handle_ptr->param2);
             LOGI("set param2: %.3f", algo_handle_ptr->param2);
         }
         break;
@@ -199,14 +235,43 @@ int algo_process(void *algo_handle, const float *input, float *output, int block
     p_algo_handle_t algo_handle_ptr = (p_algo_handle_t)algo_handle;
 
     if (algo_handle_ptr->param2 == 0.0f) {
-        memcpy(output, input, block_size * sizeof(float));
+        if (output != input) {
+            memmove(output, input, block_size * sizeof(float));
+        }
         return E_OK;
     }
 
-    float gain = dBToGain(algo_handle_ptr->param2);
-    for (int i = 0; i < block_size; i++) {
-        output[i] = input[i] * gain;
+    apply_gain(input, output, algo_handle_ptr->gain, block_size);
+    return E_OK;
+}
+
+int algo_process_planar(void *algo_handle, const float *const *input, float *const *output, int channels, int frames)
+{
+    if (algo_handle == NULL) {
+        return E_ALGO_HANDLE_NULL;
+    }
+    if (input == NULL || output == NULL) {
+        LOGE("input or output is NULL");
+        return E_PARAM_BUFFER_NULL;
     }
+    if (channels <= 0 || channels > ALGO_MAX_CHANNELS || frames <= 0) {
+        LOGE("channels %d or frames %d is not correct", channels, frames);
+        return E_PARAM_SIZE_INVALID;
+    }
+    p_algo_handle_t algo_handle_ptr = (p_algo_handle_t)algo_handle;
 
+    for (int ch = 0; ch < channels; ch++) {
+        if (input[ch] == NULL || output[ch] == NULL) {
+            LOGE("channel %d buffer is NULL", ch);
+            return E_PARAM_BUFFER_NULL;
+        }
+        if (algo_handle_ptr->param2 == 0.0f) {
+            if (output[ch] != input[ch]) {
+                memcpy(output[ch], input[ch], frames * sizeof(float));
+            }
+        } else {
+            apply_gain(input[ch], output[ch], algo_handle_ptr->gain, frames);
+        }
+    }
     return E_OK;
 }
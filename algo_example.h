@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "algo_limits.h"
 
 #if defined(_WIN32) || defined(__WIN32__) || defined(WIN32) || defined(_WIN64) || defined(__WIN64__) || defined(WIN64)
     #ifdef ALGO_EXPORTS
@@ -46,6 +47,9 @@ ALGO_API void algo_deinit(void *algo_handle);
 ALGO_API int algo_set_param(void *algo_handle, algo_param_t cmd, void *param, int param_size);
 ALGO_API int algo_get_param(void *algo_handle, algo_param_t cmd, void *param, int param_size);
 ALGO_API int algo_process(void *algo_handle, const float *input, float *output, int block_size);
+/* planar multichannel: input[ch] and output[ch] each hold frames samples, output may alias input */
+ALGO_API int algo_process_planar(void *algo_handle, const float *const *input, float *const *output,
+                                 int channels, int frames);
 
 #endif
 
@@ -56,5 +60,5 @@ Windows Visal Studio:
 Windows MinGW:
     gcc -shared -DALGO_EXPORTS -fPIC algo_example.c log.c -lm -o algo_example.dll
 Linux:
-    gcc -shared -DALGO_EXPORTS -fPIC algo_example.c log.c -lm -o libalgo_example.so
+    gcc -O2 -shared -DALGO_EXPORTS -fPIC algo_example.c log.c -lm -o libalgo_example.so
 */
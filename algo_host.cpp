@@ -0,0 +1,25 @@
+/* **************************************************************
+ * @Description: plugin host executable started by AlgoProcessHost
+ * @Date: 2026-10-20 09:12:36
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+#include "AlgoProcessHost.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+// algo_host <libalgo.so> <shm fd> <parent pid>, only AlgoProcessHost runs it
+int main(int argc, char *argv[])
+{
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s <libalgo.so> <shm fd> <parent pid>\n", argv[0]);
+        return 1;
+    }
+    return test::AlgoProcessHost::serve(argv[1], atoi(argv[2]), (pid_t)atoi(argv[3]));
+}
+
+/* Compile Command:
+Linux:
+    g++ algo_host.cpp AlgoProcessHost.cpp AlgoAPI.cpp AlgoStats.cpp log.c -ldl -lpthread -lrt -o algo_host
+*/
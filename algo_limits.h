@@ -0,0 +1,16 @@
+/***************************************************************************
+ * Description: limits of the algorithm plugin ABI shared by plugins and hosts
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-20 09:40:18
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _ALGO_LIMITS_H
+#define _ALGO_LIMITS_H
+
+/* most channels one algo_process_planar call carries, plugins may reject
+ * more and hosts size their plane pointer arrays by it */
+#define ALGO_MAX_CHANNELS 16
+
+#endif
@@ -0,0 +1,835 @@
+/***************************************************************************
+ * Description: ONNX Runtime model served behind the algo plugin ABI
+ * version: 0.2.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 23:48:16
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * test_reduce_db_onnx.cpp builds the environment, the session and the
+ * tensors for its one inference. Here all of that happens before audio
+ * starts. One Ort::Env serves the process. algo_init loads the session,
+ * and only a new model path or thread count loads it again.
+ *
+ * A session, its binding and its buffers make one onnx_model_t, and a
+ * reload never touches the one algo_process runs. algo_set_param builds
+ * and measures the new model off to the side and leaves it in pending.
+ * algo_process takes it over at the start of its next block and hands the
+ * old one back through retired, and the next algo_set_param or
+ * algo_deinit frees it. The audio thread only exchanges pointers, it never
+ * frees a model, and a reload does not have to wait for it. One control
+ * thread may set parameters at a time.
+ *
+ * The session runs through an Ort::IoBinding whose input and output are
+ * [1, frames] tensors over two buffers the model owns. ONNX Runtime then
+ * reads the block from where it sits and writes its result straight into
+ * the output buffer, with no output tensor allocated per run and nothing
+ * to copy out of one. The ABI hands over different caller buffers on every
+ * call, so the block is copied into the bound input and out of the bound
+ * output, a few kilobytes against the cost of a run. The tensors are only
+ * made again, and that allocates, when the block length changes.
+ *
+ * The intra-op pool is the session's own, sized by ALGO_ONNX_PARAM_THREADS.
+ * One thread is the default since the blocks are small and waking a pool
+ * costs more than it saves unless the model is heavy.
+ *
+ * An FP16 model is bound over the same buffers as float16 tensors, and the
+ * block is converted on its way in and out instead of copied. Whether that
+ * pays off depends on the CPU. ONNX Runtime's CPU kernels for x86 mostly
+ * compute in float and wrap FP16 graphs in casts, so FP16 can even be the
+ * slower one. So the variants are measured rather than guessed: both run
+ * the same test signal, the FP16 output is scored by its SNR against the
+ * FP32 output, and the faster one within the bound is kept. Measuring takes
+ * a moment of algo_init, so the choice goes into a small text file keyed by
+ * the CPU model, the model files and the settings, and the next start on
+ * the same kind of CPU loads the variant straight away. The file lives in
+ * a directory the host names, the plugin creates no directories and keeps
+ * no file when it has none.
+ */
+
+#include "algo_onnx.h"
+#include "log.h"
+#include <atomic>
+#include <math.h>
+#include <new>
+#include <onnxruntime_cxx_api.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+#define VERSION "0.2.0"
+#define MAX_NAME_SIZE 64
+#define MAX_LINE_SIZE 2048
+#define BUFFER_ALIGN 64
+#define SELECT_FRAMES 1024
+#define SELECT_BLOCKS 96
+#define VARIANT_FILE "algo_onnx_variants"
+
+typedef struct onnx_model {
+    Ort::Session *session;
+    Ort::IoBinding *binding;
+    float *input;                   // ALGO_ONNX_MAX_FRAMES, bound as the model input
+    float *output;                  // ALGO_ONNX_MAX_FRAMES, bound as the model output
+    int bound_frames;               // shape of the bound tensors, 0 when none are bound
+    int half;                       // the model is FP16, the buffers hold float16
+    char path[ALGO_ONNX_MAX_PATH];
+    char input_name[MAX_NAME_SIZE];
+    char output_name[MAX_NAME_SIZE];
+} onnx_model_t;
+
+typedef struct algo_handle {
+    onnx_model_t *active;                // the model algo_process runs, audio thread only
+    std::atomic<onnx_model_t *> pending; // loaded by algo_set_param, taken over at the next block
+    std::atomic<onnx_model_t *> retired; // let go of by the audio thread, freed by the control thread
+    Ort::RunOptions *run_options;
+    int threads;
+    float min_snr;
+    char base_model[ALGO_ONNX_MAX_PATH]; // the FP32 model as configured
+    char model[ALGO_ONNX_MAX_PATH];      // the variant of it that runs, or runs from the next block on
+    char cache_dir[ALGO_ONNX_MAX_PATH];  // where variant choices are kept, empty keeps none
+} algo_handle_t, *p_algo_handle_t;
+
+static Ort::Env &ort_env()
+{
+    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "algo_onnx");
+    return env;
+}
+
+static int validate_param_size(int received_size, int expected_size, const char *param_name)
+{
+    if (received_size != expected_size) {
+        LOGE("Received param size %d Bytes for %s is not correct. Expected size is %d",
+             received_size, param_name, expected_size);
+        return E_PARAM_SIZE_INVALID;
+    }
+    return E_OK;
+}
+
+static void free_model(onnx_model_t *model)
+{
+    if (model == NULL) {
+        return;
+    }
+    delete model->binding;
+    delete model->session;
+    free(model->input);
+    free(model->output);
+    free(model);
+}
+
+// loads path with threads into a model of its own, nothing in use is touched
+static int load_model(const char *path, int threads, onnx_model_t **loaded)
+{
+    onnx_model_t *model = (onnx_model_t *)calloc(1, sizeof(onnx_model_t));
+    void *input = NULL, *output = NULL;
+    if (model == NULL || posix_memalign(&input, BUFFER_ALIGN, ALGO_ONNX_MAX_FRAMES * sizeof(float)) != 0 ||
+        posix_memalign(&output, BUFFER_ALIGN, ALGO_ONNX_MAX_FRAMES * sizeof(float)) != 0) {
+        LOGE("allocate a model with %d frames of tensor buffers failed", ALGO_ONNX_MAX_FRAMES);
+        free(input);
+        free(model);
+        return E_ALLOCATE_FAILED;
+    }
+    model->input = (float *)input;
+    model->output = (float *)output;
+    snprintf(model->path, sizeof(model->path), "%s", path);
+    try {
+        Ort::SessionOptions options;
+        options.SetIntraOpNumThreads(threads);
+        options.SetInterOpNumThreads(1);
+        options.SetExecutionMode(ORT_SEQUENTIAL);
+        options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        model->session = new Ort::Session(ort_env(), path, options);
+
+        Ort::Session *session = model->session;
+        Ort::AllocatorWithDefaultOptions allocator;
+        Ort::TypeInfo input_type = session->GetInputTypeInfo(0);
+        Ort::TypeInfo output_type = session->GetOutputTypeInfo(0);
+        ONNXTensorElementDataType type = input_type.GetTensorTypeAndShapeInfo().GetElementType();
+        if (session->GetInputCount() != 1 || session->GetOutputCount() != 1 ||
+            (type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT && type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) ||
+            output_type.GetTensorTypeAndShapeInfo().GetElementType() != type) {
+            LOGE("%s is not a model of one float or float16 input and an output of the same type", path);
+            free_model(model);
+            return E_PARAM_OUT_OF_RANGE;
+        }
+        model->half = type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+        snprintf(model->input_name, sizeof(model->input_name), "%s",
+                 session->GetInputNameAllocated(0, allocator).get());
+        snprintf(model->output_name, sizeof(model->output_name), "%s",
+                 session->GetOutputNameAllocated(0, allocator).get());
+        model->binding = new Ort::IoBinding(*session);
+    } catch (const std::exception &e) {
+        LOGE("load %s failed: %s", path, e.what());
+        free_model(model);
+        return E_ALLOCATE_FAILED;
+    }
+    LOGI("loaded %s, %s -> %s, %s, %d intra-op threads", path, model->input_name, model->output_name,
+         model->half ? "fp16" : "fp32", threads);
+    *loaded = model;
+    return E_OK;
+}
+
+// frees the model the audio thread let go of, control thread
+static void reclaim(p_algo_handle_t handle)
+{
+    free_model(handle->retired.exchange(NULL, std::memory_order_acquire));
+}
+
+// hands model to the audio thread for its next block, a pending one it never took is dropped
+static void publish(p_algo_handle_t handle, onnx_model_t *model, int threads)
+{
+    reclaim(handle);
+    free_model(handle->pending.exchange(model, std::memory_order_acq_rel));
+    snprintf(handle->model, sizeof(handle->model), "%s", model->path);
+    handle->threads = threads;
+}
+
+/* audio thread, at the start of a block: moves on to a pending model once
+ * the previous one it let go of has been freed, so retired holds one at most */
+static onnx_model_t *current_model(p_algo_handle_t handle)
+{
+    if (handle->pending.load(std::memory_order_relaxed) != NULL &&
+        handle->retired.load(std::memory_order_acquire) == NULL) {
+        onnx_model_t *next = handle->pending.exchange(NULL, std::memory_order_acq_rel);
+        if (next != NULL) {
+            handle->retired.store(handle->active, std::memory_order_release);
+            handle->active = next;
+        }
+    }
+    return handle->active;
+}
+
+// IEEE half precision, rounded to nearest even, like the F16C instructions
+static uint16_t half_from_float(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (bits >> 16) & 0x8000;
+    bits &= 0x7fffffff;
+    if (bits >= 0x7f800000) {
+        return sign | 0x7c00 | (bits > 0x7f800000 ? 0x200 | ((bits >> 13) & 0x3ff) : 0); // NaN stays quiet
+    }
+    if (bits >= 0x47800000) {
+        return sign | 0x7c00;
+    }
+    if (bits < 0x38800000) {
+        float subnormal;
+        memcpy(&subnormal, &bits, sizeof(subnormal));
+        return sign | (uint16_t)lrintf(subnormal * 16777216.0f);
+    }
+    bits += 0xc8000fff + ((bits >> 13) & 1); // rebias the exponent and round
+    return sign | (uint16_t)(bits >> 13);
+}
+
+static float half_to_float_one(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0) {
+        float value = mantissa / 16777216.0f;
+        memcpy(&bits, &value, sizeof(bits));
+        bits |= sign;
+    } else if (exponent == 31) {
+        bits = sign | 0x7f800000 | (mantissa ? 0x400000 | (mantissa << 13) : 0);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void float_to_half(uint16_t *output, const float *input, int count)
+{
+    int i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128((__m128i *)(output + i), _mm256_cvtps_ph(_mm256_loadu_ps(input + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+#endif
+    for (; i < count; i++) {
+        output[i] = half_from_float(input[i]);
+    }
+}
+
+static void half_to_float(float *output, const uint16_t *input, int count)
+{
+    int i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(output + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(input + i))));
+    }
+#endif
+    for (; i < count; i++) {
+        output[i] = half_to_float_one(input[i]);
+    }
+}
+
+// points the binding at [1, frames] views of the model's buffers
+static int bind_frames(onnx_model_t *model, int frames)
+{
+    try {
+        Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+        int64_t shape[2] = {1, frames};
+        size_t bytes = frames * (model->half ? sizeof(uint16_t) : sizeof(float));
+        ONNXTensorElementDataType type =
+            model->half ? ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16 : ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+        Ort::Value input = Ort::Value::CreateTensor(memory_info, model->input, bytes, shape, 2, type);
+        Ort::Value output = Ort::Value::CreateTensor(memory_info, model->output, bytes, shape, 2, type);
+        model->binding->ClearBoundInputs();
+        model->binding->ClearBoundOutputs();
+        model->binding->BindInput(model->input_name, input);
+        model->binding->BindOutput(model->output_name, output);
+    } catch (const std::exception &e) {
+        LOGE("bind %d frames failed: %s", frames, e.what());
+        model->bound_frames = 0;
+        return E_ALLOCATE_FAILED;
+    }
+    model->bound_frames = frames;
+    return E_OK;
+}
+
+static int run_block(onnx_model_t *model, const Ort::RunOptions &run_options, const float *input, float *output,
+                     int frames)
+{
+    if (frames != model->bound_frames) {
+        int ret = bind_frames(model, frames);
+        if (ret != E_OK) {
+            return ret;
+        }
+    }
+    if (model->half) {
+        float_to_half((uint16_t *)model->input, input, frames);
+    } else {
+        memcpy(model->input, input, frames * sizeof(float));
+    }
+    try {
+        model->session->Run(run_options, *model->binding);
+    } catch (const std::exception &e) {
+        LOGE("run failed: %s", e.what());
+        return E_PARAM_OUT_OF_RANGE;
+    }
+    if (model->half) {
+        half_to_float(output, (const uint16_t *)model->output, frames);
+    } else {
+        memcpy(output, model->output, frames * sizeof(float));
+    }
+    return E_OK;
+}
+
+// this CPU's model name, the key that variant choices are kept under
+static void cpu_name(char *name, int size)
+{
+    snprintf(name, size, "unknown");
+    FILE *fp = fopen("/proc/cpuinfo", "r");
+    if (fp == NULL) {
+        return;
+    }
+    char line[256];
+    int found = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        int model_name = strncmp(line, "model name", 10) == 0;
+        char *value = strchr(line, ':');
+        if (value == NULL || (!model_name && (found || strncmp(line, "CPU part", 8) != 0))) {
+            continue;
+        }
+        value += 1 + strspn(value + 1, " \t");
+        value[strcspn(value, "\t\n")] = '\0';
+        snprintf(name, size, "%s", value);
+        found = 1;
+        if (model_name) {
+            break; // arm only has the part number
+        }
+    }
+    fclose(fp);
+}
+
+// path of model with ALGO_ONNX_FP16_SUFFIX before its extension, 1 when that file is readable
+static int fp16_sibling(const char *model, char *sibling, int size)
+{
+    const char *dot = strrchr(model, '.');
+    const char *slash = strrchr(model, '/');
+    int stem = dot != NULL && (slash == NULL || dot > slash) ? (int)(dot - model) : (int)strlen(model);
+    int len = snprintf(sibling, size, "%.*s%s%s", stem, model, ALGO_ONNX_FP16_SUFFIX, model + stem);
+    return len < size && access(sibling, R_OK) == 0;
+}
+
+// the variant cache file, 0 when there is none to use
+static int cache_path(p_algo_handle_t handle, char *path, int size)
+{
+    return handle->cache_dir[0] != '\0' && snprintf(path, size, "%s/%s", handle->cache_dir, VARIANT_FILE) < size;
+}
+
+static long long mtime_of(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (long long)st.st_mtime : 0;
+}
+
+// one line of the cache per CPU model, model files with their times, threads and bound
+static void variant_key(p_algo_handle_t handle, const char *base, const char *fp16, int threads, char *key,
+                        int size)
+{
+    char cpu[128];
+    cpu_name(cpu, sizeof(cpu));
+    snprintf(key, size, "%s|%s@%lld|%s@%lld|%d|%.1f", cpu, base, mtime_of(base), fp16, mtime_of(fp16), threads,
+             handle->min_snr);
+}
+
+// 1 for fp16, 0 for fp32, -1 when key has no choice in the cache yet
+static int cache_lookup(p_algo_handle_t handle, const char *key)
+{
+    char path[ALGO_ONNX_MAX_PATH], line[MAX_LINE_SIZE];
+    if (!cache_path(handle, path, sizeof(path))) {
+        return -1;
+    }
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+    int chosen = -1;
+    size_t key_len = strlen(key);
+    while (fgets(line, sizeof(line), fp)) {
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == '\t') {
+            chosen = strncmp(line + key_len + 1, "fp16", 4) == 0;
+        }
+    }
+    fclose(fp);
+    return chosen;
+}
+
+// rewrites the cache with the choice for key, through a temporary file so readers never see half of it
+static void cache_store(p_algo_handle_t handle, const char *key, int use_fp16, double snr, double us32,
+                        double us16)
+{
+    char path[ALGO_ONNX_MAX_PATH], tmp_path[ALGO_ONNX_MAX_PATH + 32], line[MAX_LINE_SIZE];
+    if (!cache_path(handle, path, sizeof(path))) {
+        return;
+    }
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%d", path, (int)getpid());
+    FILE *out = fopen(tmp_path, "w");
+    if (out == NULL) {
+        LOGW("can not write %s, the variant is measured again next time", tmp_path);
+        return;
+    }
+    FILE *in = fopen(path, "r");
+    size_t key_len = strlen(key);
+    while (in != NULL && fgets(line, sizeof(line), in)) {
+        if (strncmp(line, key, key_len) != 0 || line[key_len] != '\t') {
+            fputs(line, out);
+        }
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    fprintf(out, "%s\t%s\t%.1f\t%.2f\t%.2f\n", key, use_fp16 ? "fp16" : "fp32", snr, us32, us16);
+    if (fclose(out) != 0 || rename(tmp_path, path) != 0) {
+        LOGW("can not update %s", path);
+        remove(tmp_path);
+    }
+}
+
+// tones over the band and some noise, rising from -40 dBFS to full scale so small and large values are scored
+static void make_test_signal(float *signal, int count)
+{
+    const double freqs[] = {220.0, 1000.0, 5000.0};
+    const double gains[] = {0.4, 0.3, 0.2};
+    unsigned int seed = 1;
+    for (int i = 0; i < count; i++) {
+        double t = i / 48000.0, sum = 0.0;
+        for (int k = 0; k < 3; k++) {
+            sum += gains[k] * sin(2.0 * M_PI * freqs[k] * t);
+        }
+        seed = seed * 1664525u + 1013904223u;
+        sum += 0.1 * ((seed >> 8) / 8388608.0 - 1.0);
+        signal[i] = (float)(sum * pow(10.0, (-40.0 + 40.0 * i / count) / 20.0));
+    }
+}
+
+// mean microseconds per block of model over signal, the output in result, negative on failure
+static double time_blocks(onnx_model_t *model, const float *signal, float *result)
+{
+    Ort::RunOptions run_options;
+    if (run_block(model, run_options, signal, result, SELECT_FRAMES) != E_OK) { // warm up
+        return -1.0;
+    }
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int b = 0; b < SELECT_BLOCKS; b++) {
+        if (run_block(model, run_options, signal + b * SELECT_FRAMES, result + b * SELECT_FRAMES, SELECT_FRAMES) !=
+            E_OK) {
+            return -1.0;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return ((end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3) / SELECT_BLOCKS;
+}
+
+// runs both variants on the test signal, the faster one within min_snr of base in chosen
+static int measure_variants(p_algo_handle_t handle, const char *base, const char *fp16, int threads,
+                            const char *key, onnx_model_t **chosen)
+{
+    int count = SELECT_FRAMES * SELECT_BLOCKS;
+    float *signal = (float *)malloc(count * sizeof(float));
+    float *reference = (float *)malloc(count * sizeof(float));
+    float *result = (float *)malloc(count * sizeof(float));
+    if (signal == NULL || reference == NULL || result == NULL) {
+        LOGE("allocate %d samples for the variant test failed", count);
+        free(signal);
+        free(reference);
+        free(result);
+        return E_ALLOCATE_FAILED;
+    }
+    make_test_signal(signal, count);
+
+    double us32 = -1.0, us16 = -1.0, snr = 0.0, max_abs = 0.0;
+    onnx_model_t *model32 = NULL, *model16 = NULL;
+    int ret = load_model(base, threads, &model32);
+    if (ret == E_OK) {
+        us32 = time_blocks(model32, signal, reference);
+        ret = us32 < 0 ? E_PARAM_OUT_OF_RANGE : E_OK;
+    }
+    if (ret == E_OK && load_model(fp16, threads, &model16) == E_OK) {
+        us16 = time_blocks(model16, signal, result);
+        double power = 0.0, noise = 0.0;
+        for (int i = 0; i < count; i++) {
+            double error = (double)result[i] - reference[i];
+            power += (double)reference[i] * reference[i];
+            noise += error * error;
+            max_abs = fabs(error) > max_abs ? fabs(error) : max_abs;
+        }
+        snr = noise > 0.0 ? 10.0 * log10(power / noise) : 200.0;
+    }
+    free(signal);
+    free(reference);
+    free(result);
+    if (ret != E_OK) {
+        free_model(model32);
+        free_model(model16);
+        return ret;
+    }
+
+    int use_fp16 = us16 >= 0 && snr >= handle->min_snr && us16 < us32;
+    LOGI("fp32 %.2f us/block, fp16 %.2f us/block at %.1f dB SNR, max abs error %.3g, bound %.1f dB: %s", us32,
+         us16, snr, max_abs, handle->min_snr, use_fp16 ? fp16 : base);
+    if (us16 >= 0) {
+        cache_store(handle, key, use_fp16, snr, us32, us16);
+    }
+    *chosen = use_fp16 ? model16 : model32;
+    free_model(use_fp16 ? model32 : model16);
+    return E_OK;
+}
+
+// loads base or its FP16 sibling, whichever the bound and this CPU favour, and publishes it
+static int configure(p_algo_handle_t handle, const char *base, int threads)
+{
+    char fp16[ALGO_ONNX_MAX_PATH], key[MAX_LINE_SIZE];
+    onnx_model_t *model = NULL;
+    int ret;
+    if (handle->min_snr < 0 || !fp16_sibling(base, fp16, sizeof(fp16))) {
+        ret = load_model(base, threads, &model);
+    } else {
+        variant_key(handle, base, fp16, threads, key, sizeof(key));
+        int chosen = cache_lookup(handle, key);
+        if (chosen < 0) {
+            ret = measure_variants(handle, base, fp16, threads, key, &model);
+        } else {
+            LOGI("%s from the variant cache", chosen ? fp16 : base);
+            ret = chosen ? load_model(fp16, threads, &model) : E_PARAM_OUT_OF_RANGE;
+            if (ret != E_OK) {
+                ret = load_model(base, threads, &model);
+            }
+        }
+    }
+    if (ret == E_OK) {
+        publish(handle, model, threads);
+    }
+    return ret;
+}
+
+int get_algo_version(char *version)
+{
+    if (version == NULL) {
+        LOGE("version is NULL");
+        return E_VERSION_BUFFER_NULL;
+    }
+    strcpy(version, VERSION);
+    return E_OK;
+}
+
+static void free_handle(p_algo_handle_t handle)
+{
+    free_model(handle->active);
+    free_model(handle->pending.load());
+    free_model(handle->retired.load());
+    delete handle->run_options;
+    delete handle;
+}
+
+static void *init_handle()
+{
+    p_algo_handle_t algo_handle = new (std::nothrow) algo_handle_t();
+    if (algo_handle == NULL) {
+        LOGE("allocate for algo_handle_t failed");
+        return NULL;
+    }
+    const char *model = getenv(ALGO_ONNX_MODEL_ENV);
+    const char *threads = getenv(ALGO_ONNX_THREADS_ENV);
+    const char *min_snr = getenv(ALGO_ONNX_MIN_SNR_ENV);
+    const char *cache_dir = getenv(ALGO_ONNX_CACHE_DIR_ENV);
+    snprintf(algo_handle->base_model, sizeof(algo_handle->base_model), "%s", model ? model : ALGO_ONNX_DEFAULT_MODEL);
+    snprintf(algo_handle->cache_dir, sizeof(algo_handle->cache_dir), "%s", cache_dir ? cache_dir : "");
+    algo_handle->threads = threads ? atoi(threads) : ALGO_ONNX_DEFAULT_THREADS;
+    algo_handle->min_snr = min_snr ? (float)atof(min_snr) : ALGO_ONNX_DEFAULT_MIN_SNR;
+    try {
+        algo_handle->run_options = new Ort::RunOptions();
+    } catch (const std::exception &e) {
+        LOGE("create run options failed: %s", e.what());
+    }
+    if (algo_handle->run_options == NULL ||
+        configure(algo_handle, algo_handle->base_model, algo_handle->threads) != E_OK) {
+        free_handle(algo_handle);
+        return NULL;
+    }
+    // nothing runs yet, the first model is active straight away
+    algo_handle->active = algo_handle->pending.exchange(NULL);
+    return algo_handle;
+}
+
+static int set_param(p_algo_handle_t algo_handle_ptr, algo_param_t cmd, void *param, int param_size)
+{
+    int ret = E_OK;
+    switch (cmd) {
+    case ALGO_ONNX_PARAM_THREADS:
+        ret = validate_param_size(param_size, sizeof(int), "threads");
+        if (ret == E_OK) {
+            if (*(int *)param < 0) {
+                LOGE("threads %d is negative", *(int *)param);
+                return E_PARAM_OUT_OF_RANGE;
+            }
+            ret = configure(algo_handle_ptr, algo_handle_ptr->base_model, *(int *)param);
+        }
+        break;
+    case ALGO_ONNX_PARAM_MIN_SNR:
+        ret = validate_param_size(param_size, sizeof(float), "min_snr");
+        if (ret == E_OK) {
+            float min_snr = algo_handle_ptr->min_snr;
+            algo_handle_ptr->min_snr = *(float *)param;
+            ret = configure(algo_handle_ptr, algo_handle_ptr->base_model, algo_handle_ptr->threads);
+            if (ret != E_OK) {
+                algo_handle_ptr->min_snr = min_snr;
+            }
+        }
+        break;
+    case ALGO_ONNX_PARAM_MODEL: {
+        char model[ALGO_ONNX_MAX_PATH];
+        if (param_size <= 0 || param_size >= ALGO_ONNX_MAX_PATH) {
+            LOGE("Received param size: %d Bytes is not a path. Max size is %d", param_size, ALGO_ONNX_MAX_PATH - 1);
+            return E_PARAM_SIZE_INVALID;
+        }
+        memcpy(model, param, param_size);
+        model[param_size] = '\0';
+        ret = configure(algo_handle_ptr, model, algo_handle_ptr->threads);
+        if (ret == E_OK) {
+            memcpy(algo_handle_ptr->base_model, model, sizeof(model));
+        }
+        break;
+    }
+    case ALGO_ONNX_PARAM_CACHE_DIR: {
+        char dir[ALGO_ONNX_MAX_PATH];
+        struct stat st;
+        if (param_size < 0 || param_size >= ALGO_ONNX_MAX_PATH) {
+            LOGE("Received param size: %d Bytes is not a path. Max size is %d", param_size, ALGO_ONNX_MAX_PATH - 1);
+            return E_PARAM_SIZE_INVALID;
+        }
+        memcpy(dir, param, param_size);
+        dir[param_size] = '\0';
+        if (dir[0] != '\0' && (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode))) {
+            LOGE("%s is not a directory", dir);
+            return E_PARAM_OUT_OF_RANGE;
+        }
+        // read at the next reload, the model that runs stays
+        memcpy(algo_handle_ptr->cache_dir, dir, sizeof(dir));
+        break;
+    }
+    default:
+        LOGE("cmd %d is invalid", cmd);
+        return E_PARAM_OUT_OF_RANGE;
+    }
+    return ret;
+}
+
+static int process_planar(p_algo_handle_t handle, const float *const *input, float *const *output, int channels,
+                          int frames)
+{
+    onnx_model_t *model = current_model(handle);
+    for (int ch = 0; ch < channels; ch++) {
+        int ret = run_block(model, *handle->run_options, input[ch], output[ch], frames);
+        if (ret != E_OK) {
+            return ret;
+        }
+    }
+    return E_OK;
+}
+
+// what an exception that got this far is turned into, none may cross the C ABI
+static int exception_code(const char *func)
+{
+    try {
+        throw;
+    } catch (const std::bad_alloc &e) {
+        LOGE("%s: %s", func, e.what());
+        return E_ALLOCATE_FAILED;
+    } catch (const std::exception &e) {
+        LOGE("%s: %s", func, e.what());
+    } catch (...) {
+        LOGE("%s: unknown exception", func);
+    }
+    return ALGO_ONNX_E_EXCEPTION;
+}
+
+void *algo_init()
+{
+    void *algo_handle = NULL;
+    try {
+        algo_handle = init_handle();
+    } catch (...) {
+        exception_code(__func__);
+        return NULL;
+    }
+    if (algo_handle != NULL) {
+        LOGI("algo_init OK");
+    }
+    return algo_handle;
+}
+
+void algo_deinit(void *algo_handle)
+{
+    if (!algo_handle) {
+        LOGE("algo_handle is NULL");
+        return;
+    }
+    try {
+        free_handle((p_algo_handle_t)algo_handle);
+    } catch (...) {
+        exception_code(__func__);
+        return;
+    }
+    LOGI("algo_deinit OK");
+}
+
+int algo_set_param(void *algo_handle, algo_param_t cmd, void *param, int param_size)
+{
+    if (algo_handle == NULL) {
+        LOGE("algo_handle is NULL");
+        return E_ALGO_HANDLE_NULL;
+    }
+    if (param == NULL) {
+        LOGE("param is NULL");
+        return E_PARAM_BUFFER_NULL;
+    }
+    try {
+        return set_param((p_algo_handle_t)algo_handle, cmd, param, param_size);
+    } catch (...) {
+        return exception_code(__func__);
+    }
+}
+
+int algo_get_param(void *algo_handle, algo_param_t cmd, void *param, int param_size)
+{
+    if (algo_handle == NULL) {
+        LOGE("algo_handle is NULL");
+        return E_ALGO_HANDLE_NULL;
+    }
+    if (param == NULL) {
+        LOGE("param is NULL");
+        return E_PARAM_BUFFER_NULL;
+    }
+
+    p_algo_handle_t algo_handle_ptr = (p_algo_handle_t)algo_handle;
+    int ret = E_OK;
+    switch (cmd) {
+    case ALGO_ONNX_PARAM_THREADS:
+        ret = validate_param_size(param_size, sizeof(int), "threads");
+        if (ret == E_OK) {
+            *(int *)param = algo_handle_ptr->threads;
+        }
+        break;
+    case ALGO_ONNX_PARAM_MIN_SNR:
+        ret = validate_param_size(param_size, sizeof(float), "min_snr");
+        if (ret == E_OK) {
+            *(float *)param = algo_handle_ptr->min_snr;
+        }
+        break;
+    case ALGO_ONNX_PARAM_MODEL:
+        if (param_size <= (int)strlen(algo_handle_ptr->model)) {
+            LOGE("param_size %d is too small for the model path", param_size);
+            return E_PARAM_SIZE_INVALID;
+        }
+        strcpy((char *)param, algo_handle_ptr->model);
+        break;
+    case ALGO_ONNX_PARAM_CACHE_DIR:
+        if (param_size <= (int)strlen(algo_handle_ptr->cache_dir)) {
+            LOGE("param_size %d is too small for the cache directory", param_size);
+            return E_PARAM_SIZE_INVALID;
+        }
+        strcpy((char *)param, algo_handle_ptr->cache_dir);
+        break;
+    default:
+        LOGE("cmd is invalid");
+        return E_PARAM_OUT_OF_RANGE;
+    }
+    return ret;
+}
+
+int algo_process(void *algo_handle, const float *input, float *output, int block_size)
+{
+    if (algo_handle == NULL) {
+        return E_ALGO_HANDLE_NULL;
+    }
+    if (input == NULL || output == NULL) {
+        LOGE("input or output is NULL");
+        return E_PARAM_BUFFER_NULL;
+    }
+    if (block_size <= 0 || block_size > ALGO_ONNX_MAX_FRAMES) {
+        LOGE("block_size %d is not correct, at most %d", block_size, ALGO_ONNX_MAX_FRAMES);
+        return E_PARAM_SIZE_INVALID;
+    }
+    try {
+        return process_planar((p_algo_handle_t)algo_handle, &input, &output, 1, block_size);
+    } catch (...) {
+        return exception_code(__func__);
+    }
+}
+
+int algo_process_planar(void *algo_handle, const float *const *input, float *const *output, int channels, int frames)
+{
+    if (algo_handle == NULL) {
+        return E_ALGO_HANDLE_NULL;
+    }
+    if (input == NULL || output == NULL) {
+        LOGE("input or output is NULL");
+        return E_PARAM_BUFFER_NULL;
+    }
+    if (channels <= 0 || channels > ALGO_MAX_CHANNELS || frames <= 0 || frames > ALGO_ONNX_MAX_FRAMES) {
+        LOGE("channels %d or frames %d is not correct", channels, frames);
+        return E_PARAM_SIZE_INVALID;
+    }
+    for (int ch = 0; ch < channels; ch++) {
+        if (input[ch] == NULL || output[ch] == NULL) {
+            LOGE("channel %d buffer is NULL", ch);
+            return E_PARAM_BUFFER_NULL;
+        }
+    }
+    try {
+        return process_planar((p_algo_handle_t)algo_handle, input, output, channels, frames);
+    } catch (...) {
+        return exception_code(__func__);
+    }
+}
@@ -0,0 +1,60 @@
+/***************************************************************************
+ * Description: ONNX Runtime model served behind the algo plugin ABI
+ * version: 0.2.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 23:48:16
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _ALGO_ONNX_H
+#define _ALGO_ONNX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "algo_example.h"
+#ifdef __cplusplus
+}
+#endif
+
+/* The exports are the ones of algo_example.h. The model takes and returns
+ * float or float16 tensors of shape [1, frames], reduce_15db.onnx by
+ * default, and is run once per channel of a block.
+ *
+ * When the model has an FP16 sibling, reduce_15db_fp16.onnx beside
+ * reduce_15db.onnx, both are measured on this CPU and the faster one whose
+ * output stays within ALGO_ONNX_PARAM_MIN_SNR of the FP32 model is run.
+ * The choice is kept per CPU model in a file in ALGO_ONNX_PARAM_CACHE_DIR
+ * and found there next time. Without a directory nothing is kept.
+ *
+ * A parameter that reloads the model loads and measures it on the calling
+ * thread while algo_process goes on with the old one, which switches over
+ * at the start of its next block. No exception leaves an export, one that
+ * would is logged and returned as ALGO_ONNX_E_EXCEPTION. */
+
+#define ALGO_ONNX_PARAM_THREADS ALGO_PARAM1 // int, intra-op threads, 0 lets ONNX Runtime pick, reloads the model
+#define ALGO_ONNX_PARAM_MIN_SNR ALGO_PARAM2 // float, dB against the FP32 model, negative runs the model as given
+#define ALGO_ONNX_PARAM_MODEL ALGO_PARAM3   // set the FP32 .onnx path, get the variant that runs, reloads the model
+#define ALGO_ONNX_PARAM_CACHE_DIR ALGO_PARAM4 // existing directory for the variant choices, empty keeps none
+
+#define ALGO_ONNX_E_EXCEPTION -7            // an exception was stopped at the plugin boundary
+
+#define ALGO_ONNX_MAX_FRAMES 4096           // longest block algo_process accepts
+#define ALGO_ONNX_MAX_PATH 512
+#define ALGO_ONNX_DEFAULT_MODEL "reduce_15db.onnx"
+#define ALGO_ONNX_DEFAULT_THREADS 1
+#define ALGO_ONNX_DEFAULT_MIN_SNR 60.0f
+#define ALGO_ONNX_FP16_SUFFIX "_fp16"
+#define ALGO_ONNX_MODEL_ENV "ALGO_ONNX_MODEL"     // overrides the default model at algo_init
+#define ALGO_ONNX_THREADS_ENV "ALGO_ONNX_THREADS" // overrides the default thread count at algo_init
+#define ALGO_ONNX_MIN_SNR_ENV "ALGO_ONNX_MIN_SNR" // overrides the default accuracy bound at algo_init
+#define ALGO_ONNX_CACHE_DIR_ENV "ALGO_ONNX_CACHE_DIR" // sets ALGO_ONNX_PARAM_CACHE_DIR at algo_init, none by default
+
+#endif
+
+/* Compile Command:
+Linux, with the onnxruntime-linux-x64 release unpacked in $ORT:
+    g++ -O2 -shared -DALGO_EXPORTS -fPIC algo_onnx.cpp log.c -I$ORT/include -L$ORT/lib -lonnxruntime \
+        -Wl,-rpath,$ORT/lib -o libalgo_onnx.so
+    ./AlgoUse ./libalgo_onnx.so
+*/
@@ -56,11 +56,11 @@ int main()
         return 1;
     }
 
-    int param2 = 2;
-    if (set_param(algo_handle, ALGO_PARAM2, (void *)&param2, sizeof(int)) != 0) {
-        printf("Failed to set algo param cmd %d size %lu.\n", ALGO_PARAM2, sizeof(int));
+    float param2 = 2.0f;
+    if (set_param(algo_handle, ALGO_PARAM2, (void *)&param2, sizeof(float)) != 0) {
+        printf("Failed to set algo param cmd %d size %lu.\n", ALGO_PARAM2, sizeof(float));
     } else {
-        printf("Algorithm set param cmd %d size %lu success.\n", ALGO_PARAM2, sizeof(int));
+        printf("Algorithm set param cmd %d size %lu success.\n", ALGO_PARAM2, sizeof(float));
     }
 
     char param3[] = "param3";
@@ -76,14 +76,14 @@ int main()
         return 1;
     }
 
-    int input[SAMPLE_COUNT] = {0, 1, 2, 3, 4, 5, 6, 7};
-    int output[SAMPLE_COUNT] = {0};
-    if (process(algo_handle, input, output, SAMPLE_COUNT * sizeof(int)) != 0) {
+    float input[SAMPLE_COUNT] = {0, 1, 2, 3, 4, 5, 6, 7};
+    float output[SAMPLE_COUNT] = {0};
+    if (process(algo_handle, input, output, SAMPLE_COUNT) != 0) {
         printf("Failed to process algo.\n");
         return 1;
     }
     for (int i = 0; i < SAMPLE_COUNT; i++) {
-        printf("%d ", output[i]);
+        printf("%.3f ", output[i]);
     }
     printf("\n");
 
@@ -144,11 +144,11 @@ int main()
         printf("Failed to get function.\n");
         return 1;
     }
-    int param2 = 2;
-    if (set_param(algo_handle, ALGO_PARAM2, (void *)&param2, sizeof(int)) != 0) {
-        printf("Failed to set algo param cmd %d size %lu.\n", ALGO_PARAM2, sizeof(int));
+    float param2 = 2.0f;
+    if (set_param(algo_handle, ALGO_PARAM2, (void *)&param2, sizeof(float)) != 0) {
+        printf("Failed to set algo param cmd %d size %lu.\n", ALGO_PARAM2, sizeof(float));
     } else {
-        printf("Algorithm set param cmd %d size %lu success.\n", ALGO_PARAM2, sizeof(int));
+        printf("Algorithm set param cmd %d size %lu success.\n", ALGO_PARAM2, sizeof(float));
     }
     char param3[] = "param3";
     if (set_param(algo_handle, ALGO_PARAM3, param3, sizeof(param3)) != 0) {
@@ -162,14 +162,14 @@ int main()
         printf("Failed to get function.\n");
         return 1;
     }
-    int input[SAMPLE_COUNT] = {0, 1, 2, 3, 4, 5, 6, 7};
-    int output[SAMPLE_COUNT] = {0};
-    if (process(algo_handle, input, output, SAMPLE_COUNT * sizeof(int)) != 0) {
+    float input[SAMPLE_COUNT] = {0, 1, 2, 3, 4, 5, 6, 7};
+    float output[SAMPLE_COUNT] = {0};
+    if (process(algo_handle, input, output, SAMPLE_COUNT) != 0) {
         printf("Failed to process algo.\n");
         return 1;
     }
     for (int i = 0; i < SAMPLE_COUNT; i++) {
-        printf("%d ", output[i]);
+        printf("%.3f ", output[i]);
     }
     printf("\n");
 
@@ -0,0 +1,291 @@
+/***************************************************************************
+ * Description: zero copy loader for .3dc chime configs
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 19:20:37
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * A preset is a few hundred bytes of packed structs, so there is nothing to
+ * gain from copying it into an in-memory form. The file is mapped read only
+ * and the chunks are walked once, checking every size against what is left
+ * of the file before anything in the chunk is touched. What survives the
+ * walk is a set of pointers into the mapping, and from then on nothing needs
+ * checking again, the audio thread can read the preset as plain structs.
+ */
+
+#include "chime_3dc.h"
+#include "log.h"
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define AUTOMATION_HEADER_SIZE offsetof(AutomationPoints, points)
+#define AUTOMATION_V1_HEADER_SIZE offsetof(AutomationPointsV1, points)
+
+// version 1 automation record, chime_config_struct wrote it before audio_id was added
+#pragma pack(push, 1)
+typedef struct {
+    int16_t count;
+    TimedPos points[1];
+} AutomationPointsV1;
+#pragma pack(pop)
+
+static const chime_3dc_t *selected;
+
+static int pos_finite(const ObjectPos *pos)
+{
+    return isfinite(pos->x) && isfinite(pos->y) && isfinite(pos->z);
+}
+
+static int check_speakers(chime_3dc_t *preset, const uint8_t *data, uint32_t size)
+{
+    if (preset->speakers) {
+        LOGE("chime 3dc: more than one speaker chunk");
+        return -1;
+    }
+    if (size < 1 || 1 + (size_t)data[0] * sizeof(ObjectPos) > size) {
+        LOGE("chime 3dc: speaker chunk of %u bytes too short", size);
+        return -1;
+    }
+    const ObjectPos *speakers = (const ObjectPos *)(data + 1);
+    for (int i = 0; i < data[0]; i++) {
+        if (!pos_finite(&speakers[i])) {
+            LOGE("chime 3dc: speaker %d has no valid position", speakers[i].id);
+            return -1;
+        }
+    }
+    preset->speakers = speakers;
+    preset->speaker_count = data[0];
+    return 0;
+}
+
+static int check_sound_field(chime_3dc_t *preset, const uint8_t *data, uint32_t size)
+{
+    if (preset->sound_field) {
+        LOGE("chime 3dc: more than one sound field chunk");
+        return -1;
+    }
+    if (size < sizeof(SoundField)) {
+        LOGE("chime 3dc: sound field chunk of %u bytes too short", size);
+        return -1;
+    }
+    const SoundField *field = (const SoundField *)data;
+    if (!pos_finite(&field->listenerPos) || !pos_finite(&field->audioSourcePos)) {
+        LOGE("chime 3dc: sound field has no valid listener or source position");
+        return -1;
+    }
+    preset->sound_field = field;
+    return 0;
+}
+
+static int check_points(const TimedPos *points, int count, int record)
+{
+    for (int i = 0; i < count; i++) {
+        const TimedPos *point = &points[i];
+        if (!isfinite(point->x) || !isfinite(point->y) || !isfinite(point->z) ||
+            (i > 0 && point->time < points[i - 1].time)) {
+            LOGE("chime 3dc: automation record %d point %d is invalid or out of order", record, i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Version 2 records are used in place. Version 1 records have no audio id,
+ * they are copied once into the current layout, the id is filled in from
+ * the sound field once the whole file has been walked.
+ */
+static int check_automation(chime_3dc_t *preset, const uint8_t *data, uint32_t size, size_t file_size)
+{
+    int v1 = preset->header->version == 1;
+    size_t header_size = v1 ? AUTOMATION_V1_HEADER_SIZE : AUTOMATION_HEADER_SIZE;
+    uint32_t offset = 0;
+    while (offset < size) {
+        int16_t count = 0;
+        if (size - offset >= header_size) {
+            count = v1 ? ((const AutomationPointsV1 *)(data + offset))->count
+                       : ((const AutomationPoints *)(data + offset))->count;
+        }
+        if (count <= 0 || (size - offset - header_size) / sizeof(TimedPos) < (size_t)count) {
+            LOGE("chime 3dc: automation record at chunk offset %u does not fit", offset);
+            return -1;
+        }
+        const TimedPos *points = (const TimedPos *)(data + offset + header_size);
+        if (check_points(points, count, preset->track_count) != 0) {
+            return -1;
+        }
+        if (preset->track_count == CHIME_3DC_MAX_TRACKS) {
+            LOGE("chime 3dc: more than %d automation tracks", CHIME_3DC_MAX_TRACKS);
+            return -1;
+        }
+        if (v1) {
+            // the file bounds all records, each grows by the audio id only
+            if (preset->converted == NULL) {
+                preset->converted = (uint8_t *)malloc(file_size + CHIME_3DC_MAX_TRACKS * sizeof(int16_t));
+                if (preset->converted == NULL) {
+                    LOGE("chime 3dc: no memory for version 1 automation");
+                    return -1;
+                }
+            }
+            AutomationPoints *track = (AutomationPoints *)(preset->converted + preset->converted_size);
+            track->audio_id = -1;
+            track->count = count;
+            memcpy(track->points, points, count * sizeof(TimedPos));
+            preset->converted_size += AUTOMATION_HEADER_SIZE + count * sizeof(TimedPos);
+            preset->tracks[preset->track_count++] = track;
+        } else {
+            preset->tracks[preset->track_count++] = (const AutomationPoints *)(data + offset);
+        }
+        offset += header_size + count * sizeof(TimedPos);
+    }
+    return 0;
+}
+
+static void parse_fail(chime_3dc_t *preset)
+{
+    free(preset->converted);
+    memset(preset, 0, sizeof(*preset));
+}
+
+int chime_3dc_parse(chime_3dc_t *preset, const void *data, size_t size)
+{
+    memset(preset, 0, sizeof(*preset));
+    const uint8_t *base = (const uint8_t *)data;
+    if (data == NULL || size < sizeof(AACCfgFileHeader)) {
+        LOGE("chime 3dc: %zu bytes is too short for a file header", size);
+        return CHIME_3DC_ERR_INVALID;
+    }
+    const AACCfgFileHeader *header = (const AACCfgFileHeader *)base;
+    if (memcmp(header->formatId, CHIME_3DC_FORMAT_ID, sizeof(header->formatId)) != 0) {
+        LOGE("chime 3dc: format id is not %s, not a .3dc file", CHIME_3DC_FORMAT_ID);
+        return CHIME_3DC_ERR_MAGIC;
+    }
+    if (header->version < CHIME_3DC_VERSION_MIN || header->version > CHIME_3DC_VERSION_MAX) {
+        LOGE("chime 3dc: version %u is not in %d..%d", header->version, CHIME_3DC_VERSION_MIN,
+             CHIME_3DC_VERSION_MAX);
+        return CHIME_3DC_ERR_VERSION;
+    }
+    preset->header = header;
+    size_t offset = sizeof(AACCfgFileHeader);
+    while (offset < size) {
+        if (size - offset < sizeof(AACCfgChunkHeader)) {
+            LOGE("chime 3dc: %zu stray bytes at the end", size - offset);
+            return CHIME_3DC_ERR_INVALID;
+        }
+        const AACCfgChunkHeader *chunk = (const AACCfgChunkHeader *)(base + offset);
+        offset += sizeof(*chunk);
+        uint32_t chunk_size = chunk->chunkDataSize;
+        if (chunk_size > size - offset) {
+            LOGE("chime 3dc: chunk %u of %u bytes at offset %zu runs past the end", chunk->chunkType, chunk_size,
+                 offset - sizeof(*chunk));
+            return CHIME_3DC_ERR_INVALID;
+        }
+        int ret = 0;
+        switch (chunk->chunkType) {
+        case CHUNK_SPEAKER_POS:
+            ret = check_speakers(preset, base + offset, chunk_size);
+            break;
+        case CHUNK_SOUND_FIELD:
+            ret = check_sound_field(preset, base + offset, chunk_size);
+            break;
+        case CHUNK_AUDIO_AUTOMATION:
+            ret = check_automation(preset, base + offset, chunk_size, size);
+            break;
+        default:
+            LOGW("chime 3dc: skipping unknown chunk %u", chunk->chunkType);
+            break;
+        }
+        if (ret != 0) {
+            parse_fail(preset);
+            return CHIME_3DC_ERR_INVALID;
+        }
+        offset += chunk_size;
+    }
+    if (preset->speakers == NULL || preset->sound_field == NULL) {
+        LOGE("chime 3dc: no %s chunk", preset->speakers ? "sound field" : "speaker");
+        parse_fail(preset);
+        return CHIME_3DC_ERR_INVALID;
+    }
+    // a version 1 preset automates its one audio source
+    for (size_t at = 0; at < preset->converted_size;) {
+        AutomationPoints *track = (AutomationPoints *)(preset->converted + at);
+        track->audio_id = (int16_t)preset->sound_field->sourceId;
+        at += AUTOMATION_HEADER_SIZE + track->count * sizeof(TimedPos);
+    }
+    preset->base = data;
+    preset->size = size;
+    return CHIME_3DC_OK;
+}
+
+int chime_3dc_open(chime_3dc_t *preset, const char *file_path)
+{
+    struct stat st;
+    memset(preset, 0, sizeof(*preset));
+    int fd = open(file_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("chime 3dc: can't open %s", file_path);
+        return CHIME_3DC_ERR_INVALID;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(AACCfgFileHeader)) {
+        LOGE("chime 3dc: %s is too short", file_path);
+        close(fd);
+        return CHIME_3DC_ERR_INVALID;
+    }
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOGE("chime 3dc: can't map %s", file_path);
+        return CHIME_3DC_ERR_INVALID;
+    }
+    int ret = chime_3dc_parse(preset, base, st.st_size);
+    if (ret != CHIME_3DC_OK) {
+        LOGE("chime 3dc: %s is not a valid preset", file_path);
+        munmap(base, st.st_size);
+        return ret;
+    }
+    preset->mapped = 1;
+    LOGI("chime 3dc: %s version %u, %d speakers, %d automation tracks", file_path, preset->header->version,
+         preset->speaker_count, preset->track_count);
+    return CHIME_3DC_OK;
+}
+
+const AutomationPoints *chime_3dc_track(const chime_3dc_t *preset, int16_t audio_id)
+{
+    for (int i = 0; i < preset->track_count; i++) {
+        if (preset->tracks[i]->audio_id == audio_id) {
+            return preset->tracks[i];
+        }
+    }
+    return NULL;
+}
+
+void chime_3dc_close(chime_3dc_t *preset)
+{
+    if (preset->base && preset->mapped) {
+        munmap((void *)preset->base, preset->size);
+    }
+    free(preset->converted);
+    if (__atomic_load_n(&selected, __ATOMIC_ACQUIRE) == preset) {
+        LOGW("chime 3dc: closing the selected preset");
+        __atomic_store_n(&selected, NULL, __ATOMIC_RELEASE);
+    }
+    memset(preset, 0, sizeof(*preset));
+}
+
+void chime_3dc_select(const chime_3dc_t *preset)
+{
+    __atomic_store_n(&selected, preset, __ATOMIC_RELEASE);
+}
+
+const chime_3dc_t *chime_3dc_selected(void)
+{
+    return __atomic_load_n(&selected, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,122 @@
+/***************************************************************************
+ * Description: zero copy loader for .3dc chime configs
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 19:20:37
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _CHIME_3DC_H
+#define _CHIME_3DC_H
+
+#include "Chime3dCommon.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIME_3DC_MAX_TRACKS 32 // automation tracks one preset can carry
+#define CHIME_3DC_FORMAT_ID "AACCFG" // formatId, not terminated in the file
+#define CHIME_3DC_VERSION_MIN 1      // oldest layout this loader reads
+#define CHIME_3DC_VERSION_MAX 2      // newest layout this loader reads
+
+// what chime_3dc_open and chime_3dc_parse return
+#define CHIME_3DC_OK 0
+#define CHIME_3DC_ERR_INVALID -1 // unreadable, truncated or inconsistent file
+#define CHIME_3DC_ERR_MAGIC -2   // formatId is not CHIME_3DC_FORMAT_ID, not a .3dc file
+#define CHIME_3DC_ERR_VERSION -3 // version outside CHIME_3DC_VERSION_MIN..CHIME_3DC_VERSION_MAX
+
+/* Layout of a .3dc file, packed, native byte order: the file header, then
+ * chunks of a chunk header followed by chunkDataSize bytes, in any order.
+ *
+ * CHUNK_SPEAKER_POS       uint8_t speaker_count, ObjectPos[speaker_count].
+ *                         The chunk may be longer, chime_config_struct wrote
+ *                         12 slots whatever the count.
+ * CHUNK_SOUND_FIELD       SoundField
+ * CHUNK_AUDIO_AUTOMATION  AutomationPoints records back to back, each with
+ *                         count TimedPos sorted by time. The chunk may
+ *                         appear more than once.
+ *                         Version 1 records are {int16_t count; TimedPos[]},
+ *                         without the audio id, and belong to the sound
+ *                         field's sourceId. Version 2 records are
+ *                         AutomationPoints from Chime3dCommon.h.
+ *
+ * Chunks of other types are skipped. */
+#pragma pack(push, 1)
+typedef struct _AACCfgFileHeader {
+    char formatId[6];
+    uint16_t version; // roll up when data struct is significantly changed
+} AACCfgFileHeader;
+
+typedef struct _AACCfgChunkHeader {
+    uint16_t chunkType;
+    uint32_t chunkDataSize;
+} AACCfgChunkHeader;
+
+typedef struct _SoundField {
+    uint16_t sourceId;
+    int16_t positionId;
+    uint8_t isLoop;
+    uint16_t loopInterval;
+    uint8_t algorithmMode;
+    ObjectPos listenerPos;
+    ObjectPos audioSourcePos;
+    uint8_t automationEnabled;
+} SoundField;
+#pragma pack(pop)
+
+typedef enum {
+    CHUNK_SPEAKER_POS = 1,
+    CHUNK_SOUND_FIELD,
+    CHUNK_AUDIO_AUTOMATION
+} ChunkType_t,
+    *ChunkType_ptr;
+
+/* A validated preset. Every pointer points into the file itself, nothing is
+ * copied, and the structs are packed so they may sit at any address. Only
+ * the automation of a version 1 file is copied, into converted, to add the
+ * audio id. The preset never changes once chime_3dc_open returned. */
+typedef struct chime_3dc {
+    const AACCfgFileHeader *header;
+    const ObjectPos *speakers;
+    int speaker_count;
+    const SoundField *sound_field;
+    const AutomationPoints *tracks[CHIME_3DC_MAX_TRACKS];
+    int track_count;
+    const void *base;
+    size_t size;
+    int mapped;            // 0 when base belongs to the caller of chime_3dc_parse
+    uint8_t *converted;    // version 1 automation in the current layout, NULL otherwise
+    size_t converted_size;
+} chime_3dc_t;
+
+/* Maps file_path and validates it in one pass over the chunks: the format
+ * id and version of the header, every chunk inside the file, speaker and
+ * sound field chunks present once and large enough, positions finite,
+ * automation points inside their chunk and in time order. Returns
+ * CHIME_3DC_OK, or one of the CHIME_3DC_ERR_* codes with nothing mapped. */
+int chime_3dc_open(chime_3dc_t *preset, const char *file_path);
+
+// same checks on a buffer the caller keeps alive and unchanged until chime_3dc_close
+int chime_3dc_parse(chime_3dc_t *preset, const void *data, size_t size);
+
+// automation track of an audio id, NULL when the preset has none
+const AutomationPoints *chime_3dc_track(const chime_3dc_t *preset, int16_t audio_id);
+
+void chime_3dc_close(chime_3dc_t *preset);
+
+/* The preset the audio thread renders with. Loading and validating is done
+ * up front by chime_3dc_open, switching is one atomic pointer store and
+ * reading it one atomic load, safe on the audio thread. A preset must stay
+ * open for as long as it can be selected or is being rendered, so keep the
+ * bank of presets open and close them only after audio has stopped. */
+void chime_3dc_select(const chime_3dc_t *preset);
+const chime_3dc_t *chime_3dc_selected(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CHIME_3DC_H
@@ -0,0 +1,142 @@
+/***************************************************************************
+ * Description: test the .3dc loader on a built preset and broken headers
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 18:52:10
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#include "chime_3dc.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#pragma pack(1)
+typedef struct {
+    AACCfgFileHeader file_header;
+    AACCfgChunkHeader speaker_chunk_header;
+    uint8_t speaker_count;
+    ObjectPos speakers[5];
+    AACCfgChunkHeader sound_field_chunk_header;
+    SoundField sound_field;
+} test_preset_t;
+
+// a preset followed by one automation record of two points, in either layout
+typedef struct {
+    test_preset_t preset;
+    AACCfgChunkHeader automation_chunk_header;
+    union {
+        struct {
+            int16_t count;
+            TimedPos points[2];
+        } v1;
+        struct {
+            int16_t audio_id;
+            int16_t count;
+            TimedPos points[2];
+        } v2;
+    } record;
+} test_automation_t;
+#pragma pack()
+
+static void build_preset(test_preset_t *preset)
+{
+    memset(preset, 0, sizeof(*preset));
+    memcpy(preset->file_header.formatId, CHIME_3DC_FORMAT_ID, sizeof(preset->file_header.formatId));
+    preset->file_header.version = CHIME_3DC_VERSION_MAX;
+    preset->speaker_chunk_header.chunkType = CHUNK_SPEAKER_POS;
+    preset->speaker_chunk_header.chunkDataSize = 1 + sizeof(preset->speakers);
+    preset->speaker_count = 5;
+    for (int i = 0; i < 5; i++) {
+        preset->speakers[i].id = i;
+        preset->speakers[i].x = i % 2 ? -2.4f : 2.4f;
+        preset->speakers[i].z = i < 2 ? 2.7f : -1.0f;
+    }
+    preset->sound_field_chunk_header.chunkType = CHUNK_SOUND_FIELD;
+    preset->sound_field_chunk_header.chunkDataSize = sizeof(SoundField);
+}
+
+static void set_points(TimedPos *points)
+{
+    for (int i = 0; i < 2; i++) {
+        points[i].time = (int16_t)(i * 500);
+        points[i].x = 1.0f + i;
+        points[i].y = 0.0f;
+        points[i].z = -1.0f;
+    }
+}
+
+// the track must be found under audio_id and hold the points set_points wrote
+static int expect_track(const char *name, test_automation_t *data, size_t size, int16_t audio_id)
+{
+    chime_3dc_t preset;
+    int ret = chime_3dc_parse(&preset, data, size);
+    const AutomationPoints *track = ret == CHIME_3DC_OK ? chime_3dc_track(&preset, audio_id) : NULL;
+    int ok = track != NULL && track->count == 2 && track->points[1].time == 500 && track->points[1].x == 2.0f;
+    printf("%s: %d, %s\n", name, ret, ok ? "ok" : "FAILED");
+    if (ret == CHIME_3DC_OK) {
+        chime_3dc_close(&preset);
+    }
+    return !ok;
+}
+
+static int expect(const char *name, const test_preset_t *data, int want)
+{
+    chime_3dc_t preset;
+    int ret = chime_3dc_parse(&preset, data, sizeof(*data));
+    printf("%s: %d, %s\n", name, ret, ret == want ? "ok" : "FAILED");
+    if (ret == CHIME_3DC_OK) {
+        chime_3dc_close(&preset);
+    }
+    return ret != want;
+}
+
+int main()
+{
+    test_preset_t data;
+    int failed = 0;
+
+    build_preset(&data);
+    failed |= expect("valid preset", &data, CHIME_3DC_OK);
+
+    build_preset(&data);
+    memcpy(data.file_header.formatId, "RIFFWA", sizeof(data.file_header.formatId));
+    failed |= expect("bad magic", &data, CHIME_3DC_ERR_MAGIC);
+
+    build_preset(&data);
+    data.file_header.version = CHIME_3DC_VERSION_MAX + 1;
+    failed |= expect("newer version", &data, CHIME_3DC_ERR_VERSION);
+
+    build_preset(&data);
+    data.file_header.version = CHIME_3DC_VERSION_MIN - 1;
+    failed |= expect("older version", &data, CHIME_3DC_ERR_VERSION);
+
+    build_preset(&data);
+    data.sound_field_chunk_header.chunkDataSize = sizeof(SoundField) + 1;
+    failed |= expect("chunk past the end", &data, CHIME_3DC_ERR_INVALID);
+
+    test_automation_t automation;
+    build_preset(&automation.preset);
+    automation.preset.file_header.version = 2;
+    automation.automation_chunk_header.chunkType = CHUNK_AUDIO_AUTOMATION;
+    automation.automation_chunk_header.chunkDataSize = sizeof(automation.record.v2);
+    automation.record.v2.audio_id = 7;
+    automation.record.v2.count = 2;
+    set_points(automation.record.v2.points);
+    failed |= expect_track("version 2 automation", &automation, sizeof(automation), 7);
+
+    build_preset(&automation.preset);
+    automation.preset.file_header.version = 1;
+    automation.preset.sound_field.sourceId = 5;
+    automation.automation_chunk_header.chunkDataSize = sizeof(automation.record.v1);
+    automation.record.v1.count = 2;
+    set_points(automation.record.v1.points);
+    failed |= expect_track("version 1 automation", &automation,
+                           offsetof(test_automation_t, record) + sizeof(automation.record.v1), 5);
+
+    return failed;
+}
+
+/* Compile Command:
+    gcc chime_3dc_test.c chime_3dc.c log.c -lm -lpthread -o chime_3dc_test && ./chime_3dc_test
+*/
@@ -0,0 +1,314 @@
+/***************************************************************************
+ * Description: automation paths of chime sources, evaluated for many sources at once
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 19:58:12
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * All the work that depends only on the points is done when a track is
+ * added: tangents, cubic coefficients and the reciprocal of each segment's
+ * length. What is left per evaluation is a multiply and a clamp for u and
+ * three cubics in Horner form.
+ *
+ * chime_automation_advance moves every source's time forward and compares
+ * it with the time its segment ends, both straight loops over the source
+ * arrays. Only the few sources that crossed into another segment, wrapped
+ * or reached the end take the scalar path, which steps the segment cursor
+ * forward and copies the new segment's coefficients into the source's
+ * slot. The evaluation then reads every array with the same index, no
+ * branches and no gathers, and the compiler turns it into SIMD at -O3 or
+ * with -ftree-vectorize.
+ *
+ * Catmull-Rom tangents take the spacing of the neighbouring points in time
+ * into account, keyframes far apart do not overshoot. The first and last
+ * point stand in for their missing neighbours.
+ */
+
+#include "chime_automation.h"
+#include "log.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_ALIGN 64 // bytes, a cache line and the widest vector register
+
+#if defined(__GNUC__)
+#define RESTRICT __restrict__
+#else
+#define RESTRICT
+#endif
+
+static size_t aligned_size(size_t size)
+{
+    return (size + ARRAY_ALIGN - 1) & ~(size_t)(ARRAY_ALIGN - 1);
+}
+
+static void *carve(char **cursor, size_t size)
+{
+    void *ptr = *cursor;
+    *cursor += aligned_size(size);
+    return ptr;
+}
+
+int chime_automation_init(chime_automation_t *automation, int max_tracks, int max_segments, int max_sources)
+{
+    memset(automation, 0, sizeof(*automation));
+    if (max_tracks <= 0 || max_segments <= 0 || max_sources <= 0) {
+        LOGE("chime automation: invalid limits %d tracks %d segments %d sources", max_tracks, max_segments,
+             max_sources);
+        return -1;
+    }
+    size_t seg_floats = aligned_size(max_segments * sizeof(float));
+    size_t src_floats = aligned_size(max_sources * sizeof(float));
+    size_t src_doubles = aligned_size(max_sources * sizeof(double));
+    size_t total = 14 * seg_floats + aligned_size(max_tracks * sizeof(chime_automation_track_t)) +
+                   2 * aligned_size(max_sources * sizeof(int)) + aligned_size(max_sources) + src_doubles +
+                   20 * src_floats;
+    void *block = NULL;
+    if (posix_memalign(&block, ARRAY_ALIGN, total) != 0) {
+        LOGE("chime automation: out of memory for %zu bytes", total);
+        return -1;
+    }
+    memset(block, 0, total);
+    char *cursor = (char *)block;
+    automation->seg_start = (float *)carve(&cursor, seg_floats);
+    automation->seg_scale = (float *)carve(&cursor, seg_floats);
+    for (int i = 0; i < 12; i++) {
+        automation->seg_coef[i] = (float *)carve(&cursor, seg_floats);
+    }
+    automation->tracks = (chime_automation_track_t *)carve(&cursor, max_tracks * sizeof(chime_automation_track_t));
+    automation->src_track = (int *)carve(&cursor, max_sources * sizeof(int));
+    automation->src_segment = (int *)carve(&cursor, max_sources * sizeof(int));
+    automation->src_state = (uint8_t *)carve(&cursor, max_sources);
+    automation->src_time = (double *)carve(&cursor, src_doubles);
+    automation->src_start = (float *)carve(&cursor, src_floats);
+    automation->src_scale = (float *)carve(&cursor, src_floats);
+    automation->src_next = (float *)carve(&cursor, src_floats);
+    automation->src_rate = (float *)carve(&cursor, src_floats);
+    automation->src_u = (float *)carve(&cursor, src_floats);
+    for (int i = 0; i < 12; i++) {
+        automation->src_coef[i] = (float *)carve(&cursor, src_floats);
+    }
+    automation->x = (float *)carve(&cursor, src_floats);
+    automation->y = (float *)carve(&cursor, src_floats);
+    automation->z = (float *)carve(&cursor, src_floats);
+    automation->max_tracks = max_tracks;
+    automation->max_segments = max_segments;
+    automation->max_sources = max_sources;
+    automation->block = block;
+    return 0;
+}
+
+void chime_automation_free(chime_automation_t *automation)
+{
+    free(automation->block);
+    memset(automation, 0, sizeof(*automation));
+}
+
+static void point_axes(const TimedPos *point, double axes[3])
+{
+    axes[0] = point->x;
+    axes[1] = point->y;
+    axes[2] = point->z;
+}
+
+static void set_segment(chime_automation_t *automation, int seg, const AutomationPoints *points, int i,
+                        chime_automation_curve_t curve)
+{
+    int last = points->count - 1;
+    const TimedPos *p1 = &points->points[i];
+    const TimedPos *p2 = &points->points[i < last ? i + 1 : i];
+    const TimedPos *p0 = &points->points[i > 0 ? i - 1 : i];
+    const TimedPos *p3 = &points->points[i + 2 <= last ? i + 2 : (i < last ? i + 1 : i)];
+    double v0[3], v1[3], v2[3], v3[3];
+    point_axes(p0, v0);
+    point_axes(p1, v1);
+    point_axes(p2, v2);
+    point_axes(p3, v3);
+    double length = (double)p2->time - p1->time;
+    for (int axis = 0; axis < 3; axis++) {
+        float *c0 = automation->seg_coef[axis * 4];
+        float *c1 = automation->seg_coef[axis * 4 + 1];
+        float *c2 = automation->seg_coef[axis * 4 + 2];
+        float *c3 = automation->seg_coef[axis * 4 + 3];
+        c0[seg] = (float)v1[axis];
+        if (curve == CHIME_AUTOMATION_LINEAR || length <= 0) {
+            c1[seg] = (float)(v2[axis] - v1[axis]);
+            c2[seg] = c3[seg] = 0;
+            continue;
+        }
+        // Hermite form, tangents scaled from ms to this segment's u
+        double span0 = (double)p2->time - p0->time;
+        double span1 = (double)p3->time - p1->time;
+        double m1 = span0 > 0 ? (v2[axis] - v0[axis]) * length / span0 : 0;
+        double m2 = span1 > 0 ? (v3[axis] - v1[axis]) * length / span1 : 0;
+        c1[seg] = (float)m1;
+        c2[seg] = (float)(3 * (v2[axis] - v1[axis]) - 2 * m1 - m2);
+        c3[seg] = (float)(2 * (v1[axis] - v2[axis]) + m1 + m2);
+    }
+    automation->seg_start[seg] = p1->time;
+    automation->seg_scale[seg] = length > 0 ? (float)(1.0 / length) : 0.0f;
+}
+
+int chime_automation_add_track(chime_automation_t *automation, const AutomationPoints *points,
+                               chime_automation_curve_t curve)
+{
+    int count = points->count;
+    int segments = count > 1 ? count - 1 : 1;
+    if (count <= 0 || automation->track_count == automation->max_tracks ||
+        segments > automation->max_segments - automation->segment_count) {
+        LOGE("chime automation: no room for audio %d with %d points", points->audio_id, count);
+        return -1;
+    }
+    for (int i = 1; i < count; i++) {
+        if (points->points[i].time < points->points[i - 1].time) {
+            LOGE("chime automation: audio %d point %d goes back in time", points->audio_id, i);
+            return -1;
+        }
+    }
+    int first = automation->segment_count;
+    for (int i = 0; i < segments; i++) {
+        set_segment(automation, first + i, points, i, curve);
+    }
+    chime_automation_track_t *track = &automation->tracks[automation->track_count];
+    track->audio_id = points->audio_id;
+    track->first = first;
+    track->count = segments;
+    track->start = points->points[0].time;
+    track->end = points->points[count - 1].time;
+    automation->segment_count += segments;
+    return automation->track_count++;
+}
+
+int chime_automation_find(const chime_automation_t *automation, int16_t audio_id)
+{
+    for (int i = 0; i < automation->track_count; i++) {
+        if (automation->tracks[i].audio_id == audio_id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void enter_segment(chime_automation_t *automation, int source, int seg)
+{
+    const chime_automation_track_t *track = &automation->tracks[automation->src_track[source]];
+    automation->src_segment[source] = seg;
+    automation->src_start[source] = automation->seg_start[seg];
+    automation->src_scale[source] = automation->seg_scale[seg];
+    automation->src_next[source] = seg < track->first + track->count - 1 ? automation->seg_start[seg + 1] : track->end;
+    for (int i = 0; i < 12; i++) {
+        automation->src_coef[i][source] = automation->seg_coef[i][seg];
+    }
+}
+
+// parks a source where it is, it keeps its position but no longer moves
+static void park(chime_automation_t *automation, int source, uint8_t state)
+{
+    automation->src_state[source] = state;
+    automation->src_rate[source] = 0.0f;
+    automation->src_next[source] = INFINITY;
+}
+
+int chime_automation_start(chime_automation_t *automation, int track, int loop)
+{
+    if (track < 0 || track >= automation->track_count) {
+        return -1;
+    }
+    for (int source = 0; source < automation->max_sources; source++) {
+        if (automation->src_state[source] != CHIME_SOURCE_FREE) {
+            continue;
+        }
+        automation->src_track[source] = track;
+        automation->src_time[source] = automation->tracks[track].start;
+        automation->src_state[source] = loop ? CHIME_SOURCE_LOOPING : CHIME_SOURCE_PLAYING;
+        automation->src_rate[source] = 1.0f;
+        enter_segment(automation, source, automation->tracks[track].first);
+        if (source >= automation->source_count) {
+            automation->source_count = source + 1;
+        }
+        automation->active_count++;
+        return source;
+    }
+    return -1;
+}
+
+void chime_automation_stop(chime_automation_t *automation, int source)
+{
+    if (source < 0 || source >= automation->source_count || automation->src_state[source] == CHIME_SOURCE_FREE) {
+        return;
+    }
+    park(automation, source, CHIME_SOURCE_FREE);
+    automation->active_count--;
+    while (automation->source_count > 0 && automation->src_state[automation->source_count - 1] == CHIME_SOURCE_FREE) {
+        automation->source_count--;
+    }
+}
+
+// a source passed the end of its segment, move it on to the segment its time is in
+static void cross(chime_automation_t *automation, int source)
+{
+    const chime_automation_track_t *track = &automation->tracks[automation->src_track[source]];
+    double time = automation->src_time[source];
+    int seg = automation->src_segment[source];
+    if (time >= track->end) {
+        double duration = (double)track->end - track->start;
+        if (automation->src_state[source] != CHIME_SOURCE_LOOPING || duration <= 0) {
+            automation->src_time[source] = track->end;
+            enter_segment(automation, source, track->first + track->count - 1);
+            park(automation, source, CHIME_SOURCE_FINISHED);
+            return;
+        }
+        time = track->start + fmod(time - track->start, duration);
+        seg = track->first;
+    }
+    int last = track->first + track->count - 1;
+    while (seg < last && time >= automation->seg_start[seg + 1]) {
+        seg++;
+    }
+    automation->src_time[source] = time;
+    enter_segment(automation, source, seg);
+}
+
+// the subtraction stays in double, what is left of it fits a float
+static void segment_position(float *RESTRICT u, const double *RESTRICT time, const float *RESTRICT start,
+                             const float *RESTRICT scale, int count)
+{
+    for (int i = 0; i < count; i++) {
+        float v = (float)(time[i] - start[i]) * scale[i];
+        v = v < 0.0f ? 0.0f : v;
+        u[i] = v > 1.0f ? 1.0f : v;
+    }
+}
+
+static void cubic(float *RESTRICT out, const float *RESTRICT u, const float *RESTRICT c0, const float *RESTRICT c1,
+                  const float *RESTRICT c2, const float *RESTRICT c3, int count)
+{
+    for (int i = 0; i < count; i++) {
+        out[i] = ((c3[i] * u[i] + c2[i]) * u[i] + c1[i]) * u[i] + c0[i];
+    }
+}
+
+int chime_automation_advance(chime_automation_t *automation, double dt_ms)
+{
+    int count = automation->source_count;
+    double *RESTRICT time = automation->src_time;
+    const float *RESTRICT rate = automation->src_rate;
+    for (int i = 0; i < count; i++) {
+        time[i] += dt_ms * rate[i];
+    }
+    // cross rewrites both arrays, so no restrict here
+    for (int i = 0; i < count; i++) {
+        if (__builtin_expect(automation->src_time[i] >= automation->src_next[i], 0)) {
+            cross(automation, i);
+        }
+    }
+    float *const *coef = automation->src_coef;
+    segment_position(automation->src_u, automation->src_time, automation->src_start, automation->src_scale, count);
+    cubic(automation->x, automation->src_u, coef[0], coef[1], coef[2], coef[3], count);
+    cubic(automation->y, automation->src_u, coef[4], coef[5], coef[6], coef[7], count);
+    cubic(automation->z, automation->src_u, coef[8], coef[9], coef[10], coef[11], count);
+    return automation->active_count;
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+ * Description: automation paths of chime sources, evaluated for many sources at once
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 19:58:12
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _CHIME_AUTOMATION_H
+#define _CHIME_AUTOMATION_H
+
+#include "Chime3dCommon.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    CHIME_AUTOMATION_LINEAR,
+    CHIME_AUTOMATION_CATMULL_ROM
+} chime_automation_curve_t;
+
+enum {
+    CHIME_SOURCE_FREE,
+    CHIME_SOURCE_PLAYING,
+    CHIME_SOURCE_LOOPING,
+    CHIME_SOURCE_FINISHED // parked on the last point until stopped
+};
+
+typedef struct chime_automation_track {
+    int16_t audio_id;
+    int first;             // first segment of the track
+    int count;             // segments, one constant segment for a single point
+    float start;           // ms, time of the first point
+    float end;             // ms, time of the last point
+} chime_automation_track_t;
+
+/* Segments hold the cubic c0 + c1 u + c2 u^2 + c3 u^3 per axis, with
+ * u = (t - start) * scale running from 0 to 1 over the segment. A linear
+ * segment is the same cubic with c2 = c3 = 0, so both curves share one
+ * evaluation loop. Sources keep a copy of the segment they are in, every
+ * per source array is indexed by the source slot. */
+typedef struct chime_automation {
+    float *seg_start;
+    float *seg_scale;
+    float *seg_coef[12];   // x c0..c3, y c0..c3, z c0..c3
+    int segment_count;
+    int max_segments;
+
+    chime_automation_track_t *tracks;
+    int track_count;
+    int max_tracks;
+
+    int *src_track;
+    int *src_segment;
+    uint8_t *src_state;
+    double *src_time;      // ms on the track's time line, double so per sample steps do not drift
+    float *src_start;
+    float *src_scale;
+    float *src_next;       // time the source leaves its segment
+    float *src_rate;       // 1 while moving, 0 once parked
+    float *src_u;          // where in its segment the source is, 0 to 1
+    float *src_coef[12];
+    float *x, *y, *z;      // positions after the last chime_automation_advance
+    int source_count;      // slots in use up to the highest one
+    int active_count;      // slots that are not free
+    int max_sources;
+    void *block;
+} chime_automation_t;
+
+/* Allocates room for everything up front, nothing allocates afterwards.
+ * Returns 0 or -1. */
+int chime_automation_init(chime_automation_t *automation, int max_tracks, int max_segments, int max_sources);
+void chime_automation_free(chime_automation_t *automation);
+
+/* Turns the points of a track, for example one of chime_3dc_t tracks, into
+ * segment coefficients. Times are in ms and must not decrease. Returns the
+ * track index or -1. Not for the audio thread. */
+int chime_automation_add_track(chime_automation_t *automation, const AutomationPoints *points,
+                               chime_automation_curve_t curve);
+
+// track index of an audio id, -1 when there is none
+int chime_automation_find(const chime_automation_t *automation, int16_t audio_id);
+
+// starts a source at the first point of a track, returns its slot or -1 when all are taken
+int chime_automation_start(chime_automation_t *automation, int track, int loop);
+void chime_automation_stop(chime_automation_t *automation, int source);
+
+/* Moves every source dt_ms along its track and stores the new positions in
+ * x, y and z. A looping source wraps back to the first point, any other one
+ * stops on the last point. Call once per block, or once per sample with
+ * dt_ms = 1000.0 / sample_rate for per sample positions. No allocation and
+ * no lock. Returns how many sources were evaluated, free slots below the
+ * highest one in use go through the loops unchanged and are not counted. */
+int chime_automation_advance(chime_automation_t *automation, double dt_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CHIME_AUTOMATION_H
@@ -0,0 +1,202 @@
+/* **************************************************************
+ * @Description: evaluation rate of chime_automation for many sources
+ * @Date: 2026-10-19 20:21:45
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+// gcc -O3 -march=native chime_automation_bench.c chime_automation.c log.c -lm -lpthread -o chime_automation_bench
+// ./chime_automation_bench [sources] [points] [seconds]
+
+#include "chime_automation.h"
+#include "log.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_SOURCES 64
+#define DEFAULT_POINTS 16
+#define DEFAULT_SECONDS 1
+#define SAMPLE_RATE 48000
+#define BLOCK_FRAMES 1024
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// a wobbly circle around the listener, one per track
+static AutomationPoints *make_track(int16_t audio_id, int points)
+{
+    AutomationPoints *track = (AutomationPoints *)malloc(offsetof(AutomationPoints, points) + points * sizeof(TimedPos));
+    if (track == NULL) {
+        return NULL;
+    }
+    track->audio_id = audio_id;
+    track->count = (int16_t)points;
+    for (int i = 0; i < points; i++) {
+        double angle = 2 * M_PI * i / points + audio_id;
+        track->points[i].time = (int16_t)(i * 200 + (i % 3) * 40);
+        track->points[i].x = (float)(2 * cos(angle));
+        track->points[i].y = (float)(0.5 * sin(3 * angle));
+        track->points[i].z = (float)(2 * sin(angle));
+    }
+    return track;
+}
+
+// straight from the points, what a linear track must give at time ms
+static void linear_reference(const AutomationPoints *track, double time, double pos[3])
+{
+    int i = 0;
+    while (i < track->count - 2 && time >= track->points[i + 1].time) {
+        i++;
+    }
+    const TimedPos *a = &track->points[i];
+    const TimedPos *b = &track->points[i + 1];
+    double u = (time - a->time) / (b->time - a->time);
+    u = u < 0 ? 0 : (u > 1 ? 1 : u);
+    pos[0] = a->x + (b->x - a->x) * u;
+    pos[1] = a->y + (b->y - a->y) * u;
+    pos[2] = a->z + (b->z - a->z) * u;
+}
+
+static int check(AutomationPoints **tracks, int points)
+{
+    chime_automation_t automation;
+    if (chime_automation_init(&automation, 2, 2 * points, 2) != 0) {
+        return -1;
+    }
+    int linear = chime_automation_add_track(&automation, tracks[0], CHIME_AUTOMATION_LINEAR);
+    int curve = chime_automation_add_track(&automation, tracks[0], CHIME_AUTOMATION_CATMULL_ROM);
+    int a = chime_automation_start(&automation, linear, 0);
+    int b = chime_automation_start(&automation, curve, 0);
+    double error = 0, knot_error = 0;
+    double end = tracks[0]->points[points - 1].time;
+    double time = tracks[0]->points[0].time;
+    chime_automation_advance(&automation, 0);
+    for (int step = 0; time <= end + 100; step++) {
+        double pos[3];
+        linear_reference(tracks[0], time < end ? time : end, pos);
+        error = fmax(error, fabs(automation.x[a] - pos[0]) + fabs(automation.y[a] - pos[1]) +
+                                fabs(automation.z[a] - pos[2]));
+        for (int i = 0; i < points; i++) {
+            if (tracks[0]->points[i].time == time && (i == points - 1 || tracks[0]->points[i + 1].time != time)) {
+                knot_error = fmax(knot_error, fabs(automation.x[b] - tracks[0]->points[i].x) +
+                                                  fabs(automation.z[b] - tracks[0]->points[i].z));
+            }
+        }
+        chime_automation_advance(&automation, 1.0f);
+        time += 1.0;
+    }
+    chime_automation_free(&automation);
+    printf("check: linear max error %.2e, catmull-rom error at keyframes %.2e\n", error, knot_error);
+    return error < 1e-4 && knot_error < 1e-4 ? 0 : -1;
+}
+
+// a ramp where x is the time in ms, stepped once per sample up to late on the int16_t time line
+static int check_drift(void)
+{
+    struct {
+        int16_t audio_id, count;
+        TimedPos points[2];
+    } ramp = {0, 2, {{0, 0.0f, 0.0f, 0.0f}, {32000, 32000.0f, 0.0f, 0.0f}}};
+    chime_automation_t automation;
+    if (chime_automation_init(&automation, 1, 1, 1) != 0) {
+        return -1;
+    }
+    int track = chime_automation_add_track(&automation, (const AutomationPoints *)&ramp, CHIME_AUTOMATION_LINEAR);
+    int source = chime_automation_start(&automation, track, 0);
+    long samples = 30L * SAMPLE_RATE;
+    for (long i = 0; i < samples; i++) {
+        chime_automation_advance(&automation, 1000.0 / SAMPLE_RATE);
+    }
+    double drift = fabs(automation.x[source] - 30000.0);
+    chime_automation_free(&automation);
+    printf("check: drift after 30 s of per sample steps %.3f ms\n", drift);
+    return drift < 0.1 ? 0 : -1;
+}
+
+static double run(chime_automation_t *automation, float dt_ms, double seconds, long *evals)
+{
+    long calls = 0;
+    int evaluated = 0;
+    double start = now_seconds(), elapsed;
+    do {
+        for (int i = 0; i < 1000; i++) {
+            evaluated = chime_automation_advance(automation, dt_ms);
+        }
+        calls += 1000;
+        elapsed = now_seconds() - start;
+    } while (elapsed < seconds);
+    *evals = calls * evaluated;
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    int sources = argc > 1 ? atoi(argv[1]) : DEFAULT_SOURCES;
+    int points = argc > 2 ? atoi(argv[2]) : DEFAULT_POINTS;
+    double seconds = argc > 3 ? atof(argv[3]) : DEFAULT_SECONDS;
+    if (sources <= 0 || points < 2 || points > 150 || seconds <= 0) {
+        printf("Usage: %s [sources] [points 2..150] [seconds]\n", argv[0]);
+        return -1;
+    }
+    AutomationPoints **tracks = (AutomationPoints **)calloc(sources, sizeof(*tracks));
+    for (int i = 0; i < sources; i++) {
+        if ((tracks[i] = make_track((int16_t)i, points)) == NULL) {
+            printf("out of memory\n");
+            return -1;
+        }
+    }
+    if (check(tracks, points) != 0 || check_drift() != 0) {
+        printf("evaluation does not match the keyframes\n");
+        return -1;
+    }
+
+    chime_automation_t automation;
+    if (chime_automation_init(&automation, sources, sources * points, sources) != 0) {
+        return -1;
+    }
+    double start = now_seconds();
+    for (int i = 0; i < sources; i++) {
+        chime_automation_curve_t curve = i % 2 ? CHIME_AUTOMATION_CATMULL_ROM : CHIME_AUTOMATION_LINEAR;
+        chime_automation_start(&automation, chime_automation_add_track(&automation, tracks[i], curve), 1);
+    }
+    double load = now_seconds() - start;
+    printf("%d looping sources, %d points each, half linear half catmull-rom, tracks built in %.3f ms\n", sources,
+           points, load * 1e3);
+
+    const struct {
+        const char *name;
+        float dt_ms;
+    } modes[] = {
+        {"per block", 1000.0f * BLOCK_FRAMES / SAMPLE_RATE},
+        {"per sample", 1000.0f / SAMPLE_RATE},
+    };
+    printf("%-12s %16s %12s %22s\n", "mode", "evals/s", "ns/eval", "realtime load 48 kHz");
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        long evals;
+        double elapsed = run(&automation, modes[m].dt_ms, seconds, &evals);
+        double rate = evals / elapsed;
+        double calls_per_second = 1000.0 / modes[m].dt_ms;
+        printf("%-12s %16.0f %12.2f %21.4f%%\n", modes[m].name, rate, 1e9 / rate,
+               100.0 * calls_per_second * sources / rate);
+    }
+
+    float sum = 0;
+    for (int i = 0; i < sources; i++) {
+        sum += automation.x[i] + automation.y[i] + automation.z[i];
+    }
+    printf("position checksum %.3f\n", sum);
+    chime_automation_free(&automation);
+    for (int i = 0; i < sources; i++) {
+        free(tracks[i]);
+    }
+    free(tracks);
+    return 0;
+}
@@ -0,0 +1,453 @@
+/***************************************************************************
+ * Description: precompiled binary cache of the chime3D.xml mapping
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 18:10:44
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * The mapping almost never changes between boots, so the parsed result is
+ * kept in a flat file that can be used straight from an mmap. Entries refer
+ * to strings by offset, nothing in the file needs fixing up after mapping.
+ *
+ * Freshness is decided from a stat of the XML. Size and mtime unchanged
+ * means the cache is used without touching the XML. When they differ the
+ * XML is hashed, since a copy or a package update can touch the mtime
+ * without changing a byte, and only a different hash costs a parse. The
+ * checksum is verified on every open, a cache torn by a power cut or a bad
+ * block is rebuilt rather than trusted.
+ *
+ * Full paths are joined once here, at build time, and stored once however
+ * many ids share them. An index with one slot per id between the lowest and
+ * the highest id turns a lookup into a bounds check and a load, which is
+ * what the audio thread calls when a chime is triggered. A new cache is written to a
+ * temporary file and renamed over the old one, so a reader never sees it
+ * half written.
+ */
+
+#include "chime_cache.h"
+#include "chime_xml.h"
+#include "log.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+// FNV-1a over 64 bit words rather than bytes, eight times fewer multiplies on the open path
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, p + i, sizeof(word));
+        hash = (hash ^ word) * FNV_PRIME;
+    }
+    for (; i < len; i++) {
+        hash = (hash ^ p[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint64_t blob_checksum(const void *base, size_t size)
+{
+    size_t skip = offsetof(chime_cache_header_t, checksum) + sizeof(uint64_t);
+    return fnv1a(FNV_OFFSET, (const char *)base + skip, size - skip);
+}
+
+static int64_t mtime_ns(const struct stat *st)
+{
+#if defined(__APPLE__)
+    return (int64_t)st->st_mtimespec.tv_sec * 1000000000LL + st->st_mtimespec.tv_nsec;
+#else
+    return (int64_t)st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+#endif
+}
+
+// a blob is only used after every offset in it was checked against its size
+static int blob_attach(chime_cache_t *cache, void *base, size_t size)
+{
+    const chime_cache_header_t *header = (const chime_cache_header_t *)base;
+    if (size < sizeof(*header) || header->magic != CHIME_CACHE_MAGIC || header->version != CHIME_CACHE_VERSION ||
+        header->header_size != sizeof(*header)) {
+        return -1;
+    }
+    size_t entries_size = (size_t)header->count * sizeof(chime_cache_entry_t);
+    size_t index_size = (size_t)header->id_span * sizeof(uint32_t);
+    if (size != sizeof(*header) + entries_size + index_size + header->strings_size || header->strings_size == 0 ||
+        header->id_span > CHIME_CACHE_MAX_SPAN) {
+        return -1;
+    }
+    if (blob_checksum(base, size) != header->checksum) {
+        return -1;
+    }
+    const chime_cache_entry_t *entries = (const chime_cache_entry_t *)(header + 1);
+    const uint32_t *index = (const uint32_t *)(entries + header->count);
+    const char *strings = (const char *)(index + header->id_span);
+    if (strings[header->strings_size - 1] != '\0') {
+        return -1;
+    }
+    for (uint32_t i = 0; i < header->count; i++) {
+        if (entries[i].dir >= header->strings_size || entries[i].file_name >= header->strings_size ||
+            (entries[i].path >= header->strings_size && entries[i].path != CHIME_CACHE_NO_PATH) ||
+            (i > 0 && entries[i].id <= entries[i - 1].id)) {
+            return -1;
+        }
+    }
+    for (uint32_t i = 0; i < header->id_span; i++) {
+        if (index[i] >= header->strings_size && index[i] != CHIME_CACHE_NO_PATH) {
+            return -1;
+        }
+    }
+    cache->header = header;
+    cache->entries = entries;
+    cache->index = index;
+    cache->strings = strings;
+    cache->count = (int)header->count;
+    cache->min_id = header->min_id;
+    cache->id_span = header->id_span;
+    cache->base = base;
+    cache->size = size;
+    return 0;
+}
+
+static int map_cache(chime_cache_t *cache, const char *cache_path)
+{
+    struct stat st;
+    int fd = open(cache_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(chime_cache_header_t)) {
+        close(fd);
+        return -1;
+    }
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+    if (blob_attach(cache, base, st.st_size) != 0) {
+        LOGW("chime cache: %s is damaged or from another version, rebuilding", cache_path);
+        munmap(base, st.st_size);
+        return -1;
+    }
+    cache->mapped = 1;
+    return 0;
+}
+
+static int read_file(const char *path, char **text, size_t *len)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("can't open config file:[%s]", path);
+        return -1;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    *text = (char *)malloc(st.st_size + 1);
+    size_t got = 0;
+    while (*text && got < (size_t)st.st_size) {
+        ssize_t n = read(fd, *text + got, st.st_size - got);
+        if (n <= 0) {
+            break;
+        }
+        got += n;
+    }
+    close(fd);
+    if (*text == NULL || got != (size_t)st.st_size) {
+        LOGE("read config file:[%s] failed", path);
+        free(*text);
+        *text = NULL;
+        return -1;
+    }
+    (*text)[got] = '\0';
+    *len = got;
+    return 0;
+}
+
+static int entry_compare(const void *a, const void *b)
+{
+    const chime_entry_t *x = *(const chime_entry_t *const *)a;
+    const chime_entry_t *y = *(const chime_entry_t *const *)b;
+    if (x->id != y->id) {
+        return x->id < y->id ? -1 : 1;
+    }
+    return x < y ? -1 : x > y; // keep document order between duplicates
+}
+
+// string pool of the blob, equal strings are stored once
+typedef struct string_pool {
+    char *strings;
+    uint32_t used;
+    uint32_t *slots; // offset + 1 of the string in each slot, 0 for empty
+    uint32_t mask;
+} string_pool_t;
+
+static uint32_t intern(string_pool_t *pool, const char *a, const char *b)
+{
+    size_t len_a = strlen(a), len_b = strlen(b);
+    char joined[1024];
+    snprintf(joined, sizeof(joined), "%s%s", a, b);
+    size_t len = len_a + len_b < sizeof(joined) ? len_a + len_b : sizeof(joined) - 1;
+    uint64_t hash = fnv1a(FNV_OFFSET, joined, len);
+    uint32_t slot = (uint32_t)(hash ^ (hash >> 32)) & pool->mask; // the word wise low bits mix poorly
+    while (pool->slots[slot]) {
+        const char *s = pool->strings + pool->slots[slot] - 1;
+        if (strcmp(s, joined) == 0) {
+            return pool->slots[slot] - 1;
+        }
+        slot = (slot + 1) & pool->mask;
+    }
+    uint32_t offset = pool->used;
+    memcpy(pool->strings + offset, joined, len + 1);
+    pool->used += (uint32_t)len + 1;
+    pool->slots[slot] = offset + 1;
+    return offset;
+}
+
+// sorted, deduplicated copy of the parsed mapping in the file layout
+static void *build_blob(const chime_mapping_t *map, const struct stat *xml_st, uint64_t xml_hash, size_t *size)
+{
+    const chime_entry_t **sorted = (const chime_entry_t **)malloc((map->count + 1) * sizeof(*sorted));
+    if (sorted == NULL) {
+        return NULL;
+    }
+    size_t strings_max = 1;
+    for (int i = 0; i < map->count; i++) {
+        sorted[i] = &map->entries[i];
+        strings_max += (strlen(map->entries[i].dir) + strlen(map->entries[i].file_name) + 1) * 2 + 1;
+    }
+    qsort(sorted, map->count, sizeof(*sorted), entry_compare);
+    int count = 0;
+    for (int i = 0; i < map->count; i++) {
+        if (count == 0 || sorted[count - 1]->id != sorted[i]->id) {
+            sorted[count++] = sorted[i];
+        }
+    }
+    // ids are small positions, a sparse or hostile numbering only falls back to the binary search
+    int64_t span = count ? (int64_t)sorted[count - 1]->id - sorted[0]->id + 1 : 0;
+    if (span > CHIME_CACHE_MAX_SPAN) {
+        span = 0;
+    }
+
+    string_pool_t pool = {NULL, 0, NULL, 0};
+    uint32_t slots = 64;
+    while (slots < (uint32_t)count * 4) {
+        slots *= 2;
+    }
+    size_t max_size = sizeof(chime_cache_header_t) + count * sizeof(chime_cache_entry_t) + span * sizeof(uint32_t) +
+                      strings_max;
+    char *blob = (char *)calloc(1, max_size);
+    pool.slots = (uint32_t *)calloc(slots, sizeof(uint32_t));
+    pool.mask = slots - 1;
+    if (blob == NULL || pool.slots == NULL || strings_max > UINT32_MAX) {
+        free(blob);
+        free(pool.slots);
+        free((void *)sorted);
+        return NULL;
+    }
+    chime_cache_header_t *header = (chime_cache_header_t *)blob;
+    chime_cache_entry_t *entries = (chime_cache_entry_t *)(header + 1);
+    uint32_t *index = (uint32_t *)(entries + count);
+    pool.strings = (char *)(index + span);
+    intern(&pool, "", ""); // offset 0 is the empty string
+    for (int64_t i = 0; i < span; i++) {
+        index[i] = CHIME_CACHE_NO_PATH;
+    }
+    for (int i = 0; i < count; i++) {
+        entries[i].id = sorted[i]->id;
+        entries[i].dir = intern(&pool, sorted[i]->dir, "");
+        entries[i].file_name = intern(&pool, sorted[i]->file_name, "");
+        // a pos without a file name has nothing to play, like the old empty string check
+        entries[i].path = sorted[i]->file_name[0] ? intern(&pool, sorted[i]->dir, sorted[i]->file_name)
+                                                  : CHIME_CACHE_NO_PATH;
+        if (span) {
+            index[sorted[i]->id - sorted[0]->id] = entries[i].path;
+        }
+    }
+    free(pool.slots);
+
+    header->magic = CHIME_CACHE_MAGIC;
+    header->version = CHIME_CACHE_VERSION;
+    header->header_size = sizeof(*header);
+    header->xml_size = (uint64_t)xml_st->st_size;
+    header->xml_mtime_ns = mtime_ns(xml_st);
+    header->xml_hash = xml_hash;
+    header->mapping_version = map->version;
+    header->count = (uint32_t)count;
+    header->strings_size = pool.used;
+    header->min_id = count ? sorted[0]->id : 0;
+    header->id_span = (uint32_t)span;
+    free((void *)sorted);
+    *size = sizeof(*header) + count * sizeof(chime_cache_entry_t) + span * sizeof(uint32_t) + pool.used;
+    header->checksum = blob_checksum(blob, *size);
+    return blob;
+}
+
+static int write_cache(const char *cache_path, const void *blob, size_t size)
+{
+    char tmp_path[600];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", cache_path, (int)getpid());
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    size_t off = 0;
+    while (off < size) {
+        ssize_t n = write(fd, (const char *)blob + off, size - off);
+        if (n <= 0) {
+            break;
+        }
+        off += n;
+    }
+    if (close(fd) != 0 || off != size || rename(tmp_path, cache_path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int chime_cache_open(chime_cache_t *cache, const char *xml_file_path, const char *cache_path)
+{
+    char default_path[512];
+    struct stat xml_st;
+    memset(cache, 0, sizeof(*cache));
+    if (cache_path == NULL) {
+        snprintf(default_path, sizeof(default_path), "%s%s", xml_file_path, CHIME_CACHE_SUFFIX);
+        cache_path = default_path;
+    }
+    if (stat(xml_file_path, &xml_st) != 0) {
+        LOGE("can't access config file:[%s]", xml_file_path);
+        return -1;
+    }
+
+    uint64_t stale_hash = 0;
+    int have_cache = map_cache(cache, cache_path) == 0;
+    if (have_cache) {
+        if (cache->header->xml_size == (uint64_t)xml_st.st_size && cache->header->xml_mtime_ns == mtime_ns(&xml_st)) {
+            return 0;
+        }
+        stale_hash = cache->header->xml_hash;
+    }
+
+    char *text = NULL;
+    size_t len = 0;
+    if (read_file(xml_file_path, &text, &len) != 0) {
+        chime_cache_close(cache);
+        return -1;
+    }
+    uint64_t xml_hash = fnv1a(FNV_OFFSET, text, len);
+    chime_mapping_t map;
+    memset(&map, 0, sizeof(map));
+    if (have_cache && xml_hash == stale_hash) {
+        // same contents under a new stamp, the entries are reused as they are
+        map.version = cache->header->mapping_version;
+        map.count = cache->count;
+        map.entries = (chime_entry_t *)malloc((cache->count + 1) * sizeof(chime_entry_t));
+        for (int i = 0; map.entries && i < cache->count; i++) {
+            map.entries[i].id = cache->entries[i].id;
+            map.entries[i].dir = chime_cache_str(cache, cache->entries[i].dir);
+            map.entries[i].file_name = chime_cache_str(cache, cache->entries[i].file_name);
+        }
+        if (map.entries == NULL) {
+            map.count = 0;
+        }
+    }
+    if (map.entries == NULL && chime_xml_parse(&map, text, len) != 0) {
+        LOGE("parse config file:[%s] failed", xml_file_path);
+        chime_xml_free(&map);
+        free(text);
+        chime_cache_close(cache);
+        return -1;
+    }
+
+    size_t size = 0;
+    void *blob = build_blob(&map, &xml_st, xml_hash, &size);
+    chime_xml_free(&map);
+    free(text);
+    chime_cache_close(cache);
+    if (blob == NULL) {
+        LOGE("chime cache: out of memory");
+        return -1;
+    }
+    if (write_cache(cache_path, blob, size) != 0) {
+        LOGW("chime cache: can't write %s, using the parsed mapping from memory", cache_path);
+    } else if (map_cache(cache, cache_path) == 0) {
+        free(blob);
+        return 0;
+    }
+    blob_attach(cache, blob, size);
+    cache->mapped = 0;
+    return 0;
+}
+
+int chime_cache_load(chime_cache_t *cache, const char *xml_file_path)
+{
+    struct stat xml_st;
+    memset(cache, 0, sizeof(*cache));
+    if (stat(xml_file_path, &xml_st) != 0) {
+        LOGE("can't access config file:[%s]", xml_file_path);
+        return -1;
+    }
+    char *text = NULL;
+    size_t len = 0;
+    if (read_file(xml_file_path, &text, &len) != 0) {
+        return -1;
+    }
+    chime_mapping_t map;
+    memset(&map, 0, sizeof(map));
+    if (chime_xml_parse(&map, text, len) != 0) {
+        LOGE("parse config file:[%s] failed", xml_file_path);
+        chime_xml_free(&map);
+        free(text);
+        return -1;
+    }
+    size_t size = 0;
+    void *blob = build_blob(&map, &xml_st, fnv1a(FNV_OFFSET, text, len), &size);
+    chime_xml_free(&map);
+    free(text);
+    if (blob == NULL) {
+        LOGE("chime cache: out of memory");
+        return -1;
+    }
+    blob_attach(cache, blob, size);
+    cache->mapped = 0;
+    return 0;
+}
+
+const chime_cache_entry_t *chime_cache_find(const chime_cache_t *cache, int32_t id)
+{
+    int lo = 0, hi = cache->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (cache->entries[mid].id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < cache->count && cache->entries[lo].id == id ? &cache->entries[lo] : NULL;
+}
+
+void chime_cache_close(chime_cache_t *cache)
+{
+    if (cache->base) {
+        if (cache->mapped) {
+            munmap(cache->base, cache->size);
+        } else {
+            free(cache->base);
+        }
+    }
+    memset(cache, 0, sizeof(*cache));
+}
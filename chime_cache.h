@@ -0,0 +1,111 @@
+/***************************************************************************
+ * Description: precompiled binary cache of the chime3D.xml mapping
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 18:10:44
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _CHIME_CACHE_H
+#define _CHIME_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIME_CACHE_SUFFIX ".cache" // default cache file is the XML path plus this
+#define CHIME_CACHE_MAGIC 0x434d4843 // "CHMC"
+#define CHIME_CACHE_VERSION 2        // roll up whenever the layout below changes
+#define CHIME_CACHE_MAX_SPAN 65536   // ids spread wider than this go without the direct index
+#define CHIME_CACHE_NO_PATH 0xffffffffu
+
+/* Layout of the cache file, native byte order: the header, count entries
+ * sorted by id, id_span path offsets indexed by id - min_id, then
+ * strings_size bytes of NUL terminated strings that the entries and the
+ * index point into by offset. checksum is FNV-1a 64, taken a 64 bit word
+ * at a time, over every byte after the checksum field itself. */
+typedef struct chime_cache_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint64_t checksum;
+    uint64_t xml_size;     // the XML the cache was built from
+    int64_t xml_mtime_ns;
+    uint64_t xml_hash;     // same hash of the XML contents
+    int32_t mapping_version;
+    uint32_t count;
+    uint32_t strings_size;
+    int32_t min_id;
+    uint32_t id_span;      // 0 when the ids are too sparse for the index
+    uint32_t reserved;
+} chime_cache_header_t;
+
+typedef struct chime_cache_entry {
+    int32_t id;
+    uint32_t dir;          // offset of the Chime3DMapping filePath
+    uint32_t file_name;    // offset of the fileName
+    uint32_t path;         // offset of filePath + fileName, CHIME_CACHE_NO_PATH without a fileName
+} chime_cache_entry_t;
+
+typedef struct chime_cache {
+    const chime_cache_header_t *header;
+    const chime_cache_entry_t *entries;
+    const uint32_t *index;
+    const char *strings;
+    int count;
+    int32_t min_id;
+    uint32_t id_span;
+    void *base;
+    size_t size;
+    int mapped;            // 0 when the blob lives in memory because the cache could not be written
+} chime_cache_t;
+
+/* Maps the cache of xml_file_path, cache_path NULL for the file next to it.
+ * The cache is used as is when the XML still has the size and mtime it was
+ * built from. Otherwise the XML is hashed, a matching hash only refreshes
+ * the stamp, anything else parses the XML and writes a new cache. When the
+ * cache cannot be written the freshly built blob is used from memory.
+ * Returns 0 or -1. */
+int chime_cache_open(chime_cache_t *cache, const char *xml_file_path, const char *cache_path);
+
+/* Parses xml_file_path into the same layout in memory, no cache file is
+ * read or written. Returns 0 or -1. */
+int chime_cache_load(chime_cache_t *cache, const char *xml_file_path);
+
+// binary search, the first pos with this id in the XML wins like in chime_xml_find
+const chime_cache_entry_t *chime_cache_find(const chime_cache_t *cache, int32_t id);
+
+static inline const char *chime_cache_str(const chime_cache_t *cache, uint32_t offset)
+{
+    return cache->strings + offset;
+}
+
+/* Full path of the file for a position id, NULL when the id is unknown or
+ * has no file name. No allocation, no lock and no search when the ids fit
+ * the index, safe to call from the audio thread. The string lives as long
+ * as the cache stays open. */
+static inline const char *chime_cache_path(const chime_cache_t *cache, int32_t id)
+{
+    uint32_t offset = CHIME_CACHE_NO_PATH;
+    if (cache->id_span) {
+        int64_t slot = (int64_t)id - cache->min_id;
+        if (slot >= 0 && slot < (int64_t)cache->id_span) {
+            offset = cache->index[slot];
+        }
+    } else {
+        const chime_cache_entry_t *entry = chime_cache_find(cache, id);
+        offset = entry ? entry->path : CHIME_CACHE_NO_PATH;
+    }
+    return offset == CHIME_CACHE_NO_PATH ? NULL : cache->strings + offset;
+}
+
+void chime_cache_close(chime_cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CHIME_CACHE_H
@@ -8,67 +8,9 @@
 #ifndef __H_PARSER__
 #define __H_PARSER__
 
+#include "chime_3dc.h"
 #include <stdint.h>
 
-#pragma pack(1)
-typedef struct _ObjectPos {
-    int8_t id;
-    float x;
-    float y;
-    float z;
-} ObjectPos;
-#pragma pack()
-
-#pragma pack(1)
-typedef struct _TimedPos {
-    int16_t time;
-    float x;
-    float y;
-    float z;
-} TimedPos;
-#pragma pack()
-
-#pragma pack(1)
-typedef struct _AutomationPoints {
-    int16_t count;
-    TimedPos points[1];
-} AutomationPoints;
-#pragma pack()
-
-#pragma pack(push, 1)
-typedef struct _AACCfgFileHeader {
-    char formatId[6];
-    uint16_t version; // roll up when data struct is significantly changed
-} AACCfgFileHeader;
-#pragma pack(pop)
-
-#pragma pack(push, 1)
-typedef struct _AACCfgChunkHeader {
-    uint16_t chunkType;
-    uint32_t chunkDataSize;
-} AACCfgChunkHeader;
-#pragma pack(pop)
-
-#pragma pack(push, 1)
-typedef struct _SoundField {
-    uint16_t sourceId;
-    int16_t positionId;
-    uint8_t isLoop;
-    uint16_t loopInterval;
-    uint8_t algorithmMode;
-    ObjectPos listenerPos;
-    ObjectPos audioSourcePos;
-    uint8_t automationEnabled;
-} SoundField;
-#pragma pack(pop)
-
-typedef enum {
-    CHUNK_SPEAKER_POS = 1,
-    CHUNK_SOUND_FIELD,
-    CHUNK_AUDIO_AUTOMATION
-} ChunkType_t,
-    *ChunkType_ptr;
-
 typedef struct {
     int id;
     char fileName[64];
@@ -0,0 +1,224 @@
+/***************************************************************************
+ * Description: uniformly partitioned FFT convolution for spatial chime rendering
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 21:48:25
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * Uniformly partitioned overlap-save. The impulse response is cut into
+ * partitions of one block, each zero padded to two blocks and transformed
+ * once. Every block the last two blocks of input are transformed, the
+ * spectrum goes into a ring of the most recent input spectra, and the
+ * output spectrum is the sum over partitions of each IR partition times
+ * the input spectrum that many blocks old. One inverse transform gives two
+ * blocks of output, the second of which is free of circular wrap and is
+ * the result.
+ *
+ * Spectra are kept as split real and imaginary arrays rather than FFTW's
+ * interleaved pairs. The multiply-add over partitions then is plain loops
+ * over float arrays that the compiler vectorizes at -O3, the interleaving
+ * happens once per block on the way in and out of the FFT.
+ *
+ * Non-uniform partitioning, small partitions at the head of a long IR and
+ * large ones in its tail, would lower the cost of room responses of
+ * seconds. The HRTF and cabin responses of chimes are a few thousand
+ * samples, so it is left out.
+ */
+
+#include "chime_conv.h"
+#include "log.h"
+#include <string.h>
+
+#if defined(__GNUC__)
+#define RESTRICT __restrict__
+#else
+#define RESTRICT
+#endif
+
+#define STRIDE_FLOATS 16 // 64 bytes
+
+int chime_conv_engine_init(chime_conv_engine_t *engine, int block)
+{
+    memset(engine, 0, sizeof(*engine));
+    if (block <= 0 || block > (1 << 20)) {
+        LOGE("chime conv: block of %d samples not supported", block);
+        return -1;
+    }
+    engine->block = block;
+    engine->fft_size = 2 * block;
+    engine->bins = block + 1;
+    engine->stride = (engine->bins + STRIDE_FLOATS - 1) / STRIDE_FLOATS * STRIDE_FLOATS;
+
+    engine->forward = fft_plan_cache_get(engine->fft_size, FFT_R2C, 0);
+    engine->inverse = fft_plan_cache_get(engine->fft_size, FFT_C2R, 0);
+    if (engine->forward == NULL || engine->inverse == NULL) {
+        LOGE("chime conv: no %d point FFT", engine->fft_size);
+        chime_conv_engine_free(engine);
+        return -1;
+    }
+    return 0;
+}
+
+void chime_conv_engine_free(chime_conv_engine_t *engine)
+{
+    // the plans stay in the cache for the next engine of this size
+    memset(engine, 0, sizeof(*engine));
+}
+
+static void split(const fftwf_complex *RESTRICT spectrum, float *RESTRICT re, float *RESTRICT im, int bins)
+{
+    for (int i = 0; i < bins; i++) {
+        re[i] = spectrum[i][0];
+        im[i] = spectrum[i][1];
+    }
+}
+
+static void join(fftwf_complex *RESTRICT spectrum, const float *RESTRICT re, const float *RESTRICT im, int bins)
+{
+    for (int i = 0; i < bins; i++) {
+        spectrum[i][0] = re[i];
+        spectrum[i][1] = im[i];
+    }
+}
+
+int chime_conv_ir_init(const chime_conv_engine_t *engine, chime_conv_ir_t *ir, const float *samples, int length)
+{
+    memset(ir, 0, sizeof(*ir));
+    if (length <= 0) {
+        LOGE("chime conv: empty impulse response");
+        return -1;
+    }
+    int block = engine->block;
+    ir->partitions = (length + block - 1) / block;
+    size_t size = (size_t)ir->partitions * engine->stride;
+    ir->re = fftwf_alloc_real(size);
+    ir->im = fftwf_alloc_real(size);
+    float *time = fftwf_alloc_real(engine->fft_size);
+    fftwf_complex *spectrum = fftwf_alloc_complex(engine->bins);
+    if (ir->re == NULL || ir->im == NULL || time == NULL || spectrum == NULL) {
+        LOGE("chime conv: out of memory for %d partitions", ir->partitions);
+        fftwf_free(time);
+        fftwf_free(spectrum);
+        chime_conv_ir_free(ir);
+        return -1;
+    }
+    memset(ir->re, 0, size * sizeof(float));
+    memset(ir->im, 0, size * sizeof(float));
+    float scale = 1.0f / engine->fft_size;
+    for (int k = 0; k < ir->partitions; k++) {
+        int count = length - k * block < block ? length - k * block : block;
+        memset(time, 0, engine->fft_size * sizeof(float));
+        for (int i = 0; i < count; i++) {
+            time[i] = samples[k * block + i] * scale;
+        }
+        fftwf_execute_dft_r2c(engine->forward->plan, time, spectrum);
+        split(spectrum, ir->re + (size_t)k * engine->stride, ir->im + (size_t)k * engine->stride, engine->bins);
+    }
+    fftwf_free(time);
+    fftwf_free(spectrum);
+    return 0;
+}
+
+void chime_conv_ir_free(chime_conv_ir_t *ir)
+{
+    fftwf_free(ir->re);
+    fftwf_free(ir->im);
+    memset(ir, 0, sizeof(*ir));
+}
+
+int chime_conv_source_init(const chime_conv_engine_t *engine, chime_conv_source_t *source, int max_partitions)
+{
+    memset(source, 0, sizeof(*source));
+    if (max_partitions <= 0) {
+        LOGE("chime conv: a source needs at least one partition");
+        return -1;
+    }
+    size_t fdl = (size_t)max_partitions * engine->stride;
+    source->partitions = max_partitions;
+    source->fdl_re = fftwf_alloc_real(fdl);
+    source->fdl_im = fftwf_alloc_real(fdl);
+    source->acc_re = fftwf_alloc_real(engine->stride);
+    source->acc_im = fftwf_alloc_real(engine->stride);
+    source->input = fftwf_alloc_real(engine->fft_size);
+    source->output = fftwf_alloc_real(engine->fft_size);
+    source->spectrum = fftwf_alloc_complex(engine->bins);
+    if (!source->fdl_re || !source->fdl_im || !source->acc_re || !source->acc_im || !source->input ||
+        !source->output || !source->spectrum) {
+        LOGE("chime conv: out of memory for %d partitions", max_partitions);
+        chime_conv_source_free(source);
+        return -1;
+    }
+    chime_conv_source_reset(engine, source);
+    return 0;
+}
+
+void chime_conv_source_reset(const chime_conv_engine_t *engine, chime_conv_source_t *source)
+{
+    size_t fdl = (size_t)source->partitions * engine->stride;
+    memset(source->fdl_re, 0, fdl * sizeof(float));
+    memset(source->fdl_im, 0, fdl * sizeof(float));
+    memset(source->input, 0, engine->fft_size * sizeof(float));
+    source->head = 0;
+}
+
+void chime_conv_source_free(chime_conv_source_t *source)
+{
+    fftwf_free(source->fdl_re);
+    fftwf_free(source->fdl_im);
+    fftwf_free(source->acc_re);
+    fftwf_free(source->acc_im);
+    fftwf_free(source->input);
+    fftwf_free(source->output);
+    fftwf_free(source->spectrum);
+    memset(source, 0, sizeof(*source));
+}
+
+static void complex_mul(float *RESTRICT acc_re, float *RESTRICT acc_im, const float *RESTRICT x_re,
+                        const float *RESTRICT x_im, const float *RESTRICT h_re, const float *RESTRICT h_im, int count)
+{
+    for (int i = 0; i < count; i++) {
+        acc_re[i] = x_re[i] * h_re[i] - x_im[i] * h_im[i];
+        acc_im[i] = x_re[i] * h_im[i] + x_im[i] * h_re[i];
+    }
+}
+
+static void complex_mac(float *RESTRICT acc_re, float *RESTRICT acc_im, const float *RESTRICT x_re,
+                        const float *RESTRICT x_im, const float *RESTRICT h_re, const float *RESTRICT h_im, int count)
+{
+    for (int i = 0; i < count; i++) {
+        acc_re[i] += x_re[i] * h_re[i] - x_im[i] * h_im[i];
+        acc_im[i] += x_re[i] * h_im[i] + x_im[i] * h_re[i];
+    }
+}
+
+void chime_conv_process(const chime_conv_engine_t *engine, chime_conv_source_t *source, const chime_conv_ir_t *ir,
+                        const float *in, float *out)
+{
+    int block = engine->block;
+    int stride = engine->stride;
+    memcpy(source->input + block, in, block * sizeof(float));
+    fftwf_execute_dft_r2c(engine->forward->plan, source->input, source->spectrum);
+    memcpy(source->input, source->input + block, block * sizeof(float));
+
+    size_t head = (size_t)source->head * stride;
+    split(source->spectrum, source->fdl_re + head, source->fdl_im + head, engine->bins);
+    int partitions = ir->partitions < source->partitions ? ir->partitions : source->partitions;
+    int slot = source->head;
+    for (int k = 0; k < partitions; k++) {
+        const float *x_re = source->fdl_re + (size_t)slot * stride, *x_im = source->fdl_im + (size_t)slot * stride;
+        const float *h_re = ir->re + (size_t)k * stride, *h_im = ir->im + (size_t)k * stride;
+        if (k == 0) {
+            complex_mul(source->acc_re, source->acc_im, x_re, x_im, h_re, h_im, stride);
+        } else {
+            complex_mac(source->acc_re, source->acc_im, x_re, x_im, h_re, h_im, stride);
+        }
+        slot = slot == 0 ? source->partitions - 1 : slot - 1;
+    }
+    source->head = source->head + 1 == source->partitions ? 0 : source->head + 1;
+
+    join(source->spectrum, source->acc_re, source->acc_im, engine->bins);
+    fftwf_execute_dft_c2r(engine->inverse->plan, source->spectrum, source->output);
+    memcpy(out, source->output + block, block * sizeof(float));
+}
@@ -0,0 +1,79 @@
+/***************************************************************************
+ * Description: uniformly partitioned FFT convolution for spatial chime rendering
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 21:48:25
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _CHIME_CONV_H
+#define _CHIME_CONV_H
+
+#include "fft_plan_cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Block size and FFT plans, shared by every impulse response and source
+ * that runs at this block size. The plans belong to fft_plan_cache and are
+ * only ever executed on new arrays, which FFTW allows from any thread. */
+typedef struct chime_conv_engine {
+    int block;
+    int fft_size;          // 2 * block
+    int bins;              // block + 1
+    int stride;            // bins rounded up to a whole number of cache lines
+    const fft_cached_plan_t *forward;
+    const fft_cached_plan_t *inverse;
+} chime_conv_engine_t;
+
+/* Spectra of the impulse response cut into block long partitions, real
+ * and imaginary parts in separate arrays, scaled by 1 / fft_size so the
+ * inverse FFT needs no extra pass. Read only once built, any number of
+ * sources may use one at the same time. */
+typedef struct chime_conv_ir {
+    int partitions;
+    float *re;             // partitions * stride
+    float *im;
+} chime_conv_ir_t;
+
+/* Per source state: the last block of input, the frequency domain delay
+ * line of input spectra and the scratch buffers of one block. */
+typedef struct chime_conv_source {
+    int partitions;        // length of the delay line, the longest IR it can run
+    int head;              // slot of the newest spectrum
+    float *fdl_re;
+    float *fdl_im;
+    float *acc_re;
+    float *acc_im;
+    float *input;          // fft_size samples, the previous block then the current one
+    float *output;         // fft_size samples out of the inverse FFT
+    fftwf_complex *spectrum;
+} chime_conv_source_t;
+
+/* Takes the plans from fft_plan_cache, measured on the first use of a
+ * block size unless wisdom for it was loaded. Returns 0 or -1. */
+int chime_conv_engine_init(chime_conv_engine_t *engine, int block);
+void chime_conv_engine_free(chime_conv_engine_t *engine);
+
+int chime_conv_ir_init(const chime_conv_engine_t *engine, chime_conv_ir_t *ir, const float *samples, int length);
+void chime_conv_ir_free(chime_conv_ir_t *ir);
+
+int chime_conv_source_init(const chime_conv_engine_t *engine, chime_conv_source_t *source, int max_partitions);
+void chime_conv_source_reset(const chime_conv_engine_t *engine, chime_conv_source_t *source);
+void chime_conv_source_free(chime_conv_source_t *source);
+
+/* Convolves one block of a source with ir into out, both engine->block
+ * samples. The output block belongs to the same input block, so latency is
+ * the block itself. The IR may change from one block to the next, its
+ * partitions beyond the source's delay line are ignored. Cost is two FFTs
+ * plus one multiply-add of bins complex values per partition. No allocation
+ * and no lock, sources can be run from different threads. */
+void chime_conv_process(const chime_conv_engine_t *engine, chime_conv_source_t *source, const chime_conv_ir_t *ir,
+                        const float *in, float *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CHIME_CONV_H
@@ -0,0 +1,156 @@
+/* **************************************************************
+ * @Description: cost of chime_conv against impulse response length and source count
+ * @Date: 2026-10-19 22:10:52
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+// gcc -O3 -march=native chime_conv_bench.c chime_conv.c fft_plan_cache.c log.c -lfftw3f -lm -lpthread -o chime_conv_bench
+// ./chime_conv_bench [block] [sources]
+// FFT_WISDOM=conv.wisdom ./chime_conv_bench keeps the measured plans between runs
+// Every source convolves with one of two impulse responses, the way
+// sources in one cabin share the responses of a few speaker positions.
+
+#include "chime_conv.h"
+#include "log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_BLOCK 256
+#define DEFAULT_SOURCES 16
+#define SAMPLE_RATE 48000
+#define RUN_SECONDS 0.5
+#define SHARED_IRS 2
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static float noise(unsigned *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (float)((*state >> 8) / 16777216.0 * 2.0 - 1.0);
+}
+
+// a decaying noise tail, like a small room
+static void make_ir(float *ir, int length, unsigned seed)
+{
+    for (int i = 0; i < length; i++) {
+        ir[i] = noise(&seed) * expf(-6.9f * i / length);
+    }
+}
+
+// against the direct sum, blocks of random input through a short IR
+static double check(const chime_conv_engine_t *engine)
+{
+    const int length = 3 * engine->block + 17, blocks = 12;
+    int total = blocks * engine->block;
+    float *ir = (float *)malloc(length * sizeof(float));
+    float *in = (float *)malloc(total * sizeof(float));
+    float *out = (float *)malloc(total * sizeof(float));
+    unsigned seed = 7;
+    make_ir(ir, length, 3);
+    for (int i = 0; i < total; i++) {
+        in[i] = noise(&seed);
+    }
+    chime_conv_ir_t response;
+    chime_conv_source_t source;
+    chime_conv_ir_init(engine, &response, ir, length);
+    chime_conv_source_init(engine, &source, response.partitions);
+    for (int b = 0; b < blocks; b++) {
+        chime_conv_process(engine, &source, &response, in + b * engine->block, out + b * engine->block);
+    }
+    double worst = 0;
+    for (int n = 0; n < total; n++) {
+        double sum = 0;
+        for (int k = 0; k < length && k <= n; k++) {
+            sum += (double)ir[k] * in[n - k];
+        }
+        worst = fmax(worst, fabs(sum - out[n]));
+    }
+    chime_conv_source_free(&source);
+    chime_conv_ir_free(&response);
+    free(ir);
+    free(in);
+    free(out);
+    return worst;
+}
+
+int main(int argc, char *argv[])
+{
+    int block = argc > 1 ? atoi(argv[1]) : DEFAULT_BLOCK;
+    int sources = argc > 2 ? atoi(argv[2]) : DEFAULT_SOURCES;
+    if (block <= 0 || sources <= 0) {
+        printf("Usage: %s [block] [sources]\n", argv[0]);
+        return -1;
+    }
+    chime_conv_engine_t engine;
+    fft_plan_cache_init(NULL);
+    double start = now_seconds();
+    if (chime_conv_engine_init(&engine, block) != 0) {
+        return -1;
+    }
+    printf("block %d, fft %d, planned in %.1f ms\n", block, engine.fft_size, (now_seconds() - start) * 1e3);
+    double error = check(&engine);
+    printf("largest difference to direct convolution %.2e\n", error);
+    if (error > 1e-4) {
+        printf("convolution is wrong\n");
+        return -1;
+    }
+
+    const int lengths[] = {1024, 4096, 16384, 65536};
+    float *in = (float *)malloc(block * sizeof(float));
+    float *out = (float *)malloc(block * sizeof(float));
+    unsigned seed = 1;
+    for (int i = 0; i < block; i++) {
+        in[i] = noise(&seed);
+    }
+    printf("%d sources sharing %d impulse responses\n", sources, SHARED_IRS);
+    printf("%10s %11s %14s %18s %16s\n", "ir length", "partitions", "us per block", "ns per partition", "load 48 kHz");
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        chime_conv_ir_t irs[SHARED_IRS];
+        float *samples = (float *)malloc(lengths[l] * sizeof(float));
+        for (int i = 0; i < SHARED_IRS; i++) {
+            make_ir(samples, lengths[l], 11 + i);
+            chime_conv_ir_init(&engine, &irs[i], samples, lengths[l]);
+        }
+        free(samples);
+        chime_conv_source_t *state = (chime_conv_source_t *)calloc(sources, sizeof(*state));
+        for (int s = 0; s < sources; s++) {
+            chime_conv_source_init(&engine, &state[s], irs[0].partitions);
+        }
+        long blocks = 0;
+        double elapsed;
+        start = now_seconds();
+        do {
+            for (int b = 0; b < 16; b++) {
+                for (int s = 0; s < sources; s++) {
+                    chime_conv_process(&engine, &state[s], &irs[s % SHARED_IRS], in, out);
+                }
+            }
+            blocks += 16;
+            elapsed = now_seconds() - start;
+        } while (elapsed < RUN_SECONDS);
+        double per_block = elapsed / blocks;
+        printf("%10d %11d %14.1f %18.1f %15.2f%%\n", lengths[l], irs[0].partitions, per_block * 1e6,
+               per_block * 1e9 / sources / irs[0].partitions, 100.0 * per_block * SAMPLE_RATE / block);
+        for (int s = 0; s < sources; s++) {
+            chime_conv_source_free(&state[s]);
+        }
+        free(state);
+        for (int i = 0; i < SHARED_IRS; i++) {
+            chime_conv_ir_free(&irs[i]);
+        }
+    }
+    free(in);
+    free(out);
+    chime_conv_engine_free(&engine);
+    fft_plan_cache_cleanup();
+    return 0;
+}
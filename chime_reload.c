@@ -0,0 +1,347 @@
+/***************************************************************************
+ * Description: hot reload of chime3D.xml with lock free readers
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 18:46:15
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * The current mapping is an immutable chime_cache_t behind one atomic
+ * pointer. A reload builds a complete new snapshot off to the side and
+ * swaps the pointer, so a reader sees either the old mapping or the new
+ * one, never a mix.
+ *
+ * Freeing the old snapshot is the part that needs care. Every reading
+ * thread owns a slot from a fixed pool, like the rings of log_async.c, and
+ * writes the global epoch into it when it enters a read section and 0
+ * when it leaves. After a swap the watcher bumps the epoch and parks the
+ * old snapshot with the new epoch. Readers that entered later loaded the
+ * pointer after the swap, so once no slot holds a smaller non-zero epoch
+ * nobody can be looking at the old snapshot any more and it is freed.
+ * Readers never wait, only the watcher thread polls the slots.
+ *
+ * The watcher follows the directory rather than the file, because editors
+ * and package updates usually replace the file with a rename. Events only
+ * arm a timer, the file is parsed once it has been quiet for
+ * CHIME_RELOAD_SETTLE_MS, so a file is not read while it is being written.
+ */
+
+#include "chime_reload.h"
+#include "log.h"
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+#define MAX_RETIRED 8
+#define RECLAIM_POLL_MS 10
+
+typedef struct reader_slot {
+    uint64_t epoch; // epoch when the section was entered, 0 outside of one
+    uint32_t in_use;
+    char pad[52];   // one cache line per reader
+} reader_slot_t;
+
+typedef struct retired_snapshot {
+    chime_cache_t *snapshot;
+    uint64_t epoch; // readers that entered at this epoch or later never saw it
+} retired_snapshot_t;
+
+static reader_slot_t readers[CHIME_RELOAD_MAX_READERS];
+static chime_cache_t *current;
+static uint64_t global_epoch = 1;
+static uint64_t generation;
+
+static __thread reader_slot_t *tls_reader;
+static __thread int tls_depth;
+static __thread const chime_cache_t *tls_snapshot; // pinned by the outermost section
+static pthread_key_t reader_key;
+static pthread_once_t reader_key_once = PTHREAD_ONCE_INIT;
+
+static retired_snapshot_t retired[MAX_RETIRED];
+static int retired_count;
+static pthread_mutex_t reload_lock = PTHREAD_MUTEX_INITIALIZER; // start, stop and the watcher, never readers
+static pthread_t watch_thread;
+static int watch_running;
+static int stop_pipe[2] = {-1, -1};
+static char xml_path[512];
+static int load_flags;
+
+static void reader_release(void *arg)
+{
+    reader_slot_t *slot = (reader_slot_t *)arg;
+    __atomic_store_n(&slot->epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&slot->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void reader_key_create(void)
+{
+    pthread_key_create(&reader_key, reader_release);
+}
+
+static reader_slot_t *reader_claim(void)
+{
+    pthread_once(&reader_key_once, reader_key_create);
+    for (int i = 0; i < CHIME_RELOAD_MAX_READERS; i++) {
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&readers[i].in_use, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            pthread_setspecific(reader_key, &readers[i]);
+            return &readers[i];
+        }
+    }
+    return NULL;
+}
+
+const chime_cache_t *chime_reload_enter(void)
+{
+    reader_slot_t *slot = tls_reader;
+    if (__builtin_expect(slot == NULL, 0)) {
+        slot = tls_reader = reader_claim();
+        if (slot == NULL) {
+            return NULL;
+        }
+    }
+    if (tls_depth++ == 0) {
+        // announce the epoch before the pointer is read, the watcher orders the other way round
+        __atomic_store_n(&slot->epoch, __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+        tls_snapshot = __atomic_load_n(&current, __ATOMIC_SEQ_CST);
+    }
+    return tls_snapshot;
+}
+
+void chime_reload_exit(void)
+{
+    reader_slot_t *slot = tls_reader;
+    if (slot && tls_depth > 0 && --tls_depth == 0) {
+        tls_snapshot = NULL;
+        __atomic_store_n(&slot->epoch, 0, __ATOMIC_RELEASE);
+    }
+}
+
+int chime_reload_depth(void)
+{
+    return tls_depth;
+}
+
+const chime_cache_t *chime_reload_current(void)
+{
+    return tls_depth > 0 ? tls_snapshot : NULL;
+}
+
+uint64_t chime_reload_generation(void)
+{
+    return __atomic_load_n(&generation, __ATOMIC_RELAXED);
+}
+
+// whether a reader that entered before this epoch is still inside its section
+static int readers_before(uint64_t epoch)
+{
+    for (int i = 0; i < CHIME_RELOAD_MAX_READERS; i++) {
+        uint64_t seen = __atomic_load_n(&readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (seen != 0 && seen < epoch) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void free_snapshot(chime_cache_t *snapshot)
+{
+    chime_cache_close(snapshot);
+    free(snapshot);
+}
+
+// returns how many snapshots still wait for their readers
+static int reclaim(void)
+{
+    int kept = 0;
+    for (int i = 0; i < retired_count; i++) {
+        if (readers_before(retired[i].epoch)) {
+            retired[kept++] = retired[i];
+        } else {
+            free_snapshot(retired[i].snapshot);
+        }
+    }
+    retired_count = kept;
+    return kept;
+}
+
+static void publish(chime_cache_t *snapshot)
+{
+    chime_cache_t *old = __atomic_exchange_n(&current, snapshot, __ATOMIC_SEQ_CST);
+    uint64_t epoch = __atomic_add_fetch(&global_epoch, 1, __ATOMIC_SEQ_CST);
+    if (snapshot) {
+        __atomic_add_fetch(&generation, 1, __ATOMIC_RELAXED);
+    }
+    if (old == NULL) {
+        return;
+    }
+    while (retired_count == MAX_RETIRED && reclaim() == MAX_RETIRED) {
+        // a reader sits in a section across several reloads, this thread can afford to wait
+        usleep(RECLAIM_POLL_MS * 1000);
+    }
+    retired[retired_count].snapshot = old;
+    retired[retired_count].epoch = epoch;
+    retired_count++;
+    reclaim();
+}
+
+static chime_cache_t *load_snapshot(void)
+{
+    chime_cache_t *snapshot = (chime_cache_t *)calloc(1, sizeof(*snapshot));
+    if (snapshot == NULL) {
+        LOGE("chime reload: out of memory");
+        return NULL;
+    }
+    int ret = (load_flags & CHIME_RELOAD_CACHE) ? chime_cache_open(snapshot, xml_path, NULL)
+                                                : chime_cache_load(snapshot, xml_path);
+    if (ret != 0) {
+        free(snapshot);
+        return NULL;
+    }
+    return snapshot;
+}
+
+#if defined(__linux__)
+static long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+static void *watch_main(void *arg)
+{
+    (void)arg;
+    char dir[512] = ".";
+    const char *base = strrchr(xml_path, '/');
+    if (base) {
+        snprintf(dir, sizeof(dir), "%.*s", base == xml_path ? 1 : (int)(base - xml_path), xml_path);
+        base++;
+    } else {
+        base = xml_path;
+    }
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE) < 0) {
+        LOGE("chime reload: can't watch %s: %s", dir, strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    long changed_at = -1;
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        int timeout = -1;
+        if (changed_at >= 0) {
+            timeout = (int)(changed_at + CHIME_RELOAD_SETTLE_MS - now_ms());
+            timeout = timeout < 0 ? 0 : timeout;
+        } else if (retired_count) {
+            timeout = RECLAIM_POLL_MS;
+        }
+        struct pollfd fds[2] = {{fd, POLLIN, 0}, {stop_pipe[0], POLLIN, 0}};
+        if (poll(fds, 2, timeout) < 0 && errno != EINTR) {
+            LOGE("chime reload: poll failed: %s", strerror(errno));
+            break;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            ssize_t len;
+            while ((len = read(fd, events, sizeof(events))) > 0) {
+                for (char *p = events; p < events + len;) {
+                    const struct inotify_event *event = (const struct inotify_event *)p;
+                    // the cache and its temporary files live in the same directory
+                    if (event->len && strcmp(event->name, base) == 0) {
+                        changed_at = now_ms();
+                    }
+                    p += sizeof(*event) + event->len;
+                }
+            }
+        }
+        if (changed_at >= 0 && now_ms() - changed_at >= CHIME_RELOAD_SETTLE_MS) {
+            changed_at = -1;
+            chime_cache_t *snapshot = load_snapshot();
+            pthread_mutex_lock(&reload_lock);
+            if (snapshot) {
+                publish(snapshot);
+                LOGI("chime reload: %s generation %llu, %d positions", xml_path,
+                     (unsigned long long)chime_reload_generation(), snapshot->count);
+            } else {
+                LOGE("chime reload: %s did not load, keeping generation %llu", xml_path,
+                     (unsigned long long)chime_reload_generation());
+            }
+            pthread_mutex_unlock(&reload_lock);
+        }
+        pthread_mutex_lock(&reload_lock);
+        reclaim();
+        pthread_mutex_unlock(&reload_lock);
+    }
+    close(fd);
+    return NULL;
+}
+#endif
+
+int chime_reload_start(const char *xml_file_path, int flags)
+{
+    chime_reload_stop();
+    pthread_mutex_lock(&reload_lock);
+    snprintf(xml_path, sizeof(xml_path), "%s", xml_file_path);
+    load_flags = flags;
+    chime_cache_t *snapshot = load_snapshot();
+    if (snapshot == NULL) {
+        pthread_mutex_unlock(&reload_lock);
+        return -1;
+    }
+    publish(snapshot);
+#if defined(__linux__)
+    if (!(flags & CHIME_RELOAD_WATCH)) {
+        // loaded once, nothing to watch
+    } else if (pipe(stop_pipe) != 0) {
+        LOGE("chime reload: pipe failed: %s, %s is not watched", strerror(errno), xml_path);
+    } else if (pthread_create(&watch_thread, NULL, watch_main, NULL) != 0) {
+        LOGE("chime reload: can't start the watcher, %s is not watched", xml_path);
+        close(stop_pipe[0]);
+        close(stop_pipe[1]);
+        stop_pipe[0] = stop_pipe[1] = -1;
+    } else {
+        watch_running = 1;
+    }
+#endif
+    pthread_mutex_unlock(&reload_lock);
+    return 0;
+}
+
+void chime_reload_stop(void)
+{
+    pthread_mutex_lock(&reload_lock);
+    int running = watch_running;
+    watch_running = 0;
+    if (running && write(stop_pipe[1], "x", 1) != 1) {
+        LOGE("chime reload: can't signal the watcher: %s", strerror(errno));
+    }
+    pthread_mutex_unlock(&reload_lock);
+    if (running) {
+        pthread_join(watch_thread, NULL);
+        close(stop_pipe[0]);
+        close(stop_pipe[1]);
+        stop_pipe[0] = stop_pipe[1] = -1;
+    }
+
+    pthread_mutex_lock(&reload_lock);
+    publish(NULL);
+    while (reclaim()) {
+        usleep(RECLAIM_POLL_MS * 1000);
+    }
+    pthread_mutex_unlock(&reload_lock);
+}
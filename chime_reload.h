@@ -0,0 +1,59 @@
+/***************************************************************************
+ * Description: hot reload of chime3D.xml with lock free readers
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 18:46:15
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _CHIME_RELOAD_H
+#define _CHIME_RELOAD_H
+
+#include "chime_cache.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIME_RELOAD_MAX_READERS 64 // threads that can be inside a read section at once
+#define CHIME_RELOAD_SETTLE_MS 100  // quiet time after the last change before the file is parsed
+
+#define CHIME_RELOAD_WATCH 0x1 // reload on every change from a watcher thread
+#define CHIME_RELOAD_CACHE 0x2 // go through the chime_cache file next to the XML, written when stale
+
+/* Loads xml_file_path and publishes it as the current snapshot. Without
+ * flags the XML is parsed in memory once, no thread is started and no
+ * file written. With CHIME_RELOAD_WATCH a thread watches the file with
+ * inotify, every change is parsed on that thread into a new snapshot that
+ * replaces the current one atomically, and a broken file keeps the
+ * previous snapshot. Returns 0, or -1 when the first load failed. */
+int chime_reload_start(const char *xml_file_path, int flags);
+
+// stops the watcher and frees every snapshot, no reader may be left
+void chime_reload_stop(void);
+
+/* Read section. The snapshot returned by chime_reload_enter, and every
+ * string taken from it, stays valid until the matching chime_reload_exit
+ * on the same thread. Both are a few atomic operations on a slot owned by
+ * the calling thread, no lock and no allocation after the first call of a
+ * thread, so they can run on the audio thread. Sections may nest, the
+ * inner ones return the snapshot of the outermost one, so everything read
+ * in one section comes from the same version of the file. Returns
+ * NULL when nothing is loaded or all reader slots are taken. */
+const chime_cache_t *chime_reload_enter(void);
+void chime_reload_exit(void);
+
+// nesting depth of the calling thread's read section, 0 outside of one
+int chime_reload_depth(void);
+// snapshot of the calling thread's open section, NULL outside of one
+const chime_cache_t *chime_reload_current(void);
+
+// bumped by every snapshot that gets published
+uint64_t chime_reload_generation(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CHIME_RELOAD_H
@@ -0,0 +1,467 @@
+/***************************************************************************
+ * Description: VBAP panning of chime sources over the speaker layout of a preset
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 20:54:08
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * Vector base amplitude panning: the direction of a source is written as a
+ * positive combination of the directions of the three speakers around it,
+ * the weights normalized to unit power are the gains. Everything that only
+ * depends on the layout is done once in chime_vbap_init. The speaker
+ * directions are triangulated along their convex hull, triangles that
+ * contain another speaker are dropped, and each triangle's 3x3 matrix is
+ * inverted, so a source costs three small matrix products per candidate
+ * triangle. Car layouts often have every speaker at ear height, then the
+ * hull is flat and the same is done in the horizontal plane with pairs of
+ * neighbouring speakers.
+ *
+ * Positions use the axes of the .3dc files: x to the side, y up, z to the
+ * front. Only the direction from the listener matters here, distance is
+ * left to whatever renders the source.
+ *
+ * Moving sources mostly revisit the same directions, so gains are cached on
+ * a CHIME_VBAP_GRID_DEG grid of azimuth and elevation. A cell is computed
+ * the first time a source points into it, after that an update is a normalize,
+ * two arc functions and a table load. The steps the grid introduces are
+ * hidden by the per sample gain ramp in chime_vbap_render.
+ */
+
+#include "chime_vbap.h"
+#include "log.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FLAT_ELEVATION_DEG 5.0 // a layout within this of the listener's ear plane is panned in 2D
+#define INSIDE_EPSILON 1e-4f
+
+static void normalize(float v[3])
+{
+    float length = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length < 1e-9f) {
+        v[0] = v[1] = 0.0f;
+        v[2] = 1.0f; // a source on the listener is heard from the front
+        return;
+    }
+    float scale = 1.0f / length;
+    v[0] *= scale;
+    v[1] *= scale;
+    v[2] *= scale;
+}
+
+// inverse of the matrix with the three directions as columns, -1 when they are (nearly) coplanar with the listener
+static int invert3(const float *a, const float *b, const float *c, float inverse[9])
+{
+    double m[3][3] = {{a[0], b[0], c[0]}, {a[1], b[1], c[1]}, {a[2], b[2], c[2]}};
+    double cof[3][3];
+    for (int r = 0; r < 3; r++) {
+        for (int col = 0; col < 3; col++) {
+            int r1 = (r + 1) % 3, r2 = (r + 2) % 3, c1 = (col + 1) % 3, c2 = (col + 2) % 3;
+            cof[r][col] = m[r1][c1] * m[r2][c2] - m[r1][c2] * m[r2][c1];
+        }
+    }
+    double det = m[0][0] * cof[0][0] + m[0][1] * cof[0][1] + m[0][2] * cof[0][2];
+    if (fabs(det) < 1e-3) {
+        return -1;
+    }
+    for (int r = 0; r < 3; r++) {
+        for (int col = 0; col < 3; col++) {
+            inverse[r * 3 + col] = (float)(cof[col][r] / det);
+        }
+    }
+    return 0;
+}
+
+static int invert2(const float *a, const float *b, float inverse[9])
+{
+    // directions in the x z plane, x in [0] and z in [2]
+    double det = (double)a[0] * b[2] - (double)b[0] * a[2];
+    if (fabs(det) < 1e-3) {
+        return -1;
+    }
+    memset(inverse, 0, 9 * sizeof(float));
+    inverse[0] = (float)(b[2] / det);
+    inverse[2] = (float)(-b[0] / det);
+    inverse[3] = (float)(-a[2] / det);
+    inverse[5] = (float)(a[0] / det);
+    return 0;
+}
+
+// group weights for a direction, in 2D the y row of inverse is zero
+static void group_weights(const float inverse[9], const float d[3], float g[3])
+{
+    g[0] = inverse[0] * d[0] + inverse[1] * d[1] + inverse[2] * d[2];
+    g[1] = inverse[3] * d[0] + inverse[4] * d[1] + inverse[5] * d[2];
+    g[2] = inverse[6] * d[0] + inverse[7] * d[1] + inverse[8] * d[2];
+}
+
+static int add_group(chime_vbap_t *vbap, int capacity, int a, int b, int c)
+{
+    if (vbap->group_count == capacity) {
+        return -1;
+    }
+    float *inverse = vbap->inverse[vbap->group_count];
+    int ret = vbap->dims == 3 ? invert3(vbap->directions[a], vbap->directions[b], vbap->directions[c], inverse)
+                              : invert2(vbap->directions[a], vbap->directions[b], inverse);
+    if (ret != 0) {
+        return 0;
+    }
+    // a group with another speaker inside it would overlap the groups of that speaker
+    for (int m = 0; m < vbap->speaker_count; m++) {
+        float g[3];
+        if (m == a || m == b || m == c) {
+            continue;
+        }
+        group_weights(inverse, vbap->directions[m], g);
+        if (g[0] >= -INSIDE_EPSILON && g[1] >= -INSIDE_EPSILON && (vbap->dims == 2 || g[2] >= -INSIDE_EPSILON)) {
+            return 0;
+        }
+    }
+    vbap->groups[vbap->group_count][0] = (uint8_t)a;
+    vbap->groups[vbap->group_count][1] = (uint8_t)b;
+    vbap->groups[vbap->group_count][2] = (uint8_t)c;
+    vbap->group_count++;
+    return 0;
+}
+
+static void triangulate(chime_vbap_t *vbap, int capacity)
+{
+    int n = vbap->speaker_count;
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            for (int k = j + 1; k < n; k++) {
+                const float *a = vbap->directions[i], *b = vbap->directions[j], *c = vbap->directions[k];
+                float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+                float normal[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                                   e1[0] * e2[1] - e1[1] * e2[0]};
+                int above = 0, below = 0;
+                for (int m = 0; m < n; m++) {
+                    const float *p = vbap->directions[m];
+                    float side = normal[0] * (p[0] - a[0]) + normal[1] * (p[1] - a[1]) + normal[2] * (p[2] - a[2]);
+                    above += side > 1e-5f;
+                    below += side < -1e-5f;
+                }
+                if (above == 0 || below == 0) { // a face of the hull
+                    add_group(vbap, capacity, i, j, k);
+                }
+            }
+        }
+    }
+}
+
+static float arc(const float *a, const float *b)
+{
+    return acosf(fmaxf(-1.0f, fminf(1.0f, a[0] * b[0] + a[1] * b[1] + a[2] * b[2])));
+}
+
+// whether the great circle arcs a-b and c-d cross, arcs sharing an end do not
+static int arcs_cross(const float *a, const float *b, const float *c, const float *d)
+{
+    if (a == c || a == d || b == c || b == d) {
+        return 0;
+    }
+    float n1[3] = {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+    float n2[3] = {c[1] * d[2] - c[2] * d[1], c[2] * d[0] - c[0] * d[2], c[0] * d[1] - c[1] * d[0]};
+    float p[3] = {n1[1] * n2[2] - n1[2] * n2[1], n1[2] * n2[0] - n1[0] * n2[2], n1[0] * n2[1] - n1[1] * n2[0]};
+    normalize(p);
+    for (int sign = 0; sign < 2; sign++) {
+        if (fabsf(arc(a, p) + arc(p, b) - arc(a, b)) < 1e-3f && fabsf(arc(c, p) + arc(p, d) - arc(c, d)) < 1e-3f) {
+            return 1;
+        }
+        p[0] = -p[0];
+        p[1] = -p[1];
+        p[2] = -p[2];
+    }
+    return 0;
+}
+
+static int triangles_cross(const chime_vbap_t *vbap, const uint8_t *t, const uint8_t *u)
+{
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (arcs_cross(vbap->directions[t[i]], vbap->directions[t[(i + 1) % 3]], vbap->directions[u[j]],
+                           vbap->directions[u[(j + 1) % 3]])) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int perimeter_compare(const void *a, const void *b)
+{
+    float x = ((const float *)a)[0], y = ((const float *)b)[0];
+    return x < y ? -1 : x > y;
+}
+
+/* Four or more speakers on one face of the hull, like a ring of ceiling
+ * speakers at the same height, can be triangulated more than one way and
+ * every way passed the checks above. Overlapping triangles would make the
+ * gains jump where one takes over from the other, so only the shortest
+ * triangles that do not cross one already kept survive. */
+static void drop_crossing(chime_vbap_t *vbap)
+{
+    int n = vbap->group_count;
+    float (*order)[2] = (float(*)[2])malloc(n * sizeof(*order));
+    uint8_t(*groups)[3] = (uint8_t(*)[3])malloc(n * sizeof(*groups));
+    float(*inverse)[9] = (float(*)[9])malloc(n * sizeof(*inverse));
+    if (!order || !groups || !inverse) {
+        LOGW("chime vbap: out of memory, overlapping triangles are kept");
+        free(order);
+        free(groups);
+        free(inverse);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        const uint8_t *t = vbap->groups[i];
+        order[i][0] = arc(vbap->directions[t[0]], vbap->directions[t[1]]) +
+                      arc(vbap->directions[t[1]], vbap->directions[t[2]]) +
+                      arc(vbap->directions[t[2]], vbap->directions[t[0]]);
+        order[i][1] = (float)i;
+    }
+    qsort(order, n, sizeof(order[0]), perimeter_compare);
+    int kept = 0;
+    for (int i = 0; i < n; i++) {
+        int candidate = (int)order[i][1];
+        int crossing = 0;
+        for (int k = 0; k < kept && !crossing; k++) {
+            crossing = triangles_cross(vbap, vbap->groups[candidate], groups[k]);
+        }
+        if (!crossing) {
+            memcpy(groups[kept], vbap->groups[candidate], sizeof(groups[0]));
+            memcpy(inverse[kept], vbap->inverse[candidate], sizeof(inverse[0]));
+            kept++;
+        }
+    }
+    memcpy(vbap->groups, groups, kept * sizeof(groups[0]));
+    memcpy(vbap->inverse, inverse, kept * sizeof(inverse[0]));
+    vbap->group_count = kept;
+    free(order);
+    free(groups);
+    free(inverse);
+}
+
+static int azimuth_compare(const void *a, const void *b)
+{
+    float x = ((const float *)a)[0], y = ((const float *)b)[0];
+    return x < y ? -1 : x > y;
+}
+
+static void pair_up(chime_vbap_t *vbap, int capacity)
+{
+    float order[CHIME_VBAP_MAX_SPEAKERS][2];
+    int n = vbap->speaker_count;
+    for (int i = 0; i < n; i++) {
+        order[i][0] = atan2f(vbap->directions[i][0], vbap->directions[i][2]);
+        order[i][1] = (float)i;
+    }
+    qsort(order, n, sizeof(order[0]), azimuth_compare);
+    for (int i = 0; i < n && n > 1; i++) {
+        int a = (int)order[i][1], b = (int)order[(i + 1) % n][1];
+        if (n == 2 && i == 1) {
+            break;
+        }
+        add_group(vbap, capacity, a, b, b);
+    }
+}
+
+int chime_vbap_init(chime_vbap_t *vbap, const ObjectPos *speakers, int speaker_count, const ObjectPos *listener,
+                    int max_sources)
+{
+    memset(vbap, 0, sizeof(*vbap));
+    if (speaker_count <= 0 || speaker_count > CHIME_VBAP_MAX_SPEAKERS || max_sources <= 0) {
+        LOGE("chime vbap: %d speakers, %d sources not supported", speaker_count, max_sources);
+        return -1;
+    }
+    vbap->speaker_count = speaker_count;
+    vbap->listener[0] = listener ? listener->x : 0.0f;
+    vbap->listener[1] = listener ? listener->y : 0.0f;
+    vbap->listener[2] = listener ? listener->z : 0.0f;
+    double max_elevation = 0;
+    for (int i = 0; i < speaker_count; i++) {
+        float *d = vbap->directions[i];
+        d[0] = speakers[i].x - vbap->listener[0];
+        d[1] = speakers[i].y - vbap->listener[1];
+        d[2] = speakers[i].z - vbap->listener[2];
+        normalize(d);
+        max_elevation = fmax(max_elevation, fabs(asin(d[1])) * 180 / M_PI);
+    }
+    vbap->dims = max_elevation < FLAT_ELEVATION_DEG ? 2 : 3;
+    if (vbap->dims == 2) {
+        for (int i = 0; i < speaker_count; i++) {
+            vbap->directions[i][1] = 0.0f;
+            normalize(vbap->directions[i]);
+        }
+    }
+
+    // a triangulated sphere has 2n - 4 faces, coplanar speakers can add candidates that get dropped
+    int capacity = vbap->dims == 3 ? speaker_count * speaker_count * 2 : speaker_count;
+    int azimuth_cells = 360 / CHIME_VBAP_GRID_DEG;
+    int elevation_cells = 180 / CHIME_VBAP_GRID_DEG + 1;
+    vbap->groups = (uint8_t(*)[3])calloc(capacity, sizeof(*vbap->groups));
+    vbap->inverse = (float(*)[9])calloc(capacity, sizeof(*vbap->inverse));
+    vbap->cells = (chime_vbap_cell_t *)calloc((size_t)azimuth_cells * elevation_cells, sizeof(chime_vbap_cell_t));
+    vbap->current = (float *)calloc((size_t)max_sources * CHIME_VBAP_MAX_SPEAKERS, sizeof(float));
+    vbap->target = (float *)calloc((size_t)max_sources * CHIME_VBAP_MAX_SPEAKERS, sizeof(float));
+    if (!vbap->groups || !vbap->inverse || !vbap->cells || !vbap->current || !vbap->target) {
+        LOGE("chime vbap: out of memory");
+        chime_vbap_free(vbap);
+        return -1;
+    }
+    vbap->azimuth_cells = azimuth_cells;
+    vbap->elevation_cells = elevation_cells;
+    vbap->max_sources = max_sources;
+    if (vbap->dims == 3) {
+        triangulate(vbap, capacity);
+        drop_crossing(vbap);
+    } else {
+        pair_up(vbap, capacity);
+    }
+    if (vbap->group_count == 0 && speaker_count > 1) {
+        LOGW("chime vbap: no usable speaker group in %d speakers, panning to the nearest one", speaker_count);
+    }
+    LOGI("chime vbap: %d speakers, %dD, %d %s", speaker_count, vbap->dims, vbap->group_count,
+         vbap->dims == 3 ? "triangles" : "pairs");
+    return 0;
+}
+
+void chime_vbap_free(chime_vbap_t *vbap)
+{
+    free(vbap->groups);
+    free(vbap->inverse);
+    free(vbap->cells);
+    free(vbap->current);
+    free(vbap->target);
+    memset(vbap, 0, sizeof(*vbap));
+}
+
+// gains for a unit direction
+static int pan(const chime_vbap_t *vbap, const float direction[3], uint8_t speakers[3], float gains[3])
+{
+    float d[3] = {direction[0], direction[1], direction[2]};
+    int members = vbap->dims == 3 ? 3 : 2;
+    if (vbap->dims == 2) {
+        d[1] = 0.0f;
+        normalize(d);
+    }
+    int best = -1;
+    float best_min = -INFINITY, best_g[3] = {0};
+    for (int i = 0; i < vbap->group_count; i++) {
+        float g[3];
+        group_weights(vbap->inverse[i], d, g);
+        float lowest = fminf(g[0], g[1]);
+        lowest = members == 3 ? fminf(lowest, g[2]) : lowest;
+        if (lowest > best_min) {
+            best_min = lowest;
+            best = i;
+            memcpy(best_g, g, sizeof(best_g));
+            if (lowest >= -INSIDE_EPSILON) {
+                break;
+            }
+        }
+    }
+    if (best < 0) {
+        // a single speaker, or nothing could be triangulated: the closest speaker takes it all
+        int nearest = 0;
+        float closest = -2.0f;
+        for (int i = 0; i < vbap->speaker_count; i++) {
+            const float *s = vbap->directions[i];
+            float dot = s[0] * d[0] + s[1] * d[1] + s[2] * d[2];
+            if (dot > closest) {
+                closest = dot;
+                nearest = i;
+            }
+        }
+        speakers[0] = (uint8_t)nearest;
+        gains[0] = 1.0f;
+        return 1;
+    }
+    // outside every group, for example below a layout without low speakers: clip to the nearest edge
+    float power = 0.0f;
+    for (int i = 0; i < members; i++) {
+        best_g[i] = best_g[i] > 0.0f ? best_g[i] : 0.0f;
+        power += best_g[i] * best_g[i];
+    }
+    float scale = power > 0.0f ? 1.0f / sqrtf(power) : 0.0f;
+    for (int i = 0; i < members; i++) {
+        speakers[i] = vbap->groups[best][i];
+        gains[i] = best_g[i] * scale;
+    }
+    return members;
+}
+
+int chime_vbap_gains(const chime_vbap_t *vbap, float x, float y, float z, uint8_t speakers[3], float gains[3])
+{
+    float d[3] = {x - vbap->listener[0], y - vbap->listener[1], z - vbap->listener[2]};
+    normalize(d);
+    return pan(vbap, d, speakers, gains);
+}
+
+static const chime_vbap_cell_t *cell_for(chime_vbap_t *vbap, const float d[3])
+{
+    const float step = (float)(M_PI / 180.0 * CHIME_VBAP_GRID_DEG);
+    float azimuth = atan2f(d[0], d[2]) + (float)M_PI;
+    float elevation = asinf(fmaxf(-1.0f, fminf(1.0f, d[1]))) + (float)(M_PI / 2);
+    int a = (int)(azimuth / step + 0.5f);
+    int e = (int)(elevation / step + 0.5f);
+    a = a >= vbap->azimuth_cells ? a - vbap->azimuth_cells : a;
+    e = e >= vbap->elevation_cells ? vbap->elevation_cells - 1 : e;
+    chime_vbap_cell_t *cell = &vbap->cells[e * vbap->azimuth_cells + a];
+    if (__builtin_expect(cell->filled, 1)) {
+        vbap->hits++;
+        return cell;
+    }
+    // gains of the cell centre, so a cell does not depend on which source filled it
+    float center_azimuth = a * step - (float)M_PI, center_elevation = e * step - (float)(M_PI / 2);
+    float center[3] = {cosf(center_elevation) * sinf(center_azimuth), sinf(center_elevation),
+                       cosf(center_elevation) * cosf(center_azimuth)};
+    int count = pan(vbap, center, cell->speakers, cell->gains);
+    for (int i = count; i < 3; i++) {
+        cell->speakers[i] = cell->speakers[0];
+        cell->gains[i] = 0.0f;
+    }
+    cell->filled = 1;
+    vbap->misses++;
+    return cell;
+}
+
+void chime_vbap_update(chime_vbap_t *vbap, int count, const float *x, const float *y, const float *z)
+{
+    count = count < vbap->max_sources ? count : vbap->max_sources;
+    for (int s = 0; s < count; s++) {
+        float d[3] = {x[s] - vbap->listener[0], y[s] - vbap->listener[1], z[s] - vbap->listener[2]};
+        normalize(d);
+        const chime_vbap_cell_t *cell = cell_for(vbap, d);
+        float *row = vbap->target + (size_t)s * CHIME_VBAP_MAX_SPEAKERS;
+        memset(row, 0, vbap->speaker_count * sizeof(float));
+        // a pair repeats its last speaker with a zero gain, so accumulate rather than assign
+        row[cell->speakers[0]] += cell->gains[0];
+        row[cell->speakers[1]] += cell->gains[1];
+        row[cell->speakers[2]] += cell->gains[2];
+    }
+}
+
+void chime_vbap_render(chime_vbap_t *vbap, int source, const float *in, float *const *out, int frames)
+{
+    if (source < 0 || source >= vbap->max_sources || frames <= 0) {
+        return;
+    }
+    float *current = vbap->current + (size_t)source * CHIME_VBAP_MAX_SPEAKERS;
+    const float *target = vbap->target + (size_t)source * CHIME_VBAP_MAX_SPEAKERS;
+    for (int s = 0; s < vbap->speaker_count; s++) {
+        float gain = current[s];
+        float step = (target[s] - gain) / frames;
+        if (gain == 0.0f && step == 0.0f) {
+            continue;
+        }
+        float *output = out[s];
+        for (int n = 0; n < frames; n++) {
+            output[n] += in[n] * (gain + step * n);
+        }
+        current[s] = target[s];
+    }
+}
@@ -0,0 +1,75 @@
+/***************************************************************************
+ * Description: VBAP panning of chime sources over the speaker layout of a preset
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 20:54:08
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _CHIME_VBAP_H
+#define _CHIME_VBAP_H
+
+#include "Chime3dCommon.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIME_VBAP_MAX_SPEAKERS 32
+#define CHIME_VBAP_GRID_DEG 2 // angular step of the gain cache
+
+/* Gains of one cell of the cache, at most three speakers are ever active */
+typedef struct chime_vbap_cell {
+    float gains[3];
+    uint8_t speakers[3];
+    uint8_t filled;
+} chime_vbap_cell_t;
+
+typedef struct chime_vbap {
+    int speaker_count;
+    int dims;              // 3 with a triangulated layout, 2 when every speaker is level with the listener
+    float listener[3];
+    float directions[CHIME_VBAP_MAX_SPEAKERS][3];
+
+    int group_count;       // triangles in 3 dims, neighbouring pairs in 2
+    uint8_t (*groups)[3];
+    float (*inverse)[9];   // row major inverse of each group's direction matrix
+
+    chime_vbap_cell_t *cells;
+    int azimuth_cells;
+    int elevation_cells;
+    uint64_t hits;
+    uint64_t misses;
+
+    int max_sources;
+    float *current;        // max_sources rows of CHIME_VBAP_MAX_SPEAKERS gains, reached at the end of the last render
+    float *target;         // the same for the positions of the last update
+} chime_vbap_t;
+
+/* Triangulates the directions of the speakers as heard from the listener
+ * and inverts the matrix of every triangle, or of every neighbouring pair
+ * when the layout is flat. All memory is allocated here. Returns 0 or -1. */
+int chime_vbap_init(chime_vbap_t *vbap, const ObjectPos *speakers, int speaker_count, const ObjectPos *listener,
+                    int max_sources);
+void chime_vbap_free(chime_vbap_t *vbap);
+
+/* Exact gains for a point, power normalized, up to three speakers. Returns
+ * how many were set. */
+int chime_vbap_gains(const chime_vbap_t *vbap, float x, float y, float z, uint8_t speakers[3], float gains[3]);
+
+/* New targets for sources 0 to count - 1 from their positions, for example
+ * the x, y and z arrays of chime_automation. Gains come from the direction
+ * cache, a cell is computed the first time a source points into it. No
+ * allocation, no lock. */
+void chime_vbap_update(chime_vbap_t *vbap, int count, const float *x, const float *y, const float *z);
+
+/* Adds a mono block of a source to every speaker output, ramping each gain
+ * from where the previous block ended to the target of the last update. */
+void chime_vbap_render(chime_vbap_t *vbap, int source, const float *in, float *const *out, int frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CHIME_VBAP_H
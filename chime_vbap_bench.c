@@ -0,0 +1,181 @@
+/* **************************************************************
+ * @Description: cost of chime_vbap gain updates for many moving sources
+ * @Date: 2026-10-19 21:16:40
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+// gcc -O3 -march=native chime_vbap_bench.c chime_vbap.c chime_3dc.c log.c -lm -lpthread -o chime_vbap_bench
+// ./chime_vbap_bench [sources] [preset.3dc]
+// Without a preset a 12 speaker car layout is used, the listener at the origin.
+
+#include "chime_3dc.h"
+#include "chime_vbap.h"
+#include "log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_SOURCES 64
+#define SAMPLE_RATE 48000
+#define PATH_BLOCKS 4096 // distinct positions per source, replayed for as long as the bench runs
+#define RUN_SECONDS 1.0
+
+static const ObjectPos car_layout[] = {
+    {0, -0.9f, 0.0f, 1.2f},  {1, 0.9f, 0.0f, 1.2f},   {2, 0.0f, 0.0f, 1.3f},   {3, -1.0f, 0.0f, 0.0f},
+    {4, 1.0f, 0.0f, 0.0f},   {5, -0.8f, 0.0f, -1.0f}, {6, 0.8f, 0.0f, -1.0f},  {7, -0.7f, 0.6f, 0.9f},
+    {8, 0.7f, 0.6f, 0.9f},   {9, -0.7f, 0.6f, -0.8f}, {10, 0.7f, 0.6f, -0.8f}, {11, 0.0f, -0.4f, 1.0f},
+};
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// a speaker direction must land on that speaker alone
+static int check_speakers(const chime_vbap_t *vbap, const ObjectPos *speakers)
+{
+    int failures = 0;
+    for (int i = 0; i < vbap->speaker_count; i++) {
+        uint8_t which[3];
+        float gains[3];
+        int count = chime_vbap_gains(vbap, speakers[i].x, speakers[i].y, speakers[i].z, which, gains);
+        float own = 0.0f;
+        for (int k = 0; k < count; k++) {
+            own += which[k] == i ? gains[k] : 0.0f;
+        }
+        if (vbap->dims == 3 && own < 0.999f) {
+            printf("  speaker %d only gets %.3f of its own direction\n", i, own);
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int main(int argc, char *argv[])
+{
+    int sources = argc > 1 ? atoi(argv[1]) : DEFAULT_SOURCES;
+    if (sources <= 0) {
+        printf("Usage: %s [sources] [preset.3dc]\n", argv[0]);
+        return -1;
+    }
+    const ObjectPos *speakers = car_layout;
+    int speaker_count = (int)(sizeof(car_layout) / sizeof(car_layout[0]));
+    const ObjectPos *listener = NULL;
+    chime_3dc_t preset;
+    if (argc > 2) {
+        if (chime_3dc_open(&preset, argv[2]) != 0) {
+            return -1;
+        }
+        speakers = preset.speakers;
+        speaker_count = preset.speaker_count;
+        listener = &preset.sound_field->listenerPos;
+    }
+
+    chime_vbap_t vbap;
+    double start = now_seconds();
+    if (chime_vbap_init(&vbap, speakers, speaker_count, listener, sources) != 0) {
+        return -1;
+    }
+    printf("%d speakers, %dD, %d groups, set up in %.3f ms\n", speaker_count, vbap.dims, vbap.group_count,
+           (now_seconds() - start) * 1e3);
+    int failures = check_speakers(&vbap, speakers);
+
+    // every source circles the listener at its own height, radius and speed
+    float *x = (float *)malloc((size_t)PATH_BLOCKS * sources * sizeof(float));
+    float *y = (float *)malloc((size_t)PATH_BLOCKS * sources * sizeof(float));
+    float *z = (float *)malloc((size_t)PATH_BLOCKS * sources * sizeof(float));
+    for (int b = 0; b < PATH_BLOCKS; b++) {
+        for (int s = 0; s < sources; s++) {
+            double angle = 2 * M_PI * b / PATH_BLOCKS * (1 + s % 5) + s;
+            double radius = 1.0 + 0.1 * (s % 7);
+            x[(size_t)b * sources + s] = (float)(radius * sin(angle));
+            y[(size_t)b * sources + s] = (float)(0.6 * sin(angle * 0.5 + s));
+            z[(size_t)b * sources + s] = (float)(radius * cos(angle));
+        }
+    }
+
+    // cached gains against exact ones
+    float worst = 0.0f;
+    for (int b = 0; b < PATH_BLOCKS; b += 7) {
+        chime_vbap_update(&vbap, sources, x + (size_t)b * sources, y + (size_t)b * sources, z + (size_t)b * sources);
+        for (int s = 0; s < sources; s++) {
+            float exact[CHIME_VBAP_MAX_SPEAKERS] = {0}, gains[3];
+            uint8_t which[3];
+            size_t i = (size_t)b * sources + s;
+            int count = chime_vbap_gains(&vbap, x[i], y[i], z[i], which, gains);
+            for (int k = 0; k < count; k++) {
+                exact[which[k]] += gains[k];
+            }
+            for (int k = 0; k < speaker_count; k++) {
+                worst = fmaxf(worst, fabsf(exact[k] - vbap.target[(size_t)s * CHIME_VBAP_MAX_SPEAKERS + k]));
+            }
+        }
+    }
+
+    vbap.hits = vbap.misses = 0;
+    long updates = 0;
+    start = now_seconds();
+    double elapsed;
+    do {
+        for (int b = 0; b < PATH_BLOCKS; b++) {
+            size_t i = (size_t)b * sources;
+            chime_vbap_update(&vbap, sources, x + i, y + i, z + i);
+        }
+        updates += PATH_BLOCKS;
+        elapsed = now_seconds() - start;
+    } while (elapsed < RUN_SECONDS);
+    double per_update = elapsed / updates;
+    printf("%d sources: %.1f ns per source update, cache hit rate %.2f%%, largest step from the grid %.3f\n", sources,
+           per_update * 1e9 / sources, 100.0 * vbap.hits / (vbap.hits + vbap.misses), worst);
+    printf("%-12s %22s\n", "block", "update load 48 kHz");
+    const int blocks[] = {64, 256, 1024};
+    for (size_t i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++) {
+        printf("%-12d %21.4f%%\n", blocks[i], 100.0 * per_update * SAMPLE_RATE / blocks[i]);
+    }
+
+    // mixing with the gain ramps, for scale
+    const int frames = 256;
+    float *in = (float *)calloc(frames, sizeof(float));
+    float *out_block = (float *)calloc((size_t)frames * speaker_count, sizeof(float));
+    float *out[CHIME_VBAP_MAX_SPEAKERS];
+    for (int i = 0; i < frames; i++) {
+        in[i] = (float)sin(i * 0.05);
+    }
+    for (int k = 0; k < speaker_count; k++) {
+        out[k] = out_block + (size_t)k * frames;
+    }
+    long renders = 0;
+    start = now_seconds();
+    do {
+        for (int b = 0; b < 256; b++) {
+            size_t i = (size_t)(b % PATH_BLOCKS) * sources;
+            chime_vbap_update(&vbap, sources, x + i, y + i, z + i);
+            for (int s = 0; s < sources; s++) {
+                chime_vbap_render(&vbap, s, in, out, frames);
+            }
+        }
+        renders += 256;
+        elapsed = now_seconds() - start;
+    } while (elapsed < RUN_SECONDS);
+    printf("update and render of %d sources into %d speakers, %d frames: %.4f%% of a core\n", sources, speaker_count,
+           frames, 100.0 * elapsed / renders * SAMPLE_RATE / frames);
+
+    free(in);
+    free(out_block);
+    free(x);
+    free(y);
+    free(z);
+    chime_vbap_free(&vbap);
+    if (argc > 2) {
+        chime_3dc_close(&preset);
+    }
+    if (failures) {
+        printf("%d speakers are not reproduced exactly\n", failures);
+    }
+    return failures ? -1 : 0;
+}
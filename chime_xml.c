@@ -0,0 +1,362 @@
+/***************************************************************************
+ * Description: single pass parser for the chime3D.xml position mapping
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 17:35:20
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * The mapping file is small and flat, so instead of a libxml2 DOM with an
+ * allocation per node and per xmlGetProp, one forward scan over the text
+ * picks up the three elements that matter:
+ *
+ *   <root version="2">
+ *       <Chime3DMapping filePath="/mnt/nio/etc/chime3d/">
+ *           <pos id="1" fileName="preset_line.3dc"/>
+ *
+ * Attribute values are cut out of the buffer in place, the closing quote
+ * becomes the terminator and entities are decoded over the value itself,
+ * which only ever shrinks. Declarations, comments, CDATA and text are
+ * skipped, elements other than these three are only counted for nesting.
+ * This is not a validating parser, it is strict about what it reads and
+ * rejects an unterminated tag, comment or value.
+ */
+
+#include "chime_xml.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct xml_scan {
+    char *pos;
+    char *end;
+    char *start;
+} xml_scan_t;
+
+static int is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static int is_name_char(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-' ||
+           c == '.' || c == ':' || (unsigned char)c >= 0x80;
+}
+
+static void skip_space(xml_scan_t *s)
+{
+    while (s->pos < s->end && is_space(*s->pos)) {
+        s->pos++;
+    }
+}
+
+// moves past the next occurrence of token, -1 when the document ends first
+static int skip_past(xml_scan_t *s, const char *token)
+{
+    size_t n = strlen(token);
+    while ((size_t)(s->end - s->pos) >= n) {
+        char *hit = (char *)memchr(s->pos, token[0], s->end - s->pos - n + 1);
+        if (hit == NULL) {
+            break;
+        }
+        if (memcmp(hit, token, n) == 0) {
+            s->pos = hit + n;
+            return 0;
+        }
+        s->pos = hit + 1;
+    }
+    s->pos = s->end;
+    return -1;
+}
+
+static int name_is(const char *name, size_t len, const char *expected)
+{
+    return strlen(expected) == len && memcmp(name, expected, len) == 0;
+}
+
+static char *put_utf8(char *out, unsigned long code)
+{
+    if (code < 0x80) {
+        *out++ = (char)code;
+    } else if (code < 0x800) {
+        *out++ = (char)(0xc0 | (code >> 6));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+        *out++ = (char)(0xe0 | (code >> 12));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    } else {
+        *out++ = (char)(0xf0 | (code >> 18));
+        *out++ = (char)(0x80 | ((code >> 12) & 0x3f));
+        *out++ = (char)(0x80 | ((code >> 6) & 0x3f));
+        *out++ = (char)(0x80 | (code & 0x3f));
+    }
+    return out;
+}
+
+// decodes the predefined and numeric entities of a terminated value in place
+static void unescape(char *value)
+{
+    char *in = strchr(value, '&');
+    char *out = in;
+    if (in == NULL) {
+        return;
+    }
+    while (*in) {
+        if (*in != '&') {
+            *out++ = *in++;
+            continue;
+        }
+        char *semi = strchr(in, ';');
+        size_t n = semi ? (size_t)(semi - in - 1) : 0;
+        if (semi && n >= 2 && in[1] == '#') {
+            char *digits_end = NULL;
+            unsigned long code = in[2] == 'x' ? strtoul(in + 3, &digits_end, 16) : strtoul(in + 2, &digits_end, 10);
+            if (digits_end == semi && code > 0 && code <= 0x10ffff) {
+                out = put_utf8(out, code); // never longer than the entity it replaces
+                in = semi + 1;
+                continue;
+            }
+        } else if (semi) {
+            static const struct {
+                const char *name;
+                char c;
+            } entities[] = {{"lt", '<'}, {"gt", '>'}, {"amp", '&'}, {"quot", '"'}, {"apos", '\''}};
+            size_t i;
+            for (i = 0; i < sizeof(entities) / sizeof(entities[0]); i++) {
+                if (name_is(in + 1, n, entities[i].name)) {
+                    break;
+                }
+            }
+            if (i < sizeof(entities) / sizeof(entities[0])) {
+                *out++ = entities[i].c;
+                in = semi + 1;
+                continue;
+            }
+        }
+        *out++ = *in++; // not an entity we know, keep it as written
+    }
+    *out = '\0';
+}
+
+static int add_entry(chime_mapping_t *map, int32_t id, const char *dir, const char *file_name)
+{
+    if (map->count == map->capacity) {
+        int capacity = map->capacity ? map->capacity * 2 : 16;
+        chime_entry_t *entries = (chime_entry_t *)realloc(map->entries, capacity * sizeof(*entries));
+        if (entries == NULL) {
+            LOGE("chime parser: out of memory for %d entries", capacity);
+            return -1;
+        }
+        map->entries = entries;
+        map->capacity = capacity;
+    }
+    chime_entry_t *entry = &map->entries[map->count++];
+    entry->id = id;
+    entry->dir = dir;
+    entry->file_name = file_name;
+    return 0;
+}
+
+int chime_xml_parse(chime_mapping_t *map, char *text, size_t len)
+{
+    xml_scan_t s = {text, text + len, text};
+    const char *dir = "";
+    int depth = 0;
+    int mapping_depth = -1; // depth of the children of the open Chime3DMapping
+
+    map->count = 0;
+    map->version = 0;
+    while (s.pos < s.end) {
+        char *tag = (char *)memchr(s.pos, '<', s.end - s.pos);
+        if (tag == NULL) {
+            break;
+        }
+        s.pos = tag + 1;
+        if (s.pos >= s.end) {
+            break;
+        }
+        if (*s.pos == '?') {
+            if (skip_past(&s, "?>") != 0) {
+                LOGE("chime parser: unterminated declaration at offset %ld", (long)(tag - s.start));
+                return -1;
+            }
+            continue;
+        }
+        if (*s.pos == '!') {
+            const char *close = ">";
+            if (s.end - s.pos >= 3 && memcmp(s.pos, "!--", 3) == 0) {
+                close = "-->";
+            } else if (s.end - s.pos >= 8 && memcmp(s.pos, "![CDATA[", 8) == 0) {
+                close = "]]>";
+            } else {
+                char *gt = (char *)memchr(s.pos, '>', s.end - s.pos);
+                char *bracket = (char *)memchr(s.pos, '[', s.end - s.pos);
+                if (bracket && (gt == NULL || bracket < gt)) {
+                    close = "]>"; // DOCTYPE with an internal subset
+                }
+            }
+            if (skip_past(&s, close) != 0) {
+                LOGE("chime parser: unterminated markup at offset %ld", (long)(tag - s.start));
+                return -1;
+            }
+            continue;
+        }
+        if (*s.pos == '/') {
+            if (skip_past(&s, ">") != 0) {
+                LOGE("chime parser: unterminated end tag at offset %ld", (long)(tag - s.start));
+                return -1;
+            }
+            if (--depth < mapping_depth) {
+                mapping_depth = -1;
+                dir = "";
+            }
+            continue;
+        }
+
+        char *name = s.pos;
+        while (s.pos < s.end && is_name_char(*s.pos)) {
+            s.pos++;
+        }
+        size_t name_len = s.pos - name;
+        if (name_len == 0) {
+            LOGE("chime parser: bad tag at offset %ld", (long)(tag - s.start));
+            return -1;
+        }
+        int is_root = depth == 0;
+        int is_mapping = depth == 1 && name_is(name, name_len, CHIME_XML_MAPPING_TAG);
+        int is_pos = depth == mapping_depth && name_is(name, name_len, CHIME_XML_POS_TAG);
+        const char *file_path = NULL;
+        const char *file_name = NULL;
+        const char *id = NULL;
+        int self_closing = 0;
+
+        for (;;) {
+            skip_space(&s);
+            if (s.pos >= s.end) {
+                LOGE("chime parser: unterminated tag at offset %ld", (long)(tag - s.start));
+                return -1;
+            }
+            if (*s.pos == '>') {
+                s.pos++;
+                break;
+            }
+            if (*s.pos == '/') {
+                if (s.pos + 1 >= s.end || s.pos[1] != '>') {
+                    LOGE("chime parser: bad tag at offset %ld", (long)(tag - s.start));
+                    return -1;
+                }
+                s.pos += 2;
+                self_closing = 1;
+                break;
+            }
+            char *attr = s.pos;
+            while (s.pos < s.end && is_name_char(*s.pos)) {
+                s.pos++;
+            }
+            size_t attr_len = s.pos - attr;
+            skip_space(&s);
+            if (attr_len == 0 || s.pos >= s.end || *s.pos != '=') {
+                LOGE("chime parser: bad attribute at offset %ld", (long)(attr - s.start));
+                return -1;
+            }
+            s.pos++;
+            skip_space(&s);
+            if (s.pos >= s.end || (*s.pos != '"' && *s.pos != '\'')) {
+                LOGE("chime parser: unquoted attribute value at offset %ld", (long)(s.pos - s.start));
+                return -1;
+            }
+            char quote = *s.pos++;
+            char *value = s.pos;
+            char *value_end = (char *)memchr(value, quote, s.end - value);
+            if (value_end == NULL) {
+                LOGE("chime parser: unterminated attribute value at offset %ld", (long)(value - s.start));
+                return -1;
+            }
+            s.pos = value_end + 1;
+            if (!is_root && !is_mapping && !is_pos) {
+                continue;
+            }
+            *value_end = '\0';
+            unescape(value);
+            if (is_root && name_is(attr, attr_len, "version")) {
+                map->version = (int)strtol(value, NULL, 0);
+            } else if (is_mapping && name_is(attr, attr_len, "filePath")) {
+                file_path = value;
+            } else if (is_pos && name_is(attr, attr_len, "id")) {
+                id = value;
+            } else if (is_pos && name_is(attr, attr_len, "fileName")) {
+                file_name = value;
+            }
+        }
+
+        if (is_mapping && !self_closing) {
+            mapping_depth = depth + 1;
+            dir = file_path ? file_path : "";
+        } else if (is_pos) {
+            if (id == NULL || file_name == NULL) {
+                LOGE("chime parser: %s without %s at offset %ld", CHIME_XML_POS_TAG, id ? "fileName" : "id",
+                     (long)(tag - s.start));
+            } else if (add_entry(map, (int32_t)strtoul(id, NULL, 0), dir, file_name) != 0) {
+                return -1;
+            }
+        }
+        if (!self_closing) {
+            depth++;
+        }
+    }
+    return 0;
+}
+
+int chime_xml_load(chime_mapping_t *map, const char *xml_file_path)
+{
+    memset(map, 0, sizeof(*map));
+    FILE *file = fopen(xml_file_path, "rb");
+    if (file == NULL) {
+        LOGE("can't open config file:[%s]", xml_file_path);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        LOGE("can't get the size of config file:[%s]", xml_file_path);
+        fclose(file);
+        return -1;
+    }
+    map->text = (char *)malloc(size + 1);
+    if (map->text == NULL || fread(map->text, 1, size, file) != (size_t)size) {
+        LOGE("read config file:[%s] failed", xml_file_path);
+        fclose(file);
+        chime_xml_free(map);
+        return -1;
+    }
+    fclose(file);
+    map->text[size] = '\0';
+    if (chime_xml_parse(map, map->text, size) != 0) {
+        LOGE("parse config file:[%s] failed", xml_file_path);
+        chime_xml_free(map);
+        return -1;
+    }
+    return 0;
+}
+
+const chime_entry_t *chime_xml_find(const chime_mapping_t *map, int32_t id)
+{
+    for (int i = 0; i < map->count; i++) {
+        if (map->entries[i].id == id) {
+            return &map->entries[i];
+        }
+    }
+    return NULL;
+}
+
+void chime_xml_free(chime_mapping_t *map)
+{
+    free(map->entries);
+    free(map->text);
+    memset(map, 0, sizeof(*map));
+}
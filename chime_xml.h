@@ -0,0 +1,54 @@
+/***************************************************************************
+ * Description: single pass parser for the chime3D.xml position mapping
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 17:35:20
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _CHIME_XML_H
+#define _CHIME_XML_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIME_XML_MAPPING_TAG "Chime3DMapping"
+#define CHIME_XML_POS_TAG "pos"
+
+typedef struct chime_entry {
+    int32_t id;
+    const char *dir;       // filePath of the enclosing Chime3DMapping, "" when it has none
+    const char *file_name;
+} chime_entry_t;
+
+typedef struct chime_mapping {
+    int version;           // version attribute of the root element, 0 when missing
+    int count;
+    int capacity;
+    chime_entry_t *entries; // document order
+    char *text;            // the file when loaded by chime_xml_load, the strings point into it
+} chime_mapping_t;
+
+/* Parses the document in place, attribute values are terminated and
+ * unescaped inside text, which has to outlive the mapping. The only
+ * allocation is the entry array, grown by doubling. Returns 0 or -1 on a
+ * malformed document. */
+int chime_xml_parse(chime_mapping_t *map, char *text, size_t len);
+
+// reads the whole file into one buffer owned by the mapping and parses it
+int chime_xml_load(chime_mapping_t *map, const char *xml_file_path);
+
+// first entry with this id, like the std::map insert it replaces
+const chime_entry_t *chime_xml_find(const chime_mapping_t *map, int32_t id);
+
+void chime_xml_free(chime_mapping_t *map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _CHIME_XML_H
@@ -0,0 +1,273 @@
+/* **************************************************************
+ * @Description: chime3D.xml startup time, libxml2 DOM against chime_xml and chime_cache
+ * @Date: 2026-10-19 17:52:06
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+// g++ -O2 chime_xml_bench.cpp chime_xml.c chime_cache.c log.c -I/usr/include/libxml2 -lxml2 -lpthread -o chime_xml_bench
+// ./chime_xml_bench [positions] [runs] [xml_file]
+// Without xml_file a mapping with the given number of positions is generated first.
+// allocs counts the malloc, calloc and realloc calls of one pass, std::map nodes of the dom path included.
+
+#include "chime_cache.h"
+#include "chime_xml.h"
+#include "log.h"
+#include <libxml/parser.h>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_POSITIONS 10000
+#define DEFAULT_RUNS 20
+#define SYNTHETIC_FILE "chime3D_bench.xml"
+
+static long allocs;
+
+// every allocator call of the process lands here, libxml2, libstdc++ and the parsers alike
+#if defined(__GLIBC__)
+#define COUNT_ALLOCS 1
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size)
+{
+    __atomic_fetch_add(&allocs, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    __atomic_fetch_add(&allocs, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    __atomic_fetch_add(&allocs, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+}
+#else
+#define COUNT_ALLOCS 0 // the column shows -1
+#endif
+
+static long allocs_now()
+{
+    return COUNT_ALLOCS ? __atomic_load_n(&allocs, __ATOMIC_RELAXED) : -1;
+}
+
+static double now_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int write_synthetic(const char *file_name, int positions)
+{
+    FILE *file = fopen(file_name, "w");
+    if (file == NULL) {
+        printf("Failed to create %s\n", file_name);
+        return -1;
+    }
+    fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n\n<NioAudioSoundEffect version =\"2\">\n");
+    fprintf(file, "    <!-- synthetic mapping for chime_xml_bench -->\n");
+    fprintf(file, "    <Chime3DMapping filePath =\"/mnt/nio/etc/chime3d/\" number=\"%d\">\n", positions);
+    for (int i = 1; i <= positions; i++) {
+        fprintf(file, "        <pos id=\"%d\" fileName = \"preset_%05d_line.3dc\"/> \n", i, i);
+    }
+    fprintf(file, "    </Chime3DMapping>\n</NioAudioSoundEffect>\n");
+    fclose(file);
+    return 0;
+}
+
+// the path parseChimeConfigXML used to take, plus the xmlFreeDoc it was missing
+static int dom_parse(const char *xml_file_path, std::map<int32_t, std::string> &files)
+{
+    xmlDocPtr doc = xmlParseFile(xml_file_path);
+    if (doc == NULL) {
+        return -1;
+    }
+    xmlNodePtr root = xmlDocGetRootElement(doc);
+    for (xmlNodePtr cur = root ? root->xmlChildrenNode : NULL; cur != NULL; cur = cur->next) {
+        if (xmlStrcmp(cur->name, (const xmlChar *)CHIME_XML_MAPPING_TAG)) {
+            continue;
+        }
+        std::string dir;
+        xmlChar *path = xmlGetProp(cur, (const xmlChar *)"filePath");
+        if (path) {
+            dir = (const char *)path;
+            xmlFree(path);
+        }
+        for (xmlNodePtr pos = cur->xmlChildrenNode; pos != NULL; pos = pos->next) {
+            if (xmlStrcmp(pos->name, (const xmlChar *)CHIME_XML_POS_TAG)) {
+                continue;
+            }
+            xmlChar *id = xmlGetProp(pos, (const xmlChar *)"id");
+            xmlChar *name = xmlGetProp(pos, (const xmlChar *)"fileName");
+            if (id && name) {
+                files.insert(std::pair<int32_t, std::string>((int32_t)strtoul((const char *)id, NULL, 0),
+                                                             dir + (const char *)name));
+            }
+            xmlFree(id);
+            xmlFree(name);
+        }
+    }
+    xmlFreeDoc(doc);
+    return 0;
+}
+
+static int compare(const std::map<int32_t, std::string> &files, const chime_mapping_t *map)
+{
+    int mismatches = 0;
+    for (int i = 0; i < map->count; i++) {
+        const chime_entry_t *entry = &map->entries[i];
+        std::map<int32_t, std::string>::const_iterator it = files.find(entry->id);
+        if (chime_xml_find(map, entry->id) != entry) {
+            continue; // a later duplicate, the map kept the first one as well
+        }
+        if (it == files.end() || it->second != std::string(entry->dir) + entry->file_name) {
+            if (mismatches++ < 5) {
+                printf("  id %d: dom \"%s\" stream \"%s%s\"\n", entry->id,
+                       it == files.end() ? "" : it->second.c_str(), entry->dir, entry->file_name);
+            }
+        }
+    }
+    if (files.size() != (size_t)map->count) {
+        printf("  dom found %zu positions, stream %d\n", files.size(), map->count);
+        mismatches++;
+    }
+    return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+    int positions = argc > 1 ? atoi(argv[1]) : DEFAULT_POSITIONS;
+    int runs = argc > 2 ? atoi(argv[2]) : DEFAULT_RUNS;
+    const char *xml_file = argc > 3 ? argv[3] : SYNTHETIC_FILE;
+    if (positions <= 0 || runs <= 0) {
+        printf("Usage: %s [positions] [runs] [xml_file]\n", argv[0]);
+        return -1;
+    }
+    if (argc <= 3 && write_synthetic(xml_file, positions) != 0) {
+        return -1;
+    }
+    xmlInitParser();
+
+    double dom_best = 1e9, dom_total = 0;
+    double stream_best = 1e9, stream_total = 0;
+    double cache_best = 1e9, cache_total = 0;
+    long dom_allocs = 0, stream_allocs = 0, cache_allocs = 0; // of the last run
+    std::map<int32_t, std::string> files;
+    chime_mapping_t map;
+    chime_cache_t cache;
+    char cache_path[512];
+    snprintf(cache_path, sizeof(cache_path), "%s%s", xml_file, CHIME_CACHE_SUFFIX);
+    unlink(cache_path);
+    double start = now_seconds();
+    if (chime_cache_open(&cache, xml_file, cache_path) != 0) {
+        printf("chime_cache failed to build %s\n", cache_path);
+        return -1;
+    }
+    double cache_build = now_seconds() - start;
+    chime_cache_close(&cache);
+    for (int run = 0; run < runs; run++) {
+        files.clear();
+        long before = allocs_now();
+        start = now_seconds();
+        if (dom_parse(xml_file, files) != 0) {
+            printf("libxml2 failed to parse %s\n", xml_file);
+            return -1;
+        }
+        double elapsed = now_seconds() - start;
+        dom_allocs = allocs_now() - before;
+        dom_total += elapsed;
+        dom_best = elapsed < dom_best ? elapsed : dom_best;
+
+        before = allocs_now();
+        start = now_seconds();
+        if (chime_xml_load(&map, xml_file) != 0) {
+            printf("chime_xml failed to parse %s\n", xml_file);
+            return -1;
+        }
+        elapsed = now_seconds() - start;
+        stream_allocs = allocs_now() - before;
+        stream_total += elapsed;
+        stream_best = elapsed < stream_best ? elapsed : stream_best;
+        if (run < runs - 1) {
+            chime_xml_free(&map);
+        }
+
+        before = allocs_now();
+        start = now_seconds();
+        if (chime_cache_open(&cache, xml_file, cache_path) != 0) {
+            printf("chime_cache failed to open %s\n", cache_path);
+            return -1;
+        }
+        elapsed = now_seconds() - start;
+        cache_allocs = allocs_now() - before;
+        cache_total += elapsed;
+        cache_best = elapsed < cache_best ? elapsed : cache_best;
+        if (run < runs - 1) {
+            chime_cache_close(&cache);
+        }
+    }
+
+    printf("%s: %d positions, %d runs\n", xml_file, map.count, runs);
+    printf("%-10s %12s %12s %14s %12s\n", "parser", "best ms", "mean ms", "ns/position", "allocs");
+    printf("%-10s %12.3f %12.3f %14.1f %12ld\n", "dom", dom_best * 1e3, dom_total / runs * 1e3,
+           dom_best * 1e9 / (map.count ? map.count : 1), dom_allocs);
+    printf("%-10s %12.3f %12.3f %14.1f %12ld\n", "stream", stream_best * 1e3, stream_total / runs * 1e3,
+           stream_best * 1e9 / (map.count ? map.count : 1), stream_allocs);
+    printf("%-10s %12.3f %12.3f %14.1f %12ld\n", "cache", cache_best * 1e3, cache_total / runs * 1e3,
+           cache_best * 1e9 / (map.count ? map.count : 1), cache_allocs);
+    printf("speedup over dom: stream %.1fx, cache %.1fx (first build %.3f ms)\n", dom_best / stream_best,
+           dom_best / cache_best, cache_build * 1e3);
+
+    // what get_3dc_file_Path costs on the audio thread
+    const int lookups = 1000000;
+    size_t checksum = 0;
+    start = now_seconds();
+    for (int i = 0; i < lookups; i++) {
+        const char *path = chime_cache_path(&cache, (int32_t)(i % (map.count + 2)));
+        checksum += path ? (size_t)path[0] : 0;
+    }
+    double lookup_time = now_seconds() - start;
+    printf("path lookup %.1f ns (%s, %zu)\n", lookup_time * 1e9 / lookups, cache.id_span ? "index" : "binary search",
+           checksum);
+
+    int mismatches = compare(files, &map);
+    for (int i = 0; i < map.count; i++) {
+        const chime_entry_t *entry = &map.entries[i];
+        const chime_cache_entry_t *cached = chime_cache_find(&cache, entry->id);
+        if (chime_xml_find(&map, entry->id) == entry &&
+            (cached == NULL || strcmp(chime_cache_str(&cache, cached->dir), entry->dir) ||
+             strcmp(chime_cache_str(&cache, cached->file_name), entry->file_name) ||
+             (entry->file_name[0] &&
+              (std::string(entry->dir) + entry->file_name) != chime_cache_path(&cache, entry->id)))) {
+            if (mismatches++ < 5) {
+                printf("  id %d missing or different in the cache\n", entry->id);
+            }
+        }
+    }
+    if (mismatches) {
+        printf("%d positions differ between the parsers\n", mismatches);
+    }
+    chime_xml_free(&map);
+    chime_cache_close(&cache);
+    xmlCleanupParser();
+    return mismatches ? -1 : 0;
+}
@@ -1,6 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <fftw3.h>
+#include "fft_plan_cache.h"
 #include <tensorflow/c/c_api.h>
 #include "wav.h"
 
@@ -80,24 +80,23 @@ void RunModel(TF_Graph* graph, float* input_data, int num_elements, float* outpu
 }
 
 // 音频数据处理函数示例
+// 计划来自进程内的 FFT 计划缓存，只在第一次遇到这个长度时规划，输出使用线程的预分配缓冲区
 void ProcessAudio(float* input, int length) {
-    fftwf_plan plan;
-    fftwf_complex* output = (fftwf_complex*)fftwf_malloc(sizeof(fftwf_complex) * length);
-
-    // 创建 FFT 计划
-    plan = fftwf_plan_dft_r2c_1d(length, input, output, FFTW_ESTIMATE);
+    const fft_cached_plan_t* plan = fft_plan_cache_get(length, FFT_R2C, fftwf_alignment_of(input));
+    if (plan == NULL) {
+        fprintf(stderr, "Failed to plan a %d point FFT\n", length);
+        return;
+    }
+    fftwf_complex* output = NULL;
+    fft_plan_cache_work(plan, (void**)&output);
 
     // 执行 FFT
-    fftwf_execute(plan);
+    fft_plan_cache_execute(plan, input, output);
 
     // 输出结果
     for (int i = 0; i < length / 2 + 1; ++i) {
         printf("FFT output[%d]: %f + %fi\n", i, output[i][0], output[i][1]);
     }
-
-    // 清理
-    fftwf_destroy_plan(plan);
-    fftwf_free(output);
 }
 
 int main(int argc, char* argv[]) {
@@ -109,6 +108,9 @@ int main(int argc, char* argv[]) {
     const char* model_path = argv[1];
     const char* input_wav_path = argv[2];
 
+    // 读取上次运行保存的 FFTW wisdom，文件名可由 FFT_WISDOM 环境变量指定
+    fft_plan_cache_init(getenv(FFT_PLAN_CACHE_WISDOM_ENV) ? NULL : "demo.wisdom");
+
     // 打开 WAV 文件
     WavFile* wav = wav_open(input_wav_path, WAV_OPEN_READ);
     if (wav == NULL) {
@@ -164,9 +166,10 @@ int main(int argc, char* argv[]) {
     TF_DeleteGraph(graph);
     free(audio_data);
     free(output_data);
+    fft_plan_cache_cleanup();
 
     return 0;
 }
 
 // compile with:
-// gcc -Wall -o demo demo.c wav.c -lfftw3f -ltensorflow && ./demo <model.tflite> <input.wav>
+// gcc -Wall -o demo demo.c wav.c fft_plan_cache.c log.c -lfftw3f -ltensorflow -lpthread && ./demo <model.tflite> <input.wav>
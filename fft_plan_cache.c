@@ -0,0 +1,259 @@
+/***************************************************************************
+ * Description: process wide cache of FFTW plans with wisdom kept on disk
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 22:37:19
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * A good FFTW plan is expensive to find and cheap to keep. Plans live in a
+ * fixed table for the life of the process. An entry is filled in completely
+ * before the count that makes it visible is raised, so lookups scan the
+ * table without a lock while planning, which FFTW does not allow from two
+ * threads at once, happens under one mutex.
+ *
+ * FFTW_MEASURE times candidate algorithms on the machine, which for small
+ * sizes costs far more than the transforms it will ever run in a short
+ * program. The results are kept as wisdom in a file. The next run imports
+ * it and the same plans come back without measuring anything. The file is
+ * written to a temporary name and renamed, so a crash never leaves half of
+ * it behind.
+ */
+
+#include "fft_plan_cache.h"
+#include "log.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct work_buffers {
+    void *in;
+    void *out;
+    size_t in_bytes;
+    size_t out_bytes;
+} work_buffers_t;
+
+static fft_cached_plan_t plans[FFT_PLAN_CACHE_MAX];
+static int plan_count;
+static int wisdom_dirty;
+static char wisdom_path[512];
+static pthread_mutex_t plan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread work_buffers_t tls_work;
+static pthread_key_t work_key;
+static pthread_once_t work_key_once = PTHREAD_ONCE_INIT;
+
+static const char *kind_name(fft_kind_t kind)
+{
+    static const char *names[] = {"r2c", "c2r", "forward", "backward"};
+    return (unsigned)kind < sizeof(names) / sizeof(names[0]) ? names[kind] : "unknown";
+}
+
+static void work_release(void *arg)
+{
+    work_buffers_t *work = (work_buffers_t *)arg;
+    fftwf_free(work->in);
+    fftwf_free(work->out);
+    memset(work, 0, sizeof(*work));
+}
+
+static void work_key_create(void)
+{
+    pthread_key_create(&work_key, work_release);
+}
+
+static int work_reserve(size_t in_bytes, size_t out_bytes)
+{
+    work_buffers_t *work = &tls_work;
+    pthread_once(&work_key_once, work_key_create);
+    if (work->in_bytes < in_bytes) {
+        fftwf_free(work->in);
+        work->in = fftwf_malloc(in_bytes);
+        work->in_bytes = work->in ? in_bytes : 0;
+    }
+    if (work->out_bytes < out_bytes) {
+        fftwf_free(work->out);
+        work->out = fftwf_malloc(out_bytes);
+        work->out_bytes = work->out ? out_bytes : 0;
+    }
+    pthread_setspecific(work_key, work);
+    return work->in && work->out ? 0 : -1;
+}
+
+int fft_plan_cache_init(const char *wisdom_file)
+{
+    if (wisdom_file == NULL) {
+        wisdom_file = getenv(FFT_PLAN_CACHE_WISDOM_ENV);
+    }
+    pthread_mutex_lock(&plan_lock);
+    snprintf(wisdom_path, sizeof(wisdom_path), "%s", wisdom_file ? wisdom_file : "");
+    int ret = 0;
+    if (wisdom_path[0] && access(wisdom_path, R_OK) == 0) {
+        if (fftwf_import_wisdom_from_filename(wisdom_path)) {
+            LOGI("fft plan cache: wisdom loaded from %s", wisdom_path);
+        } else {
+            LOGE("fft plan cache: %s is not FFTW wisdom, it will be replaced", wisdom_path);
+            ret = -1;
+        }
+    }
+    pthread_mutex_unlock(&plan_lock);
+    return ret;
+}
+
+static const fft_cached_plan_t *lookup(int size, fft_kind_t kind, int unaligned)
+{
+    int count = __atomic_load_n(&plan_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) {
+        if (plans[i].size == size && plans[i].kind == kind && plans[i].unaligned == unaligned) {
+            return &plans[i];
+        }
+    }
+    return NULL;
+}
+
+static fftwf_plan make_plan(int size, fft_kind_t kind, unsigned flags, size_t in_bytes, size_t out_bytes)
+{
+    // FFTW_MEASURE overwrites the arrays it plans on, so plan on scratch ones
+    void *in = fftwf_malloc(in_bytes);
+    void *out = fftwf_malloc(out_bytes);
+    fftwf_plan plan = NULL;
+    if (in && out) {
+        switch (kind) {
+        case FFT_R2C:
+            plan = fftwf_plan_dft_r2c_1d(size, (float *)in, (fftwf_complex *)out, flags);
+            break;
+        case FFT_C2R:
+            plan = fftwf_plan_dft_c2r_1d(size, (fftwf_complex *)in, (float *)out, flags);
+            break;
+        case FFT_FORWARD:
+        case FFT_BACKWARD:
+            plan = fftwf_plan_dft_1d(size, (fftwf_complex *)in, (fftwf_complex *)out,
+                                     kind == FFT_FORWARD ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+            break;
+        }
+    }
+    fftwf_free(in);
+    fftwf_free(out);
+    return plan;
+}
+
+const fft_cached_plan_t *fft_plan_cache_get(int size, fft_kind_t kind, int alignment)
+{
+    int unaligned = alignment != 0;
+    size_t complex_bytes = (size_t)(size / 2 + 1) * sizeof(fftwf_complex);
+    size_t in_bytes = kind == FFT_R2C ? size * sizeof(float) : kind == FFT_C2R ? complex_bytes
+                                                                               : size * sizeof(fftwf_complex);
+    size_t out_bytes = kind == FFT_R2C ? complex_bytes : kind == FFT_C2R ? size * sizeof(float)
+                                                                         : size * sizeof(fftwf_complex);
+    if (size <= 0 || (unsigned)kind > FFT_BACKWARD) {
+        LOGE("fft plan cache: no %s plan of size %d", kind_name(kind), size);
+        return NULL;
+    }
+    if (work_reserve(in_bytes, out_bytes) != 0) {
+        LOGE("fft plan cache: out of memory for the work buffers of a %d point %s", size, kind_name(kind));
+        return NULL;
+    }
+    const fft_cached_plan_t *found = lookup(size, kind, unaligned);
+    if (found) {
+        return found;
+    }
+
+    pthread_mutex_lock(&plan_lock);
+    found = lookup(size, kind, unaligned); // another thread may have planned it meanwhile
+    if (found || plan_count == FFT_PLAN_CACHE_MAX) {
+        if (found == NULL) {
+            LOGE("fft plan cache: full, raise FFT_PLAN_CACHE_MAX above %d", FFT_PLAN_CACHE_MAX);
+        }
+        pthread_mutex_unlock(&plan_lock);
+        return found;
+    }
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned flags = FFTW_MEASURE | (unaligned ? FFTW_UNALIGNED : 0);
+    fftwf_plan plan = make_plan(size, kind, flags, in_bytes, out_bytes);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (plan == NULL) {
+        LOGE("fft plan cache: FFTW can't plan a %d point %s", size, kind_name(kind));
+        pthread_mutex_unlock(&plan_lock);
+        return NULL;
+    }
+    fft_cached_plan_t *entry = &plans[plan_count];
+    entry->size = size;
+    entry->kind = kind;
+    entry->unaligned = unaligned;
+    entry->plan = plan;
+    entry->in_bytes = in_bytes;
+    entry->out_bytes = out_bytes;
+    __atomic_store_n(&plan_count, plan_count + 1, __ATOMIC_RELEASE);
+    wisdom_dirty = 1;
+    LOGI("fft plan cache: %d point %s%s planned in %.2f ms", size, kind_name(kind), unaligned ? " unaligned" : "",
+         (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6);
+    pthread_mutex_unlock(&plan_lock);
+    return entry;
+}
+
+void fft_plan_cache_execute(const fft_cached_plan_t *plan, void *in, void *out)
+{
+    switch (plan->kind) {
+    case FFT_R2C:
+        fftwf_execute_dft_r2c(plan->plan, (float *)in, (fftwf_complex *)out);
+        break;
+    case FFT_C2R:
+        fftwf_execute_dft_c2r(plan->plan, (fftwf_complex *)in, (float *)out);
+        break;
+    case FFT_FORWARD:
+    case FFT_BACKWARD:
+        fftwf_execute_dft(plan->plan, (fftwf_complex *)in, (fftwf_complex *)out);
+        break;
+    }
+}
+
+void *fft_plan_cache_work(const fft_cached_plan_t *plan, void **out)
+{
+    work_buffers_t *work = &tls_work;
+    if (work->in_bytes < plan->in_bytes || work->out_bytes < plan->out_bytes) {
+        return NULL;
+    }
+    if (out) {
+        *out = work->out;
+    }
+    return work->in;
+}
+
+int fft_plan_cache_save(void)
+{
+    pthread_mutex_lock(&plan_lock);
+    int ret = 0;
+    if (wisdom_path[0] && wisdom_dirty) {
+        char temp[sizeof(wisdom_path) + 16];
+        snprintf(temp, sizeof(temp), "%s.%d", wisdom_path, (int)getpid());
+        if (!fftwf_export_wisdom_to_filename(temp) || rename(temp, wisdom_path) != 0) {
+            LOGE("fft plan cache: can't save wisdom to %s: %s", wisdom_path, strerror(errno));
+            unlink(temp);
+            ret = -1;
+        } else {
+            wisdom_dirty = 0;
+            LOGI("fft plan cache: wisdom saved to %s", wisdom_path);
+        }
+    }
+    pthread_mutex_unlock(&plan_lock);
+    return ret;
+}
+
+void fft_plan_cache_cleanup(void)
+{
+    fft_plan_cache_save();
+    pthread_mutex_lock(&plan_lock);
+    for (int i = 0; i < plan_count; i++) {
+        fftwf_destroy_plan(plans[i].plan);
+    }
+    memset(plans, 0, sizeof(plans));
+    __atomic_store_n(&plan_count, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&plan_lock);
+    work_release(&tls_work);
+}
@@ -0,0 +1,73 @@
+/***************************************************************************
+ * Description: process wide cache of FFTW plans with wisdom kept on disk
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 22:37:19
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _FFT_PLAN_CACHE_H
+#define _FFT_PLAN_CACHE_H
+
+#include <fftw3.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FFT_PLAN_CACHE_MAX 64               // distinct plans per process
+#define FFT_PLAN_CACHE_WISDOM_ENV "FFT_WISDOM" // wisdom file when fft_plan_cache_init gets NULL
+
+typedef enum {
+    FFT_R2C,               // real in, size / 2 + 1 complex out
+    FFT_C2R,               // the inverse, unnormalized like FFTW
+    FFT_FORWARD,           // complex to complex
+    FFT_BACKWARD
+} fft_kind_t;
+
+typedef struct fft_cached_plan {
+    int size;
+    fft_kind_t kind;
+    int unaligned;         // planned with FFTW_UNALIGNED, runs on arrays of any alignment
+    fftwf_plan plan;
+    size_t in_bytes;
+    size_t out_bytes;
+} fft_cached_plan_t;
+
+/* Loads FFTW wisdom from wisdom_file, or from the file named by
+ * FFT_PLAN_CACHE_WISDOM_ENV when it is NULL. Plans made later reuse the
+ * measurements found there, so FFTW_MEASURE plans cost next to nothing
+ * from the second run on. Calling it is optional, without it nothing is
+ * loaded or saved. Returns 0, or -1 when the file exists but is not
+ * wisdom. */
+int fft_plan_cache_init(const char *wisdom_file);
+
+/* The plan for a transform, made with FFTW_MEASURE on first use and shared
+ * by every caller after that. alignment is fftwf_alignment_of() of the
+ * arrays it will run on, 0 for arrays from fftwf_malloc. Finding a plan
+ * that exists takes no lock. Making one does, since FFTW planning is not
+ * thread safe, so ask for plans before audio starts. The calling thread's
+ * work buffers are grown to fit here as well. NULL on failure. */
+const fft_cached_plan_t *fft_plan_cache_get(int size, fft_kind_t kind, int alignment);
+
+/* Runs a plan out of place on any arrays of the alignment it was asked
+ * for. Safe from any number of threads at once. */
+void fft_plan_cache_execute(const fft_cached_plan_t *plan, void *in, void *out);
+
+/* Aligned input and output buffers of the calling thread, big enough for
+ * every plan the thread got from fft_plan_cache_get. They stay until the
+ * thread exits. NULL when the thread never asked for a plan that large. */
+void *fft_plan_cache_work(const fft_cached_plan_t *plan, void **out);
+
+// writes the wisdom back when new plans were measured, returns 0 or -1
+int fft_plan_cache_save(void);
+
+// saves, then destroys every plan, no plan may be in use
+void fft_plan_cache_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FFT_PLAN_CACHE_H
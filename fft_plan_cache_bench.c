@@ -0,0 +1,87 @@
+/* **************************************************************
+ * @Description: planning an FFT per call against fft_plan_cache, and wisdom between runs
+ * @Date: 2026-10-19 22:58:04
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+// gcc -O3 -march=native fft_plan_cache_bench.c fft_plan_cache.c log.c -lfftw3f -lpthread -o fft_plan_cache_bench
+// ./fft_plan_cache_bench [wisdom file]
+// Run it twice with the same wisdom file, the second run's planning times
+// are what a program pays once the wisdom exists.
+
+#include "fft_plan_cache.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RUN_SECONDS 0.2
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// what demo.c's ProcessAudio did every call: allocate, plan, run, destroy
+static double per_call(float *input, int size)
+{
+    long calls = 0;
+    double elapsed, start = now_seconds();
+    do {
+        fftwf_complex *output = fftwf_alloc_complex(size / 2 + 1);
+        fftwf_plan plan = fftwf_plan_dft_r2c_1d(size, input, output, FFTW_ESTIMATE);
+        fftwf_execute(plan);
+        fftwf_destroy_plan(plan);
+        fftwf_free(output);
+        calls++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < RUN_SECONDS);
+    return elapsed / calls;
+}
+
+static double cached(float *input, int size)
+{
+    const fft_cached_plan_t *plan = fft_plan_cache_get(size, FFT_R2C, fftwf_alignment_of(input));
+    void *output = NULL;
+    fft_plan_cache_work(plan, &output);
+    long calls = 0;
+    double elapsed, start = now_seconds();
+    do {
+        fft_plan_cache_execute(fft_plan_cache_get(size, FFT_R2C, fftwf_alignment_of(input)), input, output);
+        calls++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < RUN_SECONDS);
+    return elapsed / calls;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *wisdom = argc > 1 ? argv[1] : "fft_plan_cache_bench.wisdom";
+    const int sizes[] = {256, 512, 1024, 2048, 4096};
+    fft_plan_cache_init(wisdom);
+
+    float *input = fftwf_alloc_real(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+    unsigned seed = 1;
+    for (int i = 0; i < sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        input[i] = (float)((seed >> 8) / 16777216.0 * 2.0 - 1.0);
+    }
+    printf("%6s %14s %16s %14s %9s\n", "size", "planning ms", "per call us", "cached us", "speedup");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        double start = now_seconds();
+        if (fft_plan_cache_get(sizes[s], FFT_R2C, fftwf_alignment_of(input)) == NULL) {
+            return -1;
+        }
+        double planning = now_seconds() - start;
+        double slow = per_call(input, sizes[s]);
+        double fast = cached(input, sizes[s]);
+        printf("%6d %14.2f %16.2f %14.2f %8.1fx\n", sizes[s], planning * 1e3, slow * 1e6, fast * 1e6, slow / fast);
+    }
+    fftwf_free(input);
+    fft_plan_cache_cleanup();
+    return 0;
+}
@@ -18,10 +18,7 @@
 #ifdef _WIN32
 #include <windows.h>
 #else
-#include <pthread.h>
-#include <sys/syscall.h>
-#include <sys/time.h>
-#include <unistd.h>
+#include "log_time.h"
 #endif
 
 typedef enum {
@@ -43,7 +40,17 @@ typedef enum {
 
 #define LOG_FILE_NAME "young.log"
 
-#ifdef _WIN32
+#if defined(FILE_LOGGER_ASYNC) && !defined(_WIN32)
+// hand the line to the writer thread in log_async.c instead of opening the file here
+#include "log_async.h"
+#define LOG(level, level_str, fmt, ...)                                                         \
+    do {                                                                                        \
+        if (log_level >= level) {                                                               \
+            static log_async_site_t _log_site_ = LOG_ASYNC_SITE;                                \
+            log_async_write_site(&_log_site_, level, 1, fmt, ##__VA_ARGS__);                    \
+        }                                                                                       \
+    } while (0)
+#elif defined(_WIN32)
 #define LOG(level, level_str, fmt, ...)                                                                            \
     do {                                                                                                           \
         if (log_level >= level) {                                                                                  \
@@ -75,16 +82,12 @@ typedef enum {
             FILE *log_file = fopen(LOG_FILE_NAME, "a+");                                                        \
             if (log_file) {                                                                                     \
                 char _log_buf[256] = {0};                                                                       \
-                struct tm tm_info;                                                                              \
-                struct timeval tv;                                                                              \
-                gettimeofday(&tv, NULL);                                                                        \
-                localtime_r(&tv.tv_sec, &tm_info);                                                              \
-                int pid = (int)getpid();                                                                        \
-                int tid = (int)syscall(SYS_gettid);                                                             \
+                log_time_t _lt;                                                                                 \
+                log_time_now(&_lt);                                                                             \
                 snprintf(_log_buf, sizeof(_log_buf), "%04d-%02d-%02d %02d:%02d:%02d.%03ld [%d.%d] %s %s:%d @%s", \
-                         tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday,                           \
-                         tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec, tv.tv_usec / 1000,                    \
-                         pid, tid, level_str, __FILENAME__, __LINE__, __FUNCTION__);                            \
+                         _lt.tm.tm_year + 1900, _lt.tm.tm_mon + 1, _lt.tm.tm_mday,                              \
+                         _lt.tm.tm_hour, _lt.tm.tm_min, _lt.tm.tm_sec, _lt.usec / 1000,                         \
+                         log_time_pid(), log_time_tid(), level_str, __FILENAME__, __LINE__, __FUNCTION__);      \
                 fprintf(log_file, "%-96s" fmt "\n", _log_buf, ##__VA_ARGS__);                                   \
                 fflush(log_file);                                                                               \
                 fclose(log_file);                                                                               \
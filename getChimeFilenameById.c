@@ -6,77 +6,35 @@
  * Copyright (c) 2024 by Panda-Young, All Rights Reserved.
  **************************************************************************/
 
+// gcc getChimeFilenameById.c chime_xml.c chime_cache.c log.c -lpthread -o getChimeFilenameById
+// ./getChimeFilenameById [chime3D.xml] [id...]
+
+#include "chime_cache.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 
-int getFilenameById(const char *filename, int id, char *path)
+// the XML is read once, or not at all when its cache is current, every id after that is a table load
+const char *getFilenameById(const chime_cache_t *cache, int id)
 {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        return -1;
-    }
-
-    char line[256];
-    char filePath[256] = "";
-    int found_id = -1;
-    while (fgets(line, sizeof(line), file)) {
-        if (strstr(line, "<Chime3DMapping")) {
-            char *filePath_start = strstr(line, "filePath");
-            if (filePath_start) {
-                filePath_start = strchr(filePath_start, '='); // find '=' character
-                if (filePath_start) {
-                    filePath_start++; // skip past '='
-                    while (*filePath_start == ' ')
-                        filePath_start++; // skip past spaces
-                    if (*filePath_start == '\"')
-                        filePath_start++; // skip past '"'
-                    char *filePath_end = strstr(filePath_start, "\"");
-                    if (filePath_end) {
-                        strncpy(filePath, filePath_start, filePath_end - filePath_start);
-                        filePath[filePath_end - filePath_start] = '\0';
-                    }
-                }
-            }
-        } else if (strstr(line, "<pos")) {
-            char *id_start = strstr(line, "id=\"");
-            if (id_start) {
-                found_id = atoi(id_start + 4);
-            }
-
-            if (found_id == id) {
-                char *filename_start = strstr(line, "fileName");
-                if (filename_start) {
-                    filename_start = strchr(filename_start, '='); // find '=' character
-                    if (filename_start) {
-                        filename_start++; // skip past '='
-                        while (*filename_start == ' ')
-                            filename_start++; // skip past spaces
-                        if (*filename_start == '\"')
-                            filename_start++; // skip past '"'
-                        char *filename_end = strstr(filename_start, "\"");
-                        if (filename_end) {
-                            strcpy(path, filePath);
-                            strncat(path, filename_start, filename_end - filename_start);
-                            path[strlen(filePath) + filename_end - filename_start] = '\0';
-                            fclose(file);
-                            return 0;
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    fclose(file);
-    return -1;
+    return chime_cache_path(cache, id);
 }
 
-int main()
+int main(int argc, char *argv[])
 {
-    char path[256];
-    if (getFilenameById("chime3D.xml", 1, path) == 0) {
-        printf("Path: %s\n", path);
+    const char *xml_file = argc > 1 ? argv[1] : "chime3D.xml";
+    chime_cache_t cache;
+    if (chime_cache_open(&cache, xml_file, NULL) != 0) {
+        return -1;
+    }
+    for (int i = 2; i < argc || (argc <= 2 && i == 2); i++) {
+        int id = argc > 2 ? atoi(argv[i]) : 1;
+        const char *path = getFilenameById(&cache, id);
+        if (path) {
+            printf("Path: %s\n", path);
+        } else {
+            printf("No file for id %d\n", id);
+        }
     }
+    chime_cache_close(&cache);
     return 0;
 }
@@ -51,6 +51,10 @@ void close_log_operation()
 }
 #endif
 
+#if USE_RUNTIME_LOG_LEVEL && !USE_ASYNCLOG
+static void log_rate_stop(void);
+#endif
+
 #if USE_FILELOG
 #define MAX_LOG_FILE_SIZE 1048576 // 1MB
 #define LOG_FILE_NAME "young.log"
@@ -62,9 +66,15 @@ __attribute__((constructor)) void open_log_file()
     struct stat st;
     if (stat(LOG_FILE_NAME, &st) == 0 && st.st_size > MAX_LOG_FILE_SIZE) {
         char new_file_name[1024] = {0};
+        struct tm tm_info;
+#if defined(__MINGW32__) || defined(__MINGW64__)
+        localtime_s(&tm_info, &st.st_mtime);
+#else
+        localtime_r(&st.st_mtime, &tm_info);
+#endif
         snprintf(new_file_name, sizeof(new_file_name), "%s.%04d-%02d-%02d_%02d-%02d-%02d.log", LOG_FILE_NAME,
-                 localtime(&st.st_mtime)->tm_year + 1900, localtime(&st.st_mtime)->tm_mon + 1, localtime(&st.st_mtime)->tm_mday,
-                 localtime(&st.st_mtime)->tm_hour, localtime(&st.st_mtime)->tm_min, localtime(&st.st_mtime)->tm_sec);
+                 tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday,
+                 tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
         rename(LOG_FILE_NAME, new_file_name);
     }
     log_file = fopen(LOG_FILE_NAME, "a+");
@@ -72,6 +82,9 @@ __attribute__((constructor)) void open_log_file()
 
 __attribute__((destructor)) void close_log_file()
 {
+#if USE_RUNTIME_LOG_LEVEL && !USE_ASYNCLOG
+    log_rate_stop(); // its last summaries still go to the file
+#endif
     if (log_file) {
         fflush(log_file);
         fclose(log_file);
@@ -80,12 +93,378 @@ __attribute__((destructor)) void close_log_file()
 #endif
 #endif
 
+#if USE_RUNTIME_LOG_LEVEL
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define LOG_LEVEL_MAX_RULES 32
+#define LOG_RATE_MAX_SITES 256
+
+typedef struct log_level_rule {
+    char name[64];
+    int level;
+} log_level_rule_t;
+
+// slots are claimed and cleared with atomics so the signal handler can walk them without a lock
+static log_module_t *log_modules[LOG_MAX_MODULES];
+static log_level_rule_t log_rules[LOG_LEVEL_MAX_RULES];
+static int log_rule_count;
+static int log_default_rule = -1; // level from "*" or a bare level, -1 keeps each file's log_level
+static pthread_mutex_t log_rule_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t log_env_once = PTHREAD_ONCE_INIT;
+static int log_forced_debug;
+static int log_ctl_fd = -1;
+// claimed lock free by a flooding thread, walked and cleared under log_rule_lock
+static log_rate_site_t *log_rate_sites[LOG_RATE_MAX_SITES];
+
+static int log_module_match(const char *name, const char *rule)
+{
+    if (strcmp(name, rule) == 0) {
+        return 1;
+    }
+    // a file module also answers to its base name, with or without the extension
+    const char *base = strrchr(name, '/') ? strrchr(name, '/') + 1 : name;
+    size_t len = strlen(rule);
+    return strncmp(base, rule, len) == 0 && (base[len] == '\0' || base[len] == '.');
+}
+
+static int log_level_parse(const char *text)
+{
+    static const char *names[] = {"off", "error", "warn", "info", "debug"};
+    if (text[0] >= '0' && text[0] <= '4' && text[1] == '\0') {
+        return text[0] - '0';
+    }
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if (strncasecmp(text, names[i], strlen(names[i])) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// caller holds log_rule_lock
+static void log_module_resolve(log_module_t *module)
+{
+    int level = log_default_rule >= 0 ? log_default_rule : module->default_level;
+    for (int i = 0; i < log_rule_count; i++) {
+        if (log_module_match(module->name, log_rules[i].name)) {
+            level = log_rules[i].level;
+        }
+    }
+    __atomic_store_n(&module->base_level, level, __ATOMIC_RELAXED);
+    if (!__atomic_load_n(&log_forced_debug, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&module->level, level, __ATOMIC_RELAXED);
+    }
+}
+
+static int log_rule_add(const char *name, int level)
+{
+    if (strcmp(name, "*") == 0) {
+        log_default_rule = level; // only the default, module rules win wherever they stand
+        return 0;
+    }
+    for (int i = 0; i < log_rule_count; i++) {
+        if (strcmp(log_rules[i].name, name) == 0) {
+            memmove(&log_rules[i], &log_rules[i + 1], (log_rule_count - i - 1) * sizeof(log_rules[0]));
+            log_rule_count--;
+            break;
+        }
+    }
+    if (log_rule_count == LOG_LEVEL_MAX_RULES) {
+        return -1;
+    }
+    snprintf(log_rules[log_rule_count].name, sizeof(log_rules[0].name), "%s", name);
+    log_rules[log_rule_count].level = level;
+    log_rule_count++;
+    return 0;
+}
+
+int log_level_apply(const char *spec)
+{
+    char buf[1024];
+    char *save = NULL;
+    int ret = 0;
+    if (spec == NULL) {
+        return -1;
+    }
+    snprintf(buf, sizeof(buf), "%s", spec);
+    pthread_mutex_lock(&log_rule_lock);
+    for (char *token = strtok_r(buf, ", \t\r\n", &save); token; token = strtok_r(NULL, ", \t\r\n", &save)) {
+        char *eq = strchr(token, '=');
+        const char *name = "*";
+        const char *value = token;
+        if (eq) {
+            *eq = '\0';
+            name = token;
+            value = eq + 1;
+        }
+        int level = log_level_parse(value);
+        if (level < 0 || log_rule_add(name, level) != 0) {
+            fprintf(stderr, "log level: ignoring \"%s\"\n", token);
+            ret = -1;
+        }
+    }
+    for (int i = 0; i < LOG_MAX_MODULES; i++) {
+        log_module_t *module = __atomic_load_n(&log_modules[i], __ATOMIC_ACQUIRE);
+        if (module) {
+            log_module_resolve(module);
+        }
+    }
+    pthread_mutex_unlock(&log_rule_lock);
+    return ret;
+}
+
+static void log_level_load_env(void)
+{
+    const char *spec = getenv(LOG_LEVEL_ENV);
+    if (spec && spec[0]) {
+        log_level_apply(spec);
+    }
+}
+
+void log_module_register(log_module_t *module)
+{
+    pthread_once(&log_env_once, log_level_load_env);
+    pthread_mutex_lock(&log_rule_lock);
+    for (int i = 0; i < LOG_MAX_MODULES; i++) {
+        if (log_modules[i] == NULL) {
+            log_module_resolve(module);
+            __atomic_store_n(&log_modules[i], module, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&log_rule_lock);
+}
+
+static void log_rate_summary(const log_rate_site_t *site, unsigned long count)
+{
+    const char *name = strrchr(site->file, '/') ? strrchr(site->file, '/') + 1 : site->file;
+    switch (site->level) {
+    case LOG_LEVEL_ERROR:
+        LOGE("%s:%d suppressed %lu messages", name, site->line, count);
+        break;
+    case LOG_LEVEL_WARNING:
+        LOGW("%s:%d suppressed %lu messages", name, site->line, count);
+        break;
+    case LOG_LEVEL_INFO:
+        LOGI("%s:%d suppressed %lu messages", name, site->line, count);
+        break;
+    default:
+        LOGD("%s:%d suppressed %lu messages", name, site->line, count);
+        break;
+    }
+}
+
+void log_module_unregister(log_module_t *module)
+{
+    pthread_mutex_lock(&log_rule_lock);
+    for (int i = 0; i < LOG_MAX_MODULES; i++) {
+        if (log_modules[i] == module) {
+            __atomic_store_n(&log_modules[i], NULL, __ATOMIC_RELEASE);
+        }
+    }
+    // the sites live in the same library, report what they still hold before it is unmapped
+    for (int i = 0; i < LOG_RATE_MAX_SITES; i++) {
+        log_rate_site_t *site = __atomic_load_n(&log_rate_sites[i], __ATOMIC_ACQUIRE);
+        if (site && site->module == module) {
+            __atomic_store_n(&log_rate_sites[i], NULL, __ATOMIC_RELEASE);
+            unsigned long count = LOG_ATOMIC_XCHG(&site->suppressed, 0UL);
+            if (count) {
+                log_rate_summary(site, count);
+            }
+        }
+    }
+    pthread_mutex_unlock(&log_rule_lock);
+}
+
+int log_level_get(const char *name)
+{
+    for (int i = 0; i < LOG_MAX_MODULES; i++) {
+        log_module_t *module = __atomic_load_n(&log_modules[i], __ATOMIC_ACQUIRE);
+        if (module && log_module_match(module->name, name)) {
+            return __atomic_load_n(&module->level, __ATOMIC_RELAXED);
+        }
+    }
+    return -1;
+}
+
+// flips every module between debug and its configured level, only atomics so it is signal safe
+static void log_level_toggle(int signo)
+{
+    (void)signo;
+    int forced = !__atomic_load_n(&log_forced_debug, __ATOMIC_RELAXED);
+    __atomic_store_n(&log_forced_debug, forced, __ATOMIC_RELAXED);
+    for (int i = 0; i < LOG_MAX_MODULES; i++) {
+        log_module_t *module = __atomic_load_n(&log_modules[i], __ATOMIC_ACQUIRE);
+        if (module) {
+            int level = forced ? LOG_LEVEL_DEBUG : __atomic_load_n(&module->base_level, __ATOMIC_RELAXED);
+            __atomic_store_n(&module->level, level, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+int log_level_install_signal(int signo)
+{
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = log_level_toggle;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    return sigaction(signo, &sa, NULL);
+}
+
+static void *log_level_ctl_main(void *arg)
+{
+    int fd = (int)(intptr_t)arg;
+    char buf[1024];
+    for (;;) {
+        ssize_t n = recv(fd, buf, sizeof(buf) - 1, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        buf[n] = '\0';
+        log_level_apply(buf);
+    }
+    return NULL;
+}
+
+// datagrams carry the same text as YOUNG_LOG_LEVEL, e.g.
+// echo "AlgoAPI=debug" | socat - UNIX-SENDTO:/tmp/young.log.ctl
+int log_level_serve(const char *socket_path)
+{
+    struct sockaddr_un addr;
+    pthread_t thread;
+    if (socket_path == NULL || strlen(socket_path) >= sizeof(addr.sun_path) || log_ctl_fd >= 0) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+    unlink(socket_path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        pthread_create(&thread, NULL, log_level_ctl_main, (void *)(intptr_t)fd) != 0) {
+        fprintf(stderr, "log level: control socket %s failed: %s\n", socket_path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    pthread_detach(thread);
+    log_ctl_fd = fd;
+    return 0;
+}
+
+// a site that stays quiet for a pass gives up what it held back, a busy one reports on its next line
+void log_rate_flush(void)
+{
+    static unsigned long last_pass;
+    unsigned long now = log_now_sec();
+    pthread_mutex_lock(&log_rule_lock);
+    if (now != last_pass) {
+        last_pass = now;
+        for (int i = 0; i < LOG_RATE_MAX_SITES; i++) {
+            log_rate_site_t *site = __atomic_load_n(&log_rate_sites[i], __ATOMIC_ACQUIRE);
+            if (site == NULL) {
+                continue;
+            }
+            unsigned long count = LOG_ATOMIC_LOAD(&site->suppressed);
+            if (count == 0 || count != site->seen) {
+                site->seen = count;
+                continue;
+            }
+            site->seen = 0;
+            count = LOG_ATOMIC_XCHG(&site->suppressed, 0UL);
+            if (count) {
+                log_rate_summary(site, count);
+            }
+        }
+    }
+    pthread_mutex_unlock(&log_rule_lock);
+}
+
+// the async writer already calls log_rate_flush() on its passes
+#if !USE_ASYNCLOG
+static pthread_t log_rate_thread;
+static int log_rate_running;
+static int log_rate_stopping;
+static pthread_mutex_t log_rate_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_rate_cond = PTHREAD_COND_INITIALIZER;
+
+static void *log_rate_main(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&log_rate_lock);
+    while (!log_rate_stopping) {
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_sec += 1;
+        pthread_cond_timedwait(&log_rate_cond, &log_rate_lock, &until);
+        pthread_mutex_unlock(&log_rate_lock);
+        log_rate_flush();
+        pthread_mutex_lock(&log_rate_lock);
+    }
+    pthread_mutex_unlock(&log_rate_lock);
+    return NULL;
+}
+
+// started when the program or library is loaded, never from a logging thread
+__attribute__((constructor)) static void log_rate_start(void)
+{
+    log_rate_running = pthread_create(&log_rate_thread, NULL, log_rate_main, NULL) == 0;
+}
+
+// a plugin's copy of log.c runs this at dlclose, before its code is unmapped
+#if USE_FILELOG && (defined(__linux__) || defined(__MINGW32__) || defined(__MINGW64__) || defined(__QNX__) || \
+                    defined(__ANDROID__))
+static void log_rate_stop(void) // from close_log_file
+#else
+__attribute__((destructor)) static void log_rate_stop(void)
+#endif
+{
+    if (!log_rate_running) {
+        return;
+    }
+    pthread_mutex_lock(&log_rate_lock);
+    log_rate_stopping = 1;
+    pthread_cond_signal(&log_rate_cond);
+    pthread_mutex_unlock(&log_rate_lock);
+    pthread_join(log_rate_thread, NULL);
+    log_rate_running = 0;
+}
+#endif
+
+// first suppressed call of a site, one CAS per slot and no lock
+void log_rate_register(log_rate_site_t *site)
+{
+    if (LOG_ATOMIC_XCHG(&site->registered, 1UL)) {
+        return;
+    }
+    for (int i = 0; i < LOG_RATE_MAX_SITES; i++) {
+        log_rate_site_t *expected = NULL;
+        if (__atomic_compare_exchange_n(&log_rate_sites[i], &expected, site, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+    // table full, the site reports on its next line as before
+}
+#endif
+
 const char *__PROGNAME__ = NULL;
 const char *__PROGPATH = NULL;
 
 #if defined(_WIN32) || defined(_WIN64)
 #if defined(__MINGW32__) || defined(__MINGW64__)
-__attribute__((constructor)) void get_exe_path()
+__attribute__((constructor(101))) void get_exe_path()
 {
     char path[1024] = {0};
     GetModuleFileName(NULL, path, sizeof(path));
@@ -105,12 +484,12 @@ INITIALIZER(open_log_file)
     struct _stat st = {0};
     if (_stat(LOG_FILE_NAME, &st) == 0 && st.st_size > MAX_LOG_FILE_SIZE) {
         char new_file_name[1024] = {0};
+        struct tm tm_info = {0};
+        localtime_s(&tm_info, &st.st_mtime);
         snprintf(new_file_name, sizeof(new_file_name),
                  "%s.%04d-%02d-%02d_%02d-%02d-%02d.log", LOG_FILE_NAME,
-                 localtime(&st.st_mtime)->tm_year + 1900,
-                 localtime(&st.st_mtime)->tm_mon + 1,
-                 localtime(&st.st_mtime)->tm_mday, localtime(&st.st_mtime)->tm_hour,
-                 localtime(&st.st_mtime)->tm_min, localtime(&st.st_mtime)->tm_sec);
+                 tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday,
+                 tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
         if (rename(LOG_FILE_NAME, new_file_name) != 0) {
         }
     }
@@ -159,7 +538,7 @@ DESTRUCTOR(free_exe_path)
 #elif defined(__linux__) || defined(__QNX__) || defined(__ANDROID__)
 #include <sys/types.h>
 #include <unistd.h>
-__attribute__((constructor)) void get_exe_path()
+__attribute__((constructor(101))) void get_exe_path()
 {
     char path[1024] = {0};
     pid_t pid = getpid();
@@ -174,7 +553,7 @@ __attribute__((constructor)) void get_exe_path()
 #endif
 
 #if defined(__linux__) || defined(__MINGW32__) || defined(__MINGW64__)
-__attribute__((destructor)) void free_exe_path()
+__attribute__((destructor(101))) void free_exe_path()
 {
     if (__PROGPATH) {
         free((void *)__PROGPATH);
@@ -41,6 +41,10 @@ typedef enum {
 #define USE_ANDROID_LOGCAT 0
 #endif
 #define USE_FILELOG 0
+#if defined(__linux__) || defined(__QNX__) || defined(__ANDROID__)
+#define USE_ASYNCLOG 0 // lines go through log_async.c, sinks picked by LOG_ASYNC_DEFAULT_SINKS
+#define USE_ASYNCLOG_BINARY 0 // with USE_ASYNCLOG, store raw arguments and decode offline with log_decode
+#endif
 
 #ifndef __FILENAME__
 #define __FILENAME__ \
@@ -49,11 +53,113 @@ typedef enum {
 
 extern const char *__PROGNAME__;
 #if defined(__linux__) || defined(__MINGW32__) || defined(__MINGW64__) || defined(__QNX__)
-__attribute__((constructor)) void get_exe_path();
-__attribute__((destructor)) void free_exe_path();
+// first constructor and last destructor, the log backends may use __PROGNAME__ in theirs
+__attribute__((constructor(101))) void get_exe_path();
+__attribute__((destructor(101))) void free_exe_path();
+#endif
+
+/*
+ * Runtime levels per module. log_level stays the compile-time ceiling,
+ * anything more verbose is removed by the compiler. Below it every
+ * translation unit has its own level, read with one relaxed load. A module
+ * is LOG_MODULE when the file defines it before including log.h, otherwise
+ * the file name. Levels are set from YOUNG_LOG_LEVEL at startup, e.g.
+ * "info" or "AlgoAPI=debug,socket_listener.cpp=warn,*=info", and later
+ * through log_level_apply(), the control socket or the toggle signal.
+ * "*" or a bare level is the default for modules without a rule of their
+ * own, wherever it stands in the list.
+ *
+ * The module registers itself from a constructor in every file that
+ * includes log.h, so log.c has to be linked wherever log.h is used, even
+ * in a file that never logs.
+ */
+#if defined(__linux__) || defined(__QNX__) || defined(__ANDROID__)
+#define USE_RUNTIME_LOG_LEVEL 1
+#endif
+
+#if USE_RUNTIME_LOG_LEVEL
+#define LOG_LEVEL_ENV "YOUNG_LOG_LEVEL"
+
+#define LOG_MAX_MODULES 256
+
+typedef struct log_module {
+    int level;         // current level, read by LOG_ENABLED
+    int base_level;    // last configured level, restored when the signal toggles back
+    int default_level; // log_level of the file that owns the module
+    const char *name;
+} log_module_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void log_module_register(log_module_t *module);
+void log_module_unregister(log_module_t *module);
+int log_level_apply(const char *spec);
+int log_level_get(const char *module);
+int log_level_install_signal(int signo);
+int log_level_serve(const char *socket_path);
+#ifdef __cplusplus
+}
+#endif
+
+#ifndef LOG_MODULE
+#define LOG_MODULE __BASE_FILE__ // __FILE__ would name log.h itself
 #endif
+static log_module_t log_module_ = {log_level, log_level, log_level, LOG_MODULE};
+static void __attribute__((constructor)) log_module_init_(void)
+{
+    log_module_register(&log_module_);
+}
+// plugins that include log.h can be dlclosed, take the module out before it is unmapped
+static void __attribute__((destructor)) log_module_exit_(void)
+{
+    log_module_unregister(&log_module_);
+}
+#define LOG_ENABLED(lvl) (log_level >= (lvl) && __atomic_load_n(&log_module_.level, __ATOMIC_RELAXED) >= (lvl))
+#else
+#define LOG_ENABLED(lvl) (log_level >= (lvl))
+#endif
+
+#if USE_ASYNCLOG
+#if USE_ASYNCLOG_BINARY && !defined(LOG_ASYNC_DEFAULT_SINKS)
+#define LOG_ASYNC_DEFAULT_SINKS LOG_ASYNC_SINK_BINARY
+#endif
+#include "log_async.h"
 
-#if USE_SLOG2INFO
+#if USE_ASYNCLOG_BINARY
+#define LOG(level, prefix_content, fmt, args...)                                                 \
+    do {                                                                                        \
+        if (LOG_ENABLED(level)) {                                                               \
+            static log_bin_site_t _log_site_ = LOG_BIN_SITE(level, prefix_content, fmt);        \
+            if (0) {                                                                            \
+                log_bin_check(fmt, ##args);                                                     \
+            }                                                                                   \
+            log_bin_write(&_log_site_, ##args);                                                 \
+        }                                                                                       \
+    } while (0)
+#else
+#define LOG(level, prefix_content, fmt, args...)                                                 \
+    do {                                                                                        \
+        if (LOG_ENABLED(level)) {                                                               \
+            static log_async_site_t _log_site_ = LOG_ASYNC_SITE;                                \
+            log_async_write_site(&_log_site_, level, prefix_content, fmt, ##args);              \
+        }                                                                                       \
+    } while (0)
+#endif
+
+#define LOGD2(fmt, args...) LOG(LOG_LEVEL_DEBUG, 0, fmt, ##args)
+#define LOGD(fmt, args...) LOG(LOG_LEVEL_DEBUG, 1, fmt, ##args)
+#define LOGI2(fmt, args...) LOG(LOG_LEVEL_INFO, 0, fmt, ##args)
+#define LOGI(fmt, args...) LOG(LOG_LEVEL_INFO, 1, fmt, ##args)
+#define LOGW2(fmt, args...) LOG(LOG_LEVEL_WARNING, 0, fmt, ##args)
+#define LOGW(fmt, args...) LOG(LOG_LEVEL_WARNING, 1, fmt, ##args)
+#define LOGE2(fmt, args...) LOG(LOG_LEVEL_ERROR, 0, fmt, ##args)
+#define LOGE(fmt, args...) LOG(LOG_LEVEL_ERROR, 1, fmt, ##args)
+
+void __attribute__((constructor)) log_async_open(void);
+void __attribute__((destructor)) log_async_close(void);
+
+#elif USE_SLOG2INFO
 #include <sys/slog.h>
 #include <sys/slog2.h>
 #include <sys/slogcodes.h>
@@ -66,7 +172,7 @@ extern slog2_buffer_t slog_buffer;
 
 #define LOG(level, code, prefix_content, fmt, ...)                                                           \
     do {                                                                                                     \
-        if (slog_buffer != NULL && log_level >= level) {                                                     \
+        if (slog_buffer != NULL && LOG_ENABLED(level)) {                                                     \
             if (prefix_content) {                                                                            \
                 slog2f(slog_buffer, CODE_MASK, code, "%d @%s: " fmt, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
             } else {                                                                                         \
@@ -94,7 +200,7 @@ void __attribute__((constructor)) slog_buffer_init(void);
 
 #define LOG(level, code, prefix_content, fmt, ...)                                                \
     do {                                                                                          \
-        if (log_level >= level) {                                                                 \
+        if (LOG_ENABLED(level)) {                                                                 \
             if (prefix_content) {                                                                 \
                 slogf(_SLOGC_YOUNG, code, "%d @%s: " fmt, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
             } else {                                                                              \
@@ -113,18 +219,15 @@ void __attribute__((constructor)) slog_buffer_init(void);
 #define LOGE(fmt, ...) LOG(LOG_LEVEL_ERROR, _SLOG_ERROR, 1, fmt, ##__VA_ARGS__)
 
 #elif USE_LINUX_SYSLOG
-#include <pthread.h>
-#include <sys/syscall.h>
+#include "log_time.h"
 #include <syslog.h>
-#include <unistd.h>
 #define LOG(level, priority, prefix_content, fmt, ...)                                 \
     do {                                                                               \
-        if (log_level >= level) {                                                      \
+        if (LOG_ENABLED(level)) {                                                      \
             if (prefix_content) {                                                      \
-                int pid = (int)getpid();                                               \
-                int tid = (int)syscall(SYS_gettid);                                    \
                 syslog(priority, "[%d.%d] %s:%d @%s: " fmt,                            \
-                       pid, tid, __FILENAME__, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
+                       log_time_pid(), log_time_tid(),                                 \
+                       __FILENAME__, __LINE__, __FUNCTION__, ##__VA_ARGS__);           \
             } else {                                                                   \
                 syslog(priority, fmt, ##__VA_ARGS__);                                  \
             }                                                                          \
@@ -150,7 +253,7 @@ void __attribute__((destructor)) close_log_operation(void);
 #define LOG_TAG "young"
 #define LOG(level, priority, prefix_content, fmt, ...)                                    \
     do {                                                                                  \
-        if (log_level >= level) {                                                         \
+        if (LOG_ENABLED(level)) {                                                         \
             if (prefix_content) {                                                         \
                 __android_log_print(priority, LOG_TAG, "%s:%d @%s: " fmt,                 \
                                     __FILENAME__, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
@@ -176,7 +279,7 @@ extern FILE *log_file;
 #if defined(__MINGW32__) || defined(__MINGW64__) || defined(_MSC_VER)
 #define LOG(level, prefix_content, level_str, fmt, ...)                                                              \
     do {                                                                                                             \
-        if (log_file && log_level >= level) {                                                                        \
+        if (log_file && LOG_ENABLED(level)) {                                                                        \
             SYSTEMTIME st = {0};                                                                                     \
             GetLocalTime(&st);                                                                                       \
             int pid = (int)GetCurrentProcessId();                                                                    \
@@ -196,25 +299,19 @@ extern FILE *log_file;
     } while (0)
 #endif
 #elif defined(__linux__) || defined(__QNX__) || defined(__ANDROID__)
-#include <pthread.h>
-#include <sys/syscall.h>
-#include <sys/time.h>
-#include <unistd.h>
+#include "log_time.h"
 #define LOG(level, prefix_content, level_str, fmt, args...)                                                           \
     do {                                                                                                              \
-        if (log_file && log_level >= level) {                                                                         \
-            struct timeval tv = {0};                                                                                  \
-            gettimeofday(&tv, NULL);                                                                                  \
-            time_t time = tv.tv_sec;                                                                                  \
-            struct tm *tm_info = localtime(&time);                                                                    \
-            int pid = (int)getpid();                                                                                  \
-            int tid = (int)syscall(SYS_gettid);                                                                       \
+        if (log_file && LOG_ENABLED(level)) {                                                                         \
+            log_time_t _lt_;                                                                                          \
+            log_time_now(&_lt_);                                                                                      \
             char _log_buf_[1024] = {0};                                                                               \
             if (prefix_content) {                                                                                     \
                 snprintf(_log_buf_, sizeof(_log_buf_), "%04d-%02d-%02d %02d:%02d:%02d.%06ld %s [%d.%d] %s %s:%d @%s", \
-                         tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,                              \
-                         tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec, tv.tv_usec,                              \
-                         __PROGNAME__, pid, tid, level_str, __FILENAME__, __LINE__, __FUNCTION__);                    \
+                         _lt_.tm.tm_year + 1900, _lt_.tm.tm_mon + 1, _lt_.tm.tm_mday,                                 \
+                         _lt_.tm.tm_hour, _lt_.tm.tm_min, _lt_.tm.tm_sec, _lt_.usec,                                  \
+                         __PROGNAME__, log_time_pid(), log_time_tid(),                                                \
+                         level_str, __FILENAME__, __LINE__, __FUNCTION__);                                            \
                 fprintf(log_file, "%-96s" fmt "\n", _log_buf_, ##args);                                               \
             } else {                                                                                                  \
                 fprintf(log_file, "%s" fmt "\n", _log_buf_, ##args);                                                  \
@@ -252,7 +349,7 @@ void __attribute__((destructor)) close_log_file(void);
 #if defined(__MINGW32__) || defined(__MINGW64__)
 #define LOG(level, color, prefix_content, fmt, ...)                                                               \
     do {                                                                                                          \
-        if (log_level >= level) {                                                                                 \
+        if (LOG_ENABLED(level)) {                                                                                 \
             SYSTEMTIME st = {0};                                                                                  \
             GetLocalTime(&st);                                                                                    \
             int pid = (int)GetCurrentProcessId();                                                                 \
@@ -272,7 +369,7 @@ void __attribute__((destructor)) close_log_file(void);
 #else
 #define LOG(level, color, prefix_content, fmt, ...)                                                               \
     do {                                                                                                          \
-        if (log_level >= level) {                                                                                 \
+        if (LOG_ENABLED(level)) {                                                                                 \
             SYSTEMTIME st = {0};                                                                                  \
             GetLocalTime(&st);                                                                                    \
             int pid = (int)GetCurrentProcessId();                                                                 \
@@ -292,25 +389,18 @@ void __attribute__((destructor)) close_log_file(void);
 #endif
 #else
 #if defined(__linux__) || defined(__QNX__) || defined(__ANDROID__)
-#include <pthread.h>
-#include <sys/syscall.h>
-#include <sys/time.h>
-#include <unistd.h>
+#include "log_time.h"
 #define LOG(level, color, prefix_content, fmt, args...)                                                            \
     do {                                                                                                           \
-        if (log_level >= level) {                                                                                  \
-            struct timeval tv = {0};                                                                               \
-            gettimeofday(&tv, NULL);                                                                               \
-            time_t time = tv.tv_sec;                                                                               \
-            struct tm *tm_info = localtime(&time);                                                                 \
-            int pid = (int)getpid();                                                                               \
-            int tid = (int)syscall(SYS_gettid);                                                                    \
+        if (LOG_ENABLED(level)) {                                                                                  \
+            log_time_t _lt_;                                                                                       \
+            log_time_now(&_lt_);                                                                                   \
             char _log_buf_[1024] = {0};                                                                            \
             if (prefix_content) {                                                                                  \
                 snprintf(_log_buf_, sizeof(_log_buf_), "%04d-%02d-%02d %02d:%02d:%02d.%06ld %s [%d.%d] %s:%d @%s", \
-                         tm_info->tm_year + 1900, tm_info->tm_mon + 1, tm_info->tm_mday,                           \
-                         tm_info->tm_hour, tm_info->tm_min, tm_info->tm_sec, tv.tv_usec,                           \
-                         __PROGNAME__, pid, tid, __FILENAME__, __LINE__, __FUNCTION__);                            \
+                         _lt_.tm.tm_year + 1900, _lt_.tm.tm_mon + 1, _lt_.tm.tm_mday,                              \
+                         _lt_.tm.tm_hour, _lt_.tm.tm_min, _lt_.tm.tm_sec, _lt_.usec,                               \
+                         __PROGNAME__, log_time_pid(), log_time_tid(), __FILENAME__, __LINE__, __FUNCTION__);      \
                 printf(color "%-96s" fmt "\e[0m\n", _log_buf_, ##args);                                            \
             } else {                                                                                               \
                 printf(color fmt "\e[0m\n", ##args);                                                               \
@@ -341,4 +431,159 @@ void __attribute__((destructor)) close_log_file(void);
 #endif
 #endif
 
+/*
+ * Rate limited logging for hot loops. Every call site keeps its own
+ * counters, updated with relaxed atomics, so a flooding site costs one or
+ * two atomic adds per call and no formatting. The number of messages held
+ * back is appended to the next line the site lets through:
+ *   LOGE_EVERY_N(100, ...)  the 1st, 101st, 201st ... call
+ *   LOGW_RATE(5, ...)       at most 5 lines per second
+ *   LOGI_FIRST_N(10, ...)   the first 10 calls, then nothing
+ * A site that goes quiet with messages held back does not wait for its next
+ * line: with runtime levels it registers itself on the first suppressed
+ * call, and log_rate_flush() logs "file:line suppressed N messages" once
+ * the count stopped moving for a second. The async writer calls it on its
+ * passes, the other backends from a thread log.c starts when it is loaded
+ * and joins when it is unloaded, so registering never creates a thread on
+ * the calling one.
+ */
+#if defined(_MSC_VER)
+#define LOG_ATOMIC_INC(p) ((unsigned long)_InterlockedIncrement((volatile long *)(p)) - 1)
+#define LOG_ATOMIC_XCHG(p, v) ((unsigned long)_InterlockedExchange((volatile long *)(p), (long)(v)))
+#define LOG_ATOMIC_LOAD(p) (*(volatile unsigned long *)(p))
+#define LOG_ATOMIC_CAS(p, expected, v) \
+    (_InterlockedCompareExchange((volatile long *)(p), (long)(v), (long)(expected)) == (long)(expected))
+static __inline unsigned long log_now_sec(void)
+{
+    return (unsigned long)(GetTickCount64() / 1000);
+}
+#else
+#define LOG_ATOMIC_INC(p) __atomic_fetch_add((p), 1UL, __ATOMIC_RELAXED)
+#define LOG_ATOMIC_XCHG(p, v) __atomic_exchange_n((p), (v), __ATOMIC_RELAXED)
+#define LOG_ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define LOG_ATOMIC_CAS(p, expected, v) \
+    __extension__({ unsigned long _e_ = (expected); __atomic_compare_exchange_n((p), &_e_, (v), 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED); })
+#if defined(_WIN32) || defined(_WIN64)
+static inline unsigned long log_now_sec(void)
+{
+    return (unsigned long)(GetTickCount64() / 1000);
+}
+#else
+static inline unsigned long log_now_sec(void)
+{
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC_COARSE)
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts); // a second resolution is all the window needs
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (unsigned long)ts.tv_sec;
+}
+#endif
+#endif
+
+typedef struct log_rate_site {
+    unsigned long window;     // LOG_RATE: second of the current window
+    unsigned long count;      // LOG_RATE: lines in the window, LOG_EVERY_N: calls
+    unsigned long suppressed; // held back since the last line or summary
+    unsigned long registered;
+    unsigned long seen; // log_rate_flush() only
+    const char *file;
+    int line;
+    int level;
+    const void *module; // log_module_t of the file, NULL without runtime levels
+} log_rate_site_t;
+
+#if USE_RUNTIME_LOG_LEVEL
+#ifdef __cplusplus
+extern "C" {
+#endif
+void log_rate_register(log_rate_site_t *site);
+void log_rate_flush(void);
+#ifdef __cplusplus
+}
+#endif
+#define LOG_RATE_SITE(level) {0, 0, 0, 0, 0, __FILE__, __LINE__, level, &log_module_}
+#define LOG_RATE_REGISTER(site)                      \
+    do {                                             \
+        if (!LOG_ATOMIC_LOAD(&(site)->registered)) { \
+            log_rate_register(site);                 \
+        }                                            \
+    } while (0)
+#else
+#define LOG_RATE_SITE(level) {0, 0, 0, 0, 0, __FILE__, __LINE__, level, NULL}
+#define LOG_RATE_REGISTER(site) ((void)0)
+#endif
+
+#define LOG_EVERY_N(level, LOGX, n, fmt, ...)                                                       \
+    do {                                                                                            \
+        if (LOG_ENABLED(level)) {                                                                   \
+            static log_rate_site_t _log_rate_ = LOG_RATE_SITE(level);                               \
+            unsigned long _c_ = LOG_ATOMIC_INC(&_log_rate_.count);                                  \
+            if (_c_ % (unsigned long)(n) == 0) {                                                    \
+                unsigned long _s_ = LOG_ATOMIC_XCHG(&_log_rate_.suppressed, 0UL);                   \
+                if (_s_) {                                                                          \
+                    LOGX(fmt " (suppressed %lu messages)", ##__VA_ARGS__, _s_);                     \
+                } else {                                                                            \
+                    LOGX(fmt, ##__VA_ARGS__);                                                       \
+                }                                                                                   \
+            } else {                                                                                \
+                LOG_ATOMIC_INC(&_log_rate_.suppressed);                                             \
+                LOG_RATE_REGISTER(&_log_rate_);                                                     \
+            }                                                                                       \
+        }                                                                                           \
+    } while (0)
+
+#define LOG_RATE(level, LOGX, per_sec, fmt, ...)                                                    \
+    do {                                                                                            \
+        if (LOG_ENABLED(level)) {                                                                   \
+            static log_rate_site_t _log_rate_ = LOG_RATE_SITE(level);                               \
+            unsigned long _now_ = log_now_sec();                                                    \
+            unsigned long _w_ = LOG_ATOMIC_LOAD(&_log_rate_.window);                                \
+            if (_now_ != _w_ && LOG_ATOMIC_CAS(&_log_rate_.window, _w_, _now_)) {                   \
+                LOG_ATOMIC_XCHG(&_log_rate_.count, 0UL);                                            \
+            }                                                                                       \
+            if (LOG_ATOMIC_INC(&_log_rate_.count) < (unsigned long)(per_sec)) {                     \
+                unsigned long _s_ = LOG_ATOMIC_XCHG(&_log_rate_.suppressed, 0UL);                   \
+                if (_s_) {                                                                          \
+                    LOGX(fmt " (suppressed %lu messages)", ##__VA_ARGS__, _s_);                     \
+                } else {                                                                            \
+                    LOGX(fmt, ##__VA_ARGS__);                                                       \
+                }                                                                                   \
+            } else {                                                                                \
+                LOG_ATOMIC_INC(&_log_rate_.suppressed);                                             \
+                LOG_RATE_REGISTER(&_log_rate_);                                                     \
+            }                                                                                       \
+        }                                                                                           \
+    } while (0)
+
+#define LOG_FIRST_N(level, LOGX, n, fmt, ...)                                                       \
+    do {                                                                                            \
+        if (LOG_ENABLED(level)) {                                                                   \
+            static unsigned long _log_calls_ = 0;                                                   \
+            if (LOG_ATOMIC_LOAD(&_log_calls_) < (unsigned long)(n)) {                               \
+                unsigned long _c_ = LOG_ATOMIC_INC(&_log_calls_);                                   \
+                if (_c_ + 1 == (unsigned long)(n)) {                                                \
+                    LOGX(fmt " (limit of %lu reached, suppressing the rest)", ##__VA_ARGS__,        \
+                         (unsigned long)(n));                                                       \
+                } else if (_c_ < (unsigned long)(n)) {                                              \
+                    LOGX(fmt, ##__VA_ARGS__);                                                       \
+                }                                                                                   \
+            }                                                                                       \
+        }                                                                                           \
+    } while (0)
+
+#define LOGD_EVERY_N(n, fmt, ...) LOG_EVERY_N(LOG_LEVEL_DEBUG, LOGD, n, fmt, ##__VA_ARGS__)
+#define LOGI_EVERY_N(n, fmt, ...) LOG_EVERY_N(LOG_LEVEL_INFO, LOGI, n, fmt, ##__VA_ARGS__)
+#define LOGW_EVERY_N(n, fmt, ...) LOG_EVERY_N(LOG_LEVEL_WARNING, LOGW, n, fmt, ##__VA_ARGS__)
+#define LOGE_EVERY_N(n, fmt, ...) LOG_EVERY_N(LOG_LEVEL_ERROR, LOGE, n, fmt, ##__VA_ARGS__)
+#define LOGD_RATE(per_sec, fmt, ...) LOG_RATE(LOG_LEVEL_DEBUG, LOGD, per_sec, fmt, ##__VA_ARGS__)
+#define LOGI_RATE(per_sec, fmt, ...) LOG_RATE(LOG_LEVEL_INFO, LOGI, per_sec, fmt, ##__VA_ARGS__)
+#define LOGW_RATE(per_sec, fmt, ...) LOG_RATE(LOG_LEVEL_WARNING, LOGW, per_sec, fmt, ##__VA_ARGS__)
+#define LOGE_RATE(per_sec, fmt, ...) LOG_RATE(LOG_LEVEL_ERROR, LOGE, per_sec, fmt, ##__VA_ARGS__)
+#define LOGD_FIRST_N(n, fmt, ...) LOG_FIRST_N(LOG_LEVEL_DEBUG, LOGD, n, fmt, ##__VA_ARGS__)
+#define LOGI_FIRST_N(n, fmt, ...) LOG_FIRST_N(LOG_LEVEL_INFO, LOGI, n, fmt, ##__VA_ARGS__)
+#define LOGW_FIRST_N(n, fmt, ...) LOG_FIRST_N(LOG_LEVEL_WARNING, LOGW, n, fmt, ##__VA_ARGS__)
+#define LOGE_FIRST_N(n, fmt, ...) LOG_FIRST_N(LOG_LEVEL_ERROR, LOGE, n, fmt, ##__VA_ARGS__)
+
 #endif // _LOG_H
@@ -0,0 +1,1377 @@
+/***************************************************************************
+ * Description: asynchronous log backend
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 14:05:12
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * Every logging thread owns one ring from a fixed pool and is the only
+ * producer on it, the writer thread is the only consumer. The hot path is
+ * a vsnprintf into the ring slot and a release store of the head, no lock
+ * and no I/O. The writer drains all rings, builds the line prefix, and hands
+ * the batch to the sinks with one write(2) per batch for the file. When a
+ * ring is full the new line is dropped and counted on that ring, the writer
+ * reports the count in the log as soon as there is room again.
+ *
+ * A producer never takes a lock to wake the writer, it writes to an eventfd
+ * (a pipe where there is none) that the writer polls between passes. The
+ * file and function names in a record are interned copies, a plugin can be
+ * dlclosed while its lines are still queued.
+ *
+ * Binary records from log_bin_write skip the vsnprintf as well, and point at
+ * a registered copy of the call site instead of the caller's static. The writer
+ * formats them for the text sinks, or appends them untouched to the binary
+ * file together with a site record the first time a call site shows up.
+ *
+ * The writer also rotates both files once they pass the size limit. The
+ * live file is renamed with the time of rotation, the same naming as the
+ * startup rotation in log.c, and the oldest rotated files beyond the keep
+ * count are removed. Compression is handed to a gzip child that the writer
+ * reaps later without waiting on it.
+ *
+ * A fatal signal would lose exactly the lines leading up to the crash, so
+ * the crash handler writes the writer's unflushed batch and whatever is
+ * left in the rings straight to the files before the process goes down. It
+ * may not lock, allocate or call stdio, so it formats the lines itself,
+ * with the UTC offset the writer last saw, and it writes every binary
+ * record together with its site record. Once the handler started, the
+ * writer stops writing and handing slots back and producers stop
+ * reserving, so the handler reads committed records nobody refills. A line
+ * caught halfway can still show up twice. Every logging thread gets a
+ * signal stack, so this also works after a stack overflow.
+ */
+
+#include "log.h"
+#include "log_async.h"
+#include "log_time.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <syslog.h>
+#endif
+#if defined(__ANDROID__)
+#include <android/log.h>
+#endif
+
+#define RING_FREE 0
+#define RING_OWNED 1
+#define RING_ORPHANED 2 // owner exited, writer drains it and frees it
+#define BATCH_SIZE 65536
+#define HEAD_NAME_MAX 96 // longest file or func name kept in a text line prefix
+
+typedef struct log_async_ring {
+    uint32_t head; // written by the owner thread only
+    char pad0[60];
+    uint32_t tail; // written by the writer thread only
+    char pad1[60];
+    uint32_t state;
+    int tid;
+    uint64_t dropped;
+    uint64_t dropped_reported;
+    char *slots;
+    char *altstack; // signal stack of the owner thread, kept with the ring for the next owner
+} log_async_ring_t;
+
+static log_async_ring_t rings[LOG_ASYNC_MAX_THREADS];
+static uint64_t unowned_dropped; // lines from threads that found the pool empty
+static uint64_t unowned_reported;
+
+static __thread log_async_ring_t *tls_ring;
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+
+static pthread_t writer_thread;
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER; // flush and stop only, never a producer
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER;
+static int writer_running;
+static uint64_t flush_requested;
+static uint64_t flush_done;
+// read end and write end, the same eventfd on Linux. Opened once and never
+// closed, a producer may still be writing to it while the writer stops.
+static int wake_fds[2] = {-1, -1};
+#if defined(__linux__)
+#define WAKE_SIZE sizeof(uint64_t)
+#else
+#define WAKE_SIZE 1
+#endif
+
+// copies of file and function names, they outlive the library that logged them
+#define INTERN_SLOTS 4096 // power of two
+#define INTERN_ARENA_SIZE 262144
+static const char *intern_slots[INTERN_SLOTS];
+static char intern_arena[INTERN_ARENA_SIZE];
+static uint32_t intern_used;
+
+// registered binary call sites, found again by their interned text
+#define SITE_SLOTS (LOG_BIN_MAX_SITES * 2) // power of two
+static log_bin_site_t site_pool[LOG_BIN_MAX_SITES];
+static uint32_t site_used;
+static log_bin_site_t *site_slots[SITE_SLOTS];
+
+#define MAX_COMPRESS_JOBS 4
+
+extern char **environ;
+
+static int sink_mask;
+static int log_fd = -1;
+static char log_name[256];
+static long log_size;
+static char batch[BATCH_SIZE];
+static int batch_len;
+static int bin_fd = -1;
+static char bin_name[256];
+static long bin_size;
+static char bin_batch[BATCH_SIZE];
+static int bin_len;
+static uint32_t bin_generation; // bumped per session so every site is described again in a new file
+static int bin_header_pending;   // written by the writer together with the first record
+
+static long rotate_size = LOG_ASYNC_MAX_FILE_SIZE;
+static int rotate_keep = LOG_ASYNC_KEEP_FILES;
+static int rotate_compress = LOG_ASYNC_COMPRESS;
+static pid_t compress_jobs[MAX_COMPRESS_JOBS];
+static int cleanup_pending; // old files are counted once no gzip is halfway through one
+
+static char prog_name[256]; // copied at start, log.c frees __PROGNAME__ in its own destructor
+static int crash_flushing;
+static long crash_gmtoff; // local time offset for the crash handler, localtime_r is not signal safe
+
+#define CRASH_STACK_SIZE 65536
+
+/* The crash handler runs with SA_ONSTACK, so a stack overflow in a logging
+ * thread still gets its lines out. A thread that set up its own signal
+ * stack keeps it. */
+static void altstack_install(log_async_ring_t *ring)
+{
+#if LOG_ASYNC_CRASH_FLUSH
+    stack_t current;
+    if (sigaltstack(NULL, &current) != 0 || !(current.ss_flags & SS_DISABLE)) {
+        return;
+    }
+    if (ring->altstack == NULL) {
+        ring->altstack = (char *)malloc(CRASH_STACK_SIZE);
+        if (ring->altstack == NULL) {
+            return;
+        }
+    }
+    stack_t stack;
+    memset(&stack, 0, sizeof(stack));
+    stack.ss_sp = ring->altstack;
+    stack.ss_size = CRASH_STACK_SIZE;
+    sigaltstack(&stack, NULL);
+#else
+    (void)ring;
+#endif
+}
+
+// runs on the exiting thread, the next owner of the ring reuses the memory
+static void altstack_remove(log_async_ring_t *ring)
+{
+#if LOG_ASYNC_CRASH_FLUSH
+    stack_t current;
+    if (ring->altstack && sigaltstack(NULL, &current) == 0 && current.ss_sp == ring->altstack) {
+        stack_t stack;
+        memset(&stack, 0, sizeof(stack));
+        stack.ss_flags = SS_DISABLE;
+        sigaltstack(&stack, NULL);
+    }
+#else
+    (void)ring;
+#endif
+}
+
+static void ring_release(void *arg)
+{
+    log_async_ring_t *ring = (log_async_ring_t *)arg;
+    altstack_remove(ring);
+    __atomic_store_n(&ring->state, RING_ORPHANED, __ATOMIC_RELEASE);
+}
+
+static void ring_key_create(void)
+{
+    pthread_key_create(&ring_key, ring_release);
+}
+
+static log_async_ring_t *ring_claim(void)
+{
+    pthread_once(&ring_key_once, ring_key_create);
+    for (int i = 0; i < LOG_ASYNC_MAX_THREADS; i++) {
+        log_async_ring_t *ring = &rings[i];
+        uint32_t expected = RING_FREE;
+        if (!__atomic_compare_exchange_n(&ring->state, &expected, RING_OWNED, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        if (ring->slots == NULL) {
+            ring->slots = (char *)calloc(LOG_ASYNC_RING_SLOTS, LOG_ASYNC_SLOT_SIZE);
+            if (ring->slots == NULL) {
+                __atomic_store_n(&ring->state, RING_FREE, __ATOMIC_RELEASE);
+                return NULL;
+            }
+        }
+        ring->tid = log_time_tid();
+        altstack_install(ring);
+        pthread_setspecific(ring_key, ring);
+        return ring;
+    }
+    return NULL;
+}
+
+static void wake_open(void)
+{
+    if (wake_fds[0] >= 0) {
+        return;
+    }
+#if defined(__linux__)
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "log_async: eventfd failed: %s\n", strerror(errno));
+        return;
+    }
+    wake_fds[0] = wake_fds[1] = fd;
+#else
+    if (pipe(wake_fds) != 0) {
+        fprintf(stderr, "log_async: pipe failed: %s\n", strerror(errno));
+        wake_fds[0] = wake_fds[1] = -1;
+        return;
+    }
+    for (int i = 0; i < 2; i++) {
+        fcntl(wake_fds[i], F_SETFL, fcntl(wake_fds[i], F_GETFL) | O_NONBLOCK);
+        fcntl(wake_fds[i], F_SETFD, FD_CLOEXEC);
+    }
+#endif
+}
+
+// one non-blocking write, a full counter or pipe means a wakeup is pending anyway
+static void wake_writer(void)
+{
+    uint64_t one = 1;
+    ssize_t n = write(wake_fds[1], &one, WAKE_SIZE);
+    (void)n;
+}
+
+// without a wake fd poll() just sleeps, the writer still runs every LOG_ASYNC_FLUSH_MS
+static void wait_wakeup(int timeout_ms)
+{
+    struct pollfd pfd;
+    pfd.fd = wake_fds[0];
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN)) {
+        uint64_t drain[8];
+        while (read(wake_fds[0], drain, sizeof(drain)) > 0) {
+        }
+    }
+}
+
+/*
+ * Lock free: the first caller copies the string into the arena and
+ * publishes it with a CAS on an empty slot, racing callers of the same
+ * string may each copy it once. Lookups hash and compare the text, not the
+ * pointer, a library loaded later can reuse an address with other content.
+ */
+const char *log_async_intern(const char *s)
+{
+    if (s == NULL) {
+        return NULL;
+    }
+    uint32_t hash = 2166136261u;
+    size_t len = 0;
+    for (; s[len]; len++) {
+        hash = (hash ^ (uint8_t)s[len]) * 16777619u;
+    }
+    char *copy = NULL;
+    for (uint32_t i = 0; i < INTERN_SLOTS; i++) {
+        const char **slot = &intern_slots[(hash + i) & (INTERN_SLOTS - 1)];
+        const char *found = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+        while (found == NULL) {
+            if (copy == NULL) {
+                if (__atomic_load_n(&intern_used, __ATOMIC_RELAXED) + len + 1 > INTERN_ARENA_SIZE) {
+                    return "?";
+                }
+                uint32_t off = __atomic_fetch_add(&intern_used, (uint32_t)(len + 1), __ATOMIC_RELAXED);
+                if (off + len + 1 > INTERN_ARENA_SIZE) {
+                    return "?";
+                }
+                copy = (char *)memcpy(intern_arena + off, s, len + 1);
+            }
+            if (__atomic_compare_exchange_n(slot, &found, copy, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                return copy;
+            }
+        }
+        if (strcmp(found, s) == 0) {
+            return found;
+        }
+    }
+    return copy ? copy : "?";
+}
+
+log_async_record_t *log_async_reserve(void)
+{
+    log_async_ring_t *ring = tls_ring;
+    if (__builtin_expect(ring == NULL, 0)) {
+        ring = tls_ring = ring_claim();
+        if (ring == NULL) {
+            __atomic_fetch_add(&unowned_dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    }
+    if (__builtin_expect(__atomic_load_n(&crash_flushing, __ATOMIC_RELAXED), 0)) {
+        return NULL; // the crash handler is reading the rings
+    }
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= LOG_ASYNC_RING_SLOTS) {
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    return (log_async_record_t *)(ring->slots + (size_t)(head & (LOG_ASYNC_RING_SLOTS - 1)) * LOG_ASYNC_SLOT_SIZE);
+}
+
+void log_async_commit(log_async_record_t *record)
+{
+    (void)record;
+    log_async_ring_t *ring = tls_ring;
+    uint32_t head = ring->head + 1;
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+    // only pay for the wakeup when the ring is filling up, otherwise the
+    // writer picks the line up on its next periodic pass
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED) == LOG_ASYNC_RING_SLOTS * 3 / 4) {
+        wake_writer();
+    }
+}
+
+static void write_text(const char *file, const char *func, int line, int level, int prefix, const char *fmt,
+                       va_list args)
+{
+    log_async_record_t *record = log_async_reserve();
+    if (record == NULL) {
+        return;
+    }
+    record->time_ns = log_time_wall_ns();
+    record->file = file;
+    record->func = func;
+    record->line = line;
+    record->level = (uint16_t)level;
+    record->prefix = (uint8_t)prefix;
+    record->kind = LOG_ASYNC_KIND_TEXT;
+    record->site = NULL;
+
+    int len = vsnprintf(record->data, LOG_ASYNC_DATA_SIZE, fmt, args);
+    if (len < 0) {
+        len = 0;
+    } else if (len >= LOG_ASYNC_DATA_SIZE) {
+        len = LOG_ASYNC_DATA_SIZE - 1;
+    }
+    record->len = (uint16_t)len;
+    log_async_commit(record);
+}
+
+void log_async_write(int level, int prefix, const char *file, int line, const char *func, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    write_text(log_async_intern(file), log_async_intern(func), line, level, prefix, fmt, args);
+    va_end(args);
+}
+
+// interns once per call site like log_bin_write(), later lines only load the cached pointers
+void log_async_write_site(log_async_site_t *site, int level, int prefix, const char *fmt, ...)
+{
+    const char *func = __atomic_load_n(&site->interned_func, __ATOMIC_ACQUIRE);
+    const char *file;
+    if (__builtin_expect(func == NULL, 0)) {
+        file = log_async_intern(site->file);
+        func = log_async_intern(site->func);
+        __atomic_store_n(&site->interned_file, file, __ATOMIC_RELAXED);
+        __atomic_store_n(&site->interned_func, func, __ATOMIC_RELEASE); // publishes interned_file too
+    } else {
+        file = __atomic_load_n(&site->interned_file, __ATOMIC_RELAXED);
+    }
+    va_list args;
+    va_start(args, fmt);
+    write_text(file, func, site->line, level, prefix, fmt, args);
+    va_end(args);
+}
+
+static int site_same(const log_bin_site_t *a, const log_bin_site_t *b)
+{
+    // interned strings compare by pointer
+    return a->fmt == b->fmt && a->file == b->file && a->func == b->func && a->line == b->line &&
+           a->level == b->level && a->prefix == b->prefix;
+}
+
+// same scheme as log_async_intern(), racing first calls may each fill a pool entry
+static const log_bin_site_t *site_register(const log_bin_site_t *site)
+{
+    log_bin_site_t key;
+    memset(&key, 0, sizeof(key));
+    key.fmt = log_async_intern(site->fmt);
+    key.file = log_async_intern(site->file);
+    key.func = log_async_intern(site->func);
+    key.line = site->line;
+    key.level = site->level;
+    key.prefix = site->prefix;
+    uint64_t hash = ((uintptr_t)key.fmt ^ ((uintptr_t)key.file << 7) ^ (uint64_t)key.line) * 0x9e3779b97f4a7c15ULL;
+    log_bin_site_t *entry = NULL;
+    for (uint32_t i = 0; i < SITE_SLOTS; i++) {
+        log_bin_site_t **slot = &site_slots[((uint32_t)(hash >> 40) + i) & (SITE_SLOTS - 1)];
+        log_bin_site_t *found = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+        while (found == NULL) {
+            if (entry == NULL) {
+                uint32_t index = __atomic_fetch_add(&site_used, 1, __ATOMIC_RELAXED);
+                if (index >= LOG_BIN_MAX_SITES) {
+                    return NULL;
+                }
+                entry = &site_pool[index];
+                *entry = key;
+                entry->nargs = log_bin_parse(entry->fmt, entry->kinds, LOG_BIN_MAX_ARGS);
+            }
+            if (__atomic_compare_exchange_n(slot, &found, entry, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                return entry;
+            }
+        }
+        if (site_same(found, &key)) {
+            return found;
+        }
+    }
+    return NULL;
+}
+
+void log_bin_write(log_bin_site_t *site, ...)
+{
+    const log_bin_site_t *copy = __atomic_load_n(&site->registered, __ATOMIC_ACQUIRE);
+    if (__builtin_expect(copy == NULL, 0)) {
+        copy = site_register(site);
+        if (copy == NULL) {
+            __atomic_fetch_add(&unowned_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        __atomic_store_n(&site->registered, copy, __ATOMIC_RELEASE);
+    }
+    log_async_record_t *record = log_async_reserve();
+    if (record == NULL) {
+        return;
+    }
+    record->time_ns = log_time_wall_ns();
+    record->file = copy->file;
+    record->func = copy->func;
+    record->line = copy->line;
+    record->level = (uint16_t)copy->level;
+    record->prefix = (uint8_t)copy->prefix;
+    record->kind = LOG_ASYNC_KIND_BINARY;
+    record->site = copy;
+
+    va_list args;
+    va_start(args, site);
+    record->len = (uint16_t)log_bin_pack(copy->kinds, copy->nargs, args, record->data, LOG_ASYNC_DATA_SIZE);
+    va_end(args);
+    log_async_commit(record);
+}
+
+static const char *level_name(int level)
+{
+    switch (level) {
+    case LOG_LEVEL_ERROR:
+        return "ERROR";
+    case LOG_LEVEL_WARNING:
+        return "WARN";
+    case LOG_LEVEL_INFO:
+        return "INFO";
+    default:
+        return "DEBUG";
+    }
+}
+
+static void write_all(int fd, const char *buf, int len)
+{
+    int off = 0;
+    while (off < len) {
+        ssize_t n = write(fd, buf + off, len - off);
+        if (n <= 0) {
+            break;
+        }
+        off += (int)n;
+    }
+}
+
+static void batch_flush(void)
+{
+    if (__atomic_load_n(&crash_flushing, __ATOMIC_RELAXED)) {
+        // the crash handler owns the files now
+        bin_len = 0;
+        batch_len = 0;
+        return;
+    }
+    if (bin_fd >= 0 && bin_len > 0) {
+        write_all(bin_fd, bin_batch, bin_len);
+        bin_size += bin_len;
+    }
+    bin_len = 0;
+    if (log_fd >= 0 && batch_len > 0) {
+        write_all(log_fd, batch, batch_len);
+        log_size += batch_len;
+    }
+    if ((sink_mask & LOG_ASYNC_SINK_STDOUT) && batch_len > 0) {
+        write_all(STDOUT_FILENO, batch, batch_len);
+    }
+    batch_len = 0;
+}
+
+static int open_log(const char *name, long *size)
+{
+    struct stat st;
+    int fd = open(name, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "log_async: open %s failed: %s\n", name, strerror(errno));
+        return -1;
+    }
+    *size = fstat(fd, &st) == 0 ? (long)st.st_size : 0;
+    return fd;
+}
+
+// returns how many jobs are still running
+static int reap_compress_jobs(int wait)
+{
+    int running = 0;
+    for (int i = 0; i < MAX_COMPRESS_JOBS; i++) {
+        if (compress_jobs[i] > 0 && waitpid(compress_jobs[i], NULL, wait ? 0 : WNOHANG) != 0) {
+            compress_jobs[i] = 0;
+        }
+        running += compress_jobs[i] > 0;
+    }
+    return running;
+}
+
+static void start_compress(const char *path)
+{
+    for (int i = 0; i < MAX_COMPRESS_JOBS; i++) {
+        if (compress_jobs[i] == 0) {
+            char *argv[] = {(char *)"gzip", (char *)"-f", (char *)path, NULL};
+            pid_t pid = 0;
+            if (posix_spawnp(&pid, "gzip", NULL, NULL, argv, environ) == 0) {
+                compress_jobs[i] = pid;
+            }
+            return;
+        }
+    }
+    // all slots busy, this file simply stays uncompressed
+}
+
+static int name_compare(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+// rotated names embed the time, so name order is age order
+static void remove_old_files(const char *name, int keep)
+{
+    char dir[256] = ".";
+    const char *base = strrchr(name, '/');
+    if (base) {
+        snprintf(dir, sizeof(dir), "%.*s", (int)(base - name), name);
+        base++;
+    } else {
+        base = name;
+    }
+    size_t base_len = strlen(base);
+    DIR *d = opendir(dir);
+    if (d == NULL) {
+        return;
+    }
+    char *found[256];
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL && count < (int)(sizeof(found) / sizeof(found[0]))) {
+        if (strncmp(entry->d_name, base, base_len) == 0 && entry->d_name[base_len] == '.' &&
+            entry->d_name[base_len + 1] >= '0' && entry->d_name[base_len + 1] <= '9') {
+            found[count] = strdup(entry->d_name);
+            if (found[count]) {
+                count++;
+            }
+        }
+    }
+    closedir(d);
+    qsort(found, count, sizeof(found[0]), name_compare);
+    for (int i = 0; i < count; i++) {
+        if (i < count - keep) {
+            char path[600];
+            snprintf(path, sizeof(path), "%s/%s", dir, found[i]);
+            unlink(path);
+        }
+        free(found[i]);
+    }
+}
+
+static void rotate_file(int *fd, const char *name, long *size)
+{
+    char stamp[32];
+    char rotated[512];
+    struct tm tm_info;
+    time_t now = time(NULL);
+    const char *ext = strrchr(name, '.');
+    if (ext == NULL || strchr(ext, '/')) {
+        ext = "";
+    }
+    localtime_r(&now, &tm_info);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d_%H-%M-%S", &tm_info);
+    // more than one rotation in a second gets a sequence number, '_' keeps it sorted after the first.
+    // It only counts up within the second, a name freed by the cleanup must not be reused.
+    static char last_stamp[32];
+    static int seq;
+    seq = strcmp(stamp, last_stamp) == 0 ? seq + 1 : 0;
+    snprintf(last_stamp, sizeof(last_stamp), "%s", stamp);
+    for (; seq < 100; seq++) {
+        char gz[520];
+        if (seq == 0) {
+            snprintf(rotated, sizeof(rotated), "%s.%s%s", name, stamp, ext);
+        } else {
+            snprintf(rotated, sizeof(rotated), "%s.%s_%02d%s", name, stamp, seq, ext);
+        }
+        snprintf(gz, sizeof(gz), "%s.gz", rotated);
+        if (access(rotated, F_OK) != 0 && access(gz, F_OK) != 0) {
+            break;
+        }
+    }
+
+    close(*fd);
+    if (rename(name, rotated) != 0) {
+        fprintf(stderr, "log_async: rename %s failed: %s\n", name, strerror(errno));
+    } else if (__atomic_load_n(&rotate_compress, __ATOMIC_RELAXED)) {
+        start_compress(rotated);
+    }
+    *fd = open_log(name, size);
+    cleanup_pending = 1;
+}
+
+static void cleanup_rotated(void)
+{
+    int keep = __atomic_load_n(&rotate_keep, __ATOMIC_RELAXED);
+    if (log_name[0]) {
+        remove_old_files(log_name, keep);
+    }
+    if (bin_name[0]) {
+        remove_old_files(bin_name, keep);
+    }
+    cleanup_pending = 0;
+}
+
+static void check_rotation(void)
+{
+    long limit = __atomic_load_n(&rotate_size, __ATOMIC_RELAXED);
+    if (reap_compress_jobs(0) == 0 && cleanup_pending) {
+        cleanup_rotated();
+    }
+    if (limit <= 0) {
+        return;
+    }
+    if (log_fd >= 0 && log_size >= limit) {
+        rotate_file(&log_fd, log_name, &log_size);
+    }
+    if (bin_fd >= 0 && bin_size >= limit) {
+        rotate_file(&bin_fd, bin_name, &bin_size);
+        // site ids only mean something after their site record, start the new file from scratch
+        bin_generation++;
+        bin_header_pending = 1;
+    }
+}
+
+void log_async_set_rotation(long max_size, int keep_files, int compress)
+{
+    __atomic_store_n(&rotate_size, max_size, __ATOMIC_RELAXED);
+    __atomic_store_n(&rotate_keep, keep_files > 0 ? keep_files : 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&rotate_compress, compress, __ATOMIC_RELAXED);
+}
+
+static void emit_system(int level, const char *text)
+{
+#if defined(__linux__) && !defined(__ANDROID__)
+    if (sink_mask & LOG_ASYNC_SINK_SYSLOG) {
+        int priority = level == LOG_LEVEL_ERROR ? LOG_ERR : level == LOG_LEVEL_WARNING ? LOG_WARNING
+                                                        : level == LOG_LEVEL_INFO      ? LOG_INFO
+                                                                                       : LOG_DEBUG;
+        syslog(priority, "%s", text);
+    }
+#endif
+#if defined(__ANDROID__)
+    if (sink_mask & LOG_ASYNC_SINK_LOGCAT) {
+        int priority = level == LOG_LEVEL_ERROR ? ANDROID_LOG_ERROR : level == LOG_LEVEL_WARNING ? ANDROID_LOG_WARN
+                                                                  : level == LOG_LEVEL_INFO      ? ANDROID_LOG_INFO
+                                                                                                 : ANDROID_LOG_DEBUG;
+        __android_log_write(priority, "young", text);
+    }
+#endif
+    (void)level;
+    (void)text;
+}
+
+static void bin_put(const void *data, int len)
+{
+    if (bin_len + len > BATCH_SIZE) {
+        batch_flush();
+    }
+    memcpy(bin_batch + bin_len, data, len);
+    bin_len += len;
+}
+
+static void bin_put_str(const char *s, int len)
+{
+    uint16_t n = (uint16_t)(len < 0 ? (s ? strlen(s) : 0) : (size_t)len);
+    bin_put(&n, sizeof(n));
+    bin_put(s, n);
+}
+
+static void bin_put_header(void)
+{
+    uint8_t type = LOG_BIN_REC_HEADER;
+    uint32_t magic = LOG_BIN_FILE_MAGIC;
+    uint32_t version = LOG_BIN_FILE_VERSION;
+    int32_t pid = (int32_t)getpid();
+    bin_put(&type, sizeof(type));
+    bin_put(&magic, sizeof(magic));
+    bin_put(&version, sizeof(version));
+    bin_put(&pid, sizeof(pid));
+    bin_put_str(prog_name, -1);
+}
+
+// the header goes in with the first record
+static void bin_put_pending_header(void)
+{
+    if (bin_header_pending) {
+        bin_put_header();
+        bin_header_pending = 0;
+    }
+}
+
+static void bin_put_record(int tid, const log_async_record_t *record)
+{
+    bin_put_pending_header();
+    const log_bin_site_t *site = record->site;
+    uint64_t id = (uint64_t)(uintptr_t)site;
+    uint8_t type;
+    if (site->emitted != bin_generation) {
+        uint16_t level = (uint16_t)site->level;
+        uint8_t prefix = (uint8_t)site->prefix;
+        int32_t line = site->line;
+        type = LOG_BIN_REC_SITE;
+        bin_put(&type, sizeof(type));
+        bin_put(&id, sizeof(id));
+        bin_put(&level, sizeof(level));
+        bin_put(&prefix, sizeof(prefix));
+        bin_put(&line, sizeof(line));
+        bin_put_str(site->file, -1);
+        bin_put_str(site->func, -1);
+        bin_put_str(site->fmt, -1);
+        ((log_bin_site_t *)site)->emitted = bin_generation; // only the writer touches it on the registered copy
+    }
+    int32_t tid32 = tid;
+    uint16_t len = record->len;
+    type = LOG_BIN_REC_DATA;
+    bin_put(&type, sizeof(type));
+    bin_put(&id, sizeof(id));
+    bin_put(&record->time_ns, sizeof(record->time_ns));
+    bin_put(&tid32, sizeof(tid32));
+    bin_put(&len, sizeof(len));
+    bin_put(record->data, len);
+}
+
+static void bin_put_text(int tid, int level, int prefix, uint64_t time_ns, const char *file, int line,
+                         const char *func, const char *msg, int msg_len)
+{
+    uint8_t type = LOG_BIN_REC_TEXT;
+    int32_t tid32 = tid;
+    uint16_t level16 = (uint16_t)level;
+    uint8_t prefix8 = (uint8_t)prefix;
+    int32_t line32 = line;
+    bin_put_pending_header();
+    bin_put(&type, sizeof(type));
+    bin_put(&time_ns, sizeof(time_ns));
+    bin_put(&tid32, sizeof(tid32));
+    bin_put(&level16, sizeof(level16));
+    bin_put(&prefix8, sizeof(prefix8));
+    bin_put(&line32, sizeof(line32));
+    bin_put_str(file, -1);
+    bin_put_str(func, -1);
+    bin_put_str(msg, msg_len);
+}
+
+// formats one line into the batch, the calendar time is only rebuilt when the second changes
+static void emit_line(int tid, int level, int prefix, uint64_t time_ns, const char *file, int line,
+                      const char *func, const char *msg, int msg_len)
+{
+    static time_t cached_sec = -1;
+    static struct tm cached_tm;
+    // file and func are capped, so prog_name plus the fixed fields always fit
+    char head[sizeof(prog_name) + 2 * HEAD_NAME_MAX + 96];
+    char system_line[LOG_ASYNC_SLOT_SIZE + 256];
+    int head_len = 0;
+
+    if (batch_len + (int)sizeof(head) + msg_len + 2 > BATCH_SIZE) {
+        batch_flush();
+    }
+    const char *name = file ? (strrchr(file, '/') ? strrchr(file, '/') + 1 : file) : "";
+    if (prefix) {
+        time_t sec = (time_t)(time_ns / 1000000000ULL);
+        if (sec != cached_sec) {
+            localtime_r(&sec, &cached_tm);
+            cached_sec = sec;
+            __atomic_store_n(&crash_gmtoff, (long)cached_tm.tm_gmtoff, __ATOMIC_RELAXED);
+        }
+        head_len = snprintf(head, sizeof(head), "%04d-%02d-%02d %02d:%02d:%02d.%06ld %s [%d.%d] %s %.*s:%d @%.*s",
+                            cached_tm.tm_year + 1900, cached_tm.tm_mon + 1, cached_tm.tm_mday, cached_tm.tm_hour,
+                            cached_tm.tm_min, cached_tm.tm_sec, (long)(time_ns % 1000000000ULL / 1000),
+                            prog_name, (int)getpid(), tid, level_name(level), HEAD_NAME_MAX, name, line,
+                            HEAD_NAME_MAX, func);
+        if (head_len < 0) {
+            head_len = 0;
+        } else if (head_len >= (int)sizeof(head)) {
+            head_len = sizeof(head) - 1;
+        }
+        batch_len += snprintf(batch + batch_len, BATCH_SIZE - batch_len, "%-96s", head);
+    }
+    memcpy(batch + batch_len, msg, msg_len);
+    batch_len += msg_len;
+    batch[batch_len++] = '\n';
+
+    if (sink_mask & (LOG_ASYNC_SINK_SYSLOG | LOG_ASYNC_SINK_LOGCAT)) {
+        if (prefix) {
+            snprintf(system_line, sizeof(system_line), "[%d.%d] %s:%d @%s: %.*s", (int)getpid(), tid, name, line,
+                     func, msg_len, msg);
+        } else {
+            snprintf(system_line, sizeof(system_line), "%.*s", msg_len, msg);
+        }
+        emit_system(level, system_line);
+    }
+}
+
+static void emit_text(int tid, int level, int prefix, uint64_t time_ns, const char *file, int line,
+                      const char *func, const char *msg, int msg_len)
+{
+    if (bin_fd >= 0) {
+        bin_put_text(tid, level, prefix, time_ns, file, line, func, msg, msg_len);
+    }
+    if (sink_mask & ~LOG_ASYNC_SINK_BINARY) {
+        emit_line(tid, level, prefix, time_ns, file, line, func, msg, msg_len);
+    }
+}
+
+static void emit_record(int tid, const log_async_record_t *record)
+{
+    if (record->kind == LOG_ASYNC_KIND_TEXT) {
+        emit_text(tid, record->level, record->prefix, record->time_ns, record->file, record->line, record->func,
+                  record->data, record->len);
+        return;
+    }
+    if (bin_fd >= 0) {
+        bin_put_record(tid, record);
+    }
+    if (sink_mask & ~LOG_ASYNC_SINK_BINARY) {
+        char msg[1024];
+        int len = log_bin_format(record->site->fmt, record->data, record->len, msg, sizeof(msg));
+        emit_line(tid, record->level, record->prefix, record->time_ns, record->file, record->line, record->func,
+                  msg, len);
+    }
+}
+
+static void report_dropped(int tid, uint64_t *reported, uint64_t dropped)
+{
+    if (dropped == *reported) {
+        return;
+    }
+    char msg[128];
+    int len = snprintf(msg, sizeof(msg), "log ring overflow, dropped %llu messages",
+                       (unsigned long long)(dropped - *reported));
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    emit_text(tid, LOG_LEVEL_WARNING, 1, (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec, __FILE__, __LINE__,
+              __FUNCTION__, msg, len);
+    *reported = dropped;
+}
+
+static int drain_ring(log_async_ring_t *ring)
+{
+    int count = 0;
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    while (tail != head) {
+        // slots handed back now could be refilled under the crash handler
+        if (__atomic_load_n(&crash_flushing, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        log_async_record_t *record =
+            (log_async_record_t *)(ring->slots + (size_t)(tail & (LOG_ASYNC_RING_SLOTS - 1)) * LOG_ASYNC_SLOT_SIZE);
+        emit_record(ring->tid, record);
+        tail++;
+        count++;
+        // hand the slot back right away so a busy producer sees room sooner
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+    }
+    report_dropped(ring->tid, &ring->dropped_reported, __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED));
+    return count;
+}
+
+static int drain_all(void)
+{
+    int count = 0;
+    check_rotation();
+    for (int i = 0; i < LOG_ASYNC_MAX_THREADS; i++) {
+        log_async_ring_t *ring = &rings[i];
+        uint32_t state = __atomic_load_n(&ring->state, __ATOMIC_ACQUIRE);
+        if (state == RING_FREE) {
+            continue;
+        }
+        count += drain_ring(ring);
+        if (state == RING_ORPHANED) {
+            __atomic_store_n(&ring->state, RING_FREE, __ATOMIC_RELEASE);
+        }
+    }
+    report_dropped(0, &unowned_reported, __atomic_load_n(&unowned_dropped, __ATOMIC_RELAXED));
+#if USE_RUNTIME_LOG_LEVEL
+    log_rate_flush(); // once a second, its summaries go out on the next pass
+#endif
+    batch_flush();
+    return count;
+}
+
+/*
+ * Crash flush. Everything below runs inside a signal handler, so lines are
+ * put together with memcpy and hand rolled number formatting, and go out
+ * through write_all().
+ */
+#define CRASH_BUF_SIZE 4096
+
+typedef struct crash_out {
+    int fd;
+    int len;
+    char buf[CRASH_BUF_SIZE];
+} crash_out_t;
+
+static crash_out_t crash_text;
+static crash_out_t crash_bin;
+
+static const int crash_signals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+#define CRASH_SIGNAL_COUNT (int)(sizeof(crash_signals) / sizeof(crash_signals[0]))
+static struct sigaction crash_previous[CRASH_SIGNAL_COUNT];
+static int crash_installed;
+
+static void crash_put(crash_out_t *out, const void *data, int len)
+{
+    if (out->fd < 0 || len <= 0) {
+        return;
+    }
+    if (out->len + len > CRASH_BUF_SIZE) {
+        write_all(out->fd, out->buf, out->len);
+        out->len = 0;
+    }
+    if (len > CRASH_BUF_SIZE) {
+        write_all(out->fd, (const char *)data, len);
+        return;
+    }
+    memcpy(out->buf + out->len, data, len);
+    out->len += len;
+}
+
+static void crash_put_str(crash_out_t *out, const char *s, int len)
+{
+    uint16_t n = (uint16_t)(len < 0 ? (s ? strlen(s) : 0) : (size_t)len);
+    crash_put(out, &n, sizeof(n));
+    crash_put(out, s, n);
+}
+
+static void crash_drain(crash_out_t *out)
+{
+    if (out->fd >= 0 && out->len > 0) {
+        write_all(out->fd, out->buf, out->len);
+    }
+    out->len = 0;
+}
+
+static void line_put(char *line, int *len, int size, const char *s, int n)
+{
+    if (s == NULL) {
+        return;
+    }
+    if (n < 0) {
+        n = (int)strlen(s);
+    }
+    if (n > size - *len) {
+        n = size - *len;
+    }
+    memcpy(line + *len, s, n);
+    *len += n;
+}
+
+static void line_put_num(char *line, int *len, int size, uint64_t value, int width)
+{
+    char digits[24];
+    int n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value && n < 20);
+    while (n < width && n < 20) {
+        digits[sizeof(digits) - 1 - n++] = '0';
+    }
+    line_put(line, len, size, digits + sizeof(digits) - n, n);
+}
+
+// same layout as emit_line(), the calendar date comes from the days since the epoch
+static void crash_line(int tid, int level, int prefix, uint64_t time_ns, const char *file, int line_no,
+                       const char *func, const char *msg, int msg_len)
+{
+    char line[LOG_ASYNC_SLOT_SIZE + 512];
+    int size = (int)sizeof(line) - 1;
+    int len = 0;
+    if (prefix) {
+        int64_t secs = (int64_t)(time_ns / 1000000000ULL) + __atomic_load_n(&crash_gmtoff, __ATOMIC_RELAXED);
+        int64_t days = secs / 86400 + 719468; // shifted to 0000-03-01
+        int64_t rem = secs % 86400;
+        int64_t era = days / 146097;
+        int64_t doe = days - era * 146097;
+        int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int64_t mp = (5 * doy + 2) / 153;
+        int64_t day = doy - (153 * mp + 2) / 5 + 1;
+        int64_t month = mp < 10 ? mp + 3 : mp - 9;
+        int64_t year = yoe + era * 400 + (month <= 2);
+        const char *name = file ? (strrchr(file, '/') ? strrchr(file, '/') + 1 : file) : "";
+
+        line_put_num(line, &len, size, (uint64_t)year, 4);
+        line_put(line, &len, size, "-", 1);
+        line_put_num(line, &len, size, (uint64_t)month, 2);
+        line_put(line, &len, size, "-", 1);
+        line_put_num(line, &len, size, (uint64_t)day, 2);
+        line_put(line, &len, size, " ", 1);
+        line_put_num(line, &len, size, (uint64_t)(rem / 3600), 2);
+        line_put(line, &len, size, ":", 1);
+        line_put_num(line, &len, size, (uint64_t)(rem / 60 % 60), 2);
+        line_put(line, &len, size, ":", 1);
+        line_put_num(line, &len, size, (uint64_t)(rem % 60), 2);
+        line_put(line, &len, size, ".", 1);
+        line_put_num(line, &len, size, time_ns % 1000000000ULL / 1000, 6);
+        line_put(line, &len, size, " ", 1);
+        line_put(line, &len, size, prog_name, -1);
+        line_put(line, &len, size, " [", 2);
+        line_put_num(line, &len, size, (uint64_t)getpid(), 0);
+        line_put(line, &len, size, ".", 1);
+        line_put_num(line, &len, size, (uint64_t)tid, 0);
+        line_put(line, &len, size, "] ", 2);
+        line_put(line, &len, size, level_name(level), -1);
+        line_put(line, &len, size, " ", 1);
+        line_put(line, &len, size, name, -1);
+        line_put(line, &len, size, ":", 1);
+        line_put_num(line, &len, size, (uint64_t)line_no, 0);
+        line_put(line, &len, size, " @", 2);
+        line_put(line, &len, size, func, -1);
+        while (len < 96 && len < size) {
+            line[len++] = ' ';
+        }
+    }
+    line_put(line, &len, size, msg, msg_len);
+    line[len++] = '\n';
+    crash_put(&crash_text, line, len);
+}
+
+static void crash_record(int tid, const log_async_record_t *record)
+{
+    int len = record->len < LOG_ASYNC_DATA_SIZE ? record->len : LOG_ASYNC_DATA_SIZE;
+    if (record->kind == LOG_ASYNC_KIND_TEXT) {
+        if (crash_bin.fd >= 0) {
+            uint8_t type = LOG_BIN_REC_TEXT;
+            int32_t tid32 = tid;
+            uint16_t level = record->level;
+            uint8_t prefix = record->prefix;
+            int32_t line = record->line;
+            crash_put(&crash_bin, &type, sizeof(type));
+            crash_put(&crash_bin, &record->time_ns, sizeof(record->time_ns));
+            crash_put(&crash_bin, &tid32, sizeof(tid32));
+            crash_put(&crash_bin, &level, sizeof(level));
+            crash_put(&crash_bin, &prefix, sizeof(prefix));
+            crash_put(&crash_bin, &line, sizeof(line));
+            crash_put_str(&crash_bin, record->file, -1);
+            crash_put_str(&crash_bin, record->func, -1);
+            crash_put_str(&crash_bin, record->data, len);
+        }
+        if (sink_mask & ~LOG_ASYNC_SINK_BINARY) {
+            crash_line(tid, record->level, record->prefix, record->time_ns, record->file, record->line,
+                       record->func, record->data, len);
+        }
+        return;
+    }
+    const log_bin_site_t *site = record->site;
+    if (crash_bin.fd >= 0) {
+        // the site may not be in the file yet, a repeated site record is harmless
+        uint64_t id = (uint64_t)(uintptr_t)site;
+        uint16_t level = (uint16_t)site->level;
+        uint8_t prefix = (uint8_t)site->prefix;
+        int32_t line = site->line;
+        int32_t tid32 = tid;
+        uint16_t data_len = (uint16_t)len;
+        uint8_t type = LOG_BIN_REC_SITE;
+        crash_put(&crash_bin, &type, sizeof(type));
+        crash_put(&crash_bin, &id, sizeof(id));
+        crash_put(&crash_bin, &level, sizeof(level));
+        crash_put(&crash_bin, &prefix, sizeof(prefix));
+        crash_put(&crash_bin, &line, sizeof(line));
+        crash_put_str(&crash_bin, site->file, -1);
+        crash_put_str(&crash_bin, site->func, -1);
+        crash_put_str(&crash_bin, site->fmt, -1);
+        type = LOG_BIN_REC_DATA;
+        crash_put(&crash_bin, &type, sizeof(type));
+        crash_put(&crash_bin, &id, sizeof(id));
+        crash_put(&crash_bin, &record->time_ns, sizeof(record->time_ns));
+        crash_put(&crash_bin, &tid32, sizeof(tid32));
+        crash_put(&crash_bin, &data_len, sizeof(data_len));
+        crash_put(&crash_bin, record->data, len);
+    }
+    if (sink_mask & ~LOG_ASYNC_SINK_BINARY) {
+        // snprintf is not signal safe, the arguments stay undecoded in the text file
+        char msg[LOG_ASYNC_SLOT_SIZE];
+        int msg_len = 0;
+        line_put(msg, &msg_len, sizeof(msg), site->fmt, -1);
+        line_put(msg, &msg_len, sizeof(msg), " <not formatted>", -1);
+        crash_line(tid, record->level, record->prefix, record->time_ns, record->file, record->line, record->func,
+                   msg, msg_len);
+    }
+}
+
+void log_async_crash_flush(int sig)
+{
+    if (__atomic_exchange_n(&crash_flushing, 1, __ATOMIC_ACQ_REL)) {
+        return;
+    }
+    crash_text.fd = log_fd >= 0 ? log_fd : (sink_mask & LOG_ASYNC_SINK_STDOUT) ? STDOUT_FILENO : STDERR_FILENO;
+    crash_text.len = 0;
+    crash_bin.fd = bin_fd;
+    crash_bin.len = 0;
+
+    // whatever the writer had already taken out of the rings
+    int len = batch_len;
+    if (len > 0 && len <= BATCH_SIZE) {
+        crash_put(&crash_text, batch, len);
+    }
+    len = bin_len;
+    if (crash_bin.fd >= 0 && len > 0 && len <= BATCH_SIZE) {
+        crash_put(&crash_bin, bin_batch, len);
+    }
+    if (crash_bin.fd >= 0 && bin_header_pending) {
+        uint8_t type = LOG_BIN_REC_HEADER;
+        uint32_t magic = LOG_BIN_FILE_MAGIC;
+        uint32_t version = LOG_BIN_FILE_VERSION;
+        int32_t pid = (int32_t)getpid();
+        crash_put(&crash_bin, &type, sizeof(type));
+        crash_put(&crash_bin, &magic, sizeof(magic));
+        crash_put(&crash_bin, &version, sizeof(version));
+        crash_put(&crash_bin, &pid, sizeof(pid));
+        crash_put_str(&crash_bin, prog_name, -1);
+    }
+
+    uint64_t count = 0;
+    for (int i = 0; i < LOG_ASYNC_MAX_THREADS; i++) {
+        log_async_ring_t *ring = &rings[i];
+        if (__atomic_load_n(&ring->state, __ATOMIC_ACQUIRE) == RING_FREE || ring->slots == NULL) {
+            continue;
+        }
+        // only committed records, the slot at head may be half written by its owner. Producers
+        // stop reserving and the writer stops handing slots back once crash_flushing is set.
+        uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (head - tail > LOG_ASYNC_RING_SLOTS) {
+            continue; // torn read while the writer moved on
+        }
+        for (; tail != head; tail++) {
+            crash_record(ring->tid, (const log_async_record_t *)(ring->slots + (size_t)(tail & (LOG_ASYNC_RING_SLOTS - 1)) *
+                                                                                    LOG_ASYNC_SLOT_SIZE));
+            count++;
+        }
+    }
+
+    if (sig > 0) {
+        char msg[96];
+        int msg_len = 0;
+        line_put(msg, &msg_len, sizeof(msg), "fatal signal ", -1);
+        line_put_num(msg, &msg_len, sizeof(msg), (uint64_t)sig, 0);
+        line_put(msg, &msg_len, sizeof(msg), ", flushed ", -1);
+        line_put_num(msg, &msg_len, sizeof(msg), count, 0);
+        line_put(msg, &msg_len, sizeof(msg), " queued log lines", -1);
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        crash_line((int)syscall(SYS_gettid), LOG_LEVEL_ERROR, 1, (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec, __FILE__,
+                   __LINE__, __FUNCTION__, msg, msg_len);
+    }
+    crash_drain(&crash_bin);
+    crash_drain(&crash_text);
+}
+
+static void crash_handler(int sig, siginfo_t *info, void *context)
+{
+    (void)context;
+    log_async_crash_flush(sig);
+    for (int i = 0; i < CRASH_SIGNAL_COUNT; i++) {
+        if (crash_signals[i] == sig) {
+            sigaction(sig, &crash_previous[i], NULL);
+            break;
+        }
+    }
+    // a fault comes straight back on return and reaches the restored handler,
+    // a signal sent with kill() or raise() has to be sent again
+    if (info == NULL || info->si_code <= 0) {
+        raise(sig);
+    }
+}
+
+int log_async_install_crash_handler(void)
+{
+    if (__atomic_exchange_n(&crash_installed, 1, __ATOMIC_ACQ_REL)) {
+        return 0;
+    }
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = crash_handler;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK; // every logging thread gets a signal stack in ring_claim()
+    sigfillset(&action.sa_mask);
+    for (int i = 0; i < CRASH_SIGNAL_COUNT; i++) {
+        if (sigaction(crash_signals[i], &action, &crash_previous[i]) != 0) {
+            fprintf(stderr, "log_async: sigaction %d failed: %s\n", crash_signals[i], strerror(errno));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void *writer_main(void *arg)
+{
+    (void)arg;
+    int running = 1;
+    while (running) {
+        // the pass after the stop request is the last one
+        pthread_mutex_lock(&writer_lock);
+        running = writer_running;
+        uint64_t flush_seq = flush_requested;
+        pthread_mutex_unlock(&writer_lock);
+        drain_all();
+        pthread_mutex_lock(&writer_lock);
+        if (flush_seq != flush_done) {
+            flush_done = flush_seq;
+            pthread_cond_broadcast(&flush_cond);
+        }
+        int idle = running && writer_running && flush_requested == flush_done;
+        pthread_mutex_unlock(&writer_lock);
+        if (idle) {
+            wait_wakeup(LOG_ASYNC_FLUSH_MS);
+        }
+    }
+    return NULL;
+}
+
+int log_async_start(int sinks, const char *file_name)
+{
+    log_async_stop();
+    sink_mask = sinks;
+    wake_open();
+    snprintf(prog_name, sizeof(prog_name), "%s", __PROGNAME__ ? __PROGNAME__ : "");
+    if ((sinks & LOG_ASYNC_SINK_FILE) && file_name) {
+        snprintf(log_name, sizeof(log_name), "%s", file_name);
+        log_fd = open_log(log_name, &log_size);
+    }
+    if (sinks & LOG_ASYNC_SINK_BINARY) {
+        snprintf(bin_name, sizeof(bin_name), "%s", LOG_ASYNC_BINARY_FILE_NAME);
+        bin_fd = open_log(bin_name, &bin_size);
+        if (bin_fd >= 0) {
+            bin_generation++;
+            bin_header_pending = 1;
+        }
+    }
+#if defined(__linux__) && !defined(__ANDROID__)
+    if (sinks & LOG_ASYNC_SINK_SYSLOG) {
+        openlog(NULL, LOG_CONS, LOG_SYSLOG);
+    }
+#endif
+#if LOG_ASYNC_CRASH_FLUSH
+    struct tm now_tm;
+    time_t now = time(NULL);
+    if (localtime_r(&now, &now_tm)) {
+        crash_gmtoff = (long)now_tm.tm_gmtoff;
+    }
+    log_async_install_crash_handler();
+#endif
+    writer_running = 1;
+    if (pthread_create(&writer_thread, NULL, writer_main, NULL) != 0) {
+        writer_running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void log_async_stop(void)
+{
+    pthread_mutex_lock(&writer_lock);
+    int running = writer_running;
+    writer_running = 0;
+    pthread_cond_broadcast(&flush_cond);
+    pthread_mutex_unlock(&writer_lock);
+    if (running) {
+        wake_writer();
+        pthread_join(writer_thread, NULL);
+    }
+    if (log_fd >= 0) {
+        close(log_fd);
+        log_fd = -1;
+    }
+    if (bin_fd >= 0) {
+        close(bin_fd);
+        bin_fd = -1;
+    }
+    reap_compress_jobs(1);
+    if (cleanup_pending) {
+        cleanup_rotated();
+    }
+#if defined(__linux__) && !defined(__ANDROID__)
+    if (running && (sink_mask & LOG_ASYNC_SINK_SYSLOG)) {
+        closelog();
+    }
+#endif
+}
+
+// blocks until everything logged before the call has been handed to the sinks
+void log_async_flush(void)
+{
+    pthread_mutex_lock(&writer_lock);
+    if (writer_running) {
+        uint64_t seq = ++flush_requested;
+        wake_writer();
+        while (writer_running && flush_done < seq) {
+            pthread_cond_wait(&flush_cond, &writer_lock);
+        }
+    }
+    pthread_mutex_unlock(&writer_lock);
+}
+
+uint64_t log_async_dropped(void)
+{
+    uint64_t dropped = __atomic_load_n(&unowned_dropped, __ATOMIC_RELAXED);
+    for (int i = 0; i < LOG_ASYNC_MAX_THREADS; i++) {
+        dropped += __atomic_load_n(&rings[i].dropped, __ATOMIC_RELAXED);
+    }
+    return dropped;
+}
+
+// linking this file is what turns async logging on, for log.h and file_logger.h alike
+__attribute__((constructor)) void log_async_open(void)
+{
+    log_async_start(LOG_ASYNC_DEFAULT_SINKS, LOG_ASYNC_FILE_NAME);
+}
+
+__attribute__((destructor)) void log_async_close(void)
+{
+    log_async_stop();
+}
@@ -0,0 +1,189 @@
+/***************************************************************************
+ * Description: asynchronous log backend
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 14:05:12
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _LOG_ASYNC_H
+#define _LOG_ASYNC_H
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_ASYNC_MAX_THREADS 64     // rings in the pool, one per logging thread
+#define LOG_ASYNC_RING_SLOTS 256     // records per thread, must be a power of two
+#define LOG_ASYNC_SLOT_SIZE 256      // bytes per record including the header
+#define LOG_ASYNC_FLUSH_MS 20        // writer wakes at least this often
+
+#define LOG_ASYNC_SINK_STDOUT 0x1
+#define LOG_ASYNC_SINK_FILE 0x2
+#define LOG_ASYNC_SINK_SYSLOG 0x4
+#define LOG_ASYNC_SINK_LOGCAT 0x8
+#define LOG_ASYNC_SINK_BINARY 0x10 // raw records for log_decode, see log_binary.c
+
+#ifndef LOG_ASYNC_DEFAULT_SINKS
+#define LOG_ASYNC_DEFAULT_SINKS LOG_ASYNC_SINK_FILE
+#endif
+#ifndef LOG_ASYNC_FILE_NAME
+#define LOG_ASYNC_FILE_NAME "young.log"
+#endif
+#ifndef LOG_ASYNC_BINARY_FILE_NAME
+#define LOG_ASYNC_BINARY_FILE_NAME "young.ylog"
+#endif
+#ifndef LOG_ASYNC_MAX_FILE_SIZE
+#define LOG_ASYNC_MAX_FILE_SIZE 1048576 // 1MB, rotate once the file grows past it, 0 to never rotate
+#endif
+#ifndef LOG_ASYNC_KEEP_FILES
+#define LOG_ASYNC_KEEP_FILES 8 // rotated files kept next to the live one
+#endif
+#ifndef LOG_ASYNC_COMPRESS
+#define LOG_ASYNC_COMPRESS 0 // gzip rotated files in a child process
+#endif
+#ifndef LOG_ASYNC_CRASH_FLUSH
+#define LOG_ASYNC_CRASH_FLUSH 1 // write what is still queued when the process dies on a fatal signal
+#endif
+
+struct log_bin_site;
+
+typedef struct log_async_record {
+    uint64_t time_ns;       // CLOCK_REALTIME when the line was logged
+    const char *file;       // interned __FILE__, path is stripped by the writer
+    const char *func;       // interned as well
+    const struct log_bin_site *site; // binary records only
+    int32_t line;
+    uint16_t level;
+    uint8_t prefix;         // 0 for the LOGx2 variants without context
+    uint8_t kind;           // LOG_ASYNC_KIND_*
+    uint16_t len;           // bytes used in data
+    char data[1];
+} log_async_record_t;
+
+#define LOG_ASYNC_KIND_TEXT 0
+#define LOG_ASYNC_KIND_BINARY 1 // data holds packed printf arguments
+#define LOG_ASYNC_DATA_SIZE (LOG_ASYNC_SLOT_SIZE - (int)sizeof(log_async_record_t) + 1)
+
+/* Formats into the calling thread's ring and returns without any I/O.
+ * If the ring is full the line is dropped and counted. Interns file and
+ * func on every call, the LOG macros use log_async_write_site(). */
+void log_async_write(int level, int prefix, const char *file, int line, const char *func, const char *fmt, ...)
+    __attribute__((format(printf, 6, 7)));
+
+/* Text call site, a static owned by the LOG macro. The first line from it
+ * interns file and func and caches the copies here, so later lines skip
+ * the hash and compare in log_async_intern(). */
+typedef struct log_async_site {
+    const char *file;
+    const char *func;
+    int line;
+    const char *interned_file; // NULL until the first call
+    const char *interned_func;
+} log_async_site_t;
+
+#define LOG_ASYNC_SITE {__FILE__, __FUNCTION__, __LINE__, NULL, NULL}
+
+/* Same as log_async_write() for a call site with a static descriptor. */
+void log_async_write_site(log_async_site_t *site, int level, int prefix, const char *fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+/* Copy of s that stays valid for the life of the process, the same
+ * pointer for the same text. Records filled by hand must use it for file
+ * and func. Returns "?" once the intern arena is full. */
+const char *log_async_intern(const char *s);
+
+/* Reserve a slot in the calling thread's ring for a record filled by the
+ * caller, NULL when the ring is full. Commit with log_async_commit(). */
+log_async_record_t *log_async_reserve(void);
+void log_async_commit(log_async_record_t *record);
+
+/*
+ * Binary mode. Each call site owns a static descriptor with the format
+ * string and its location, the record only carries the descriptor, a
+ * timestamp and the raw arguments, so the calling thread never formats.
+ * The writer either formats the record itself for the text sinks or stores
+ * it as is in LOG_ASYNC_BINARY_FILE_NAME, where log_decode turns it back
+ * into the usual text.
+ */
+#define LOG_BIN_MAX_ARGS 16
+#define LOG_BIN_MAX_SITES 4096 // registered call sites per process
+
+#define LOG_BIN_NONE 0
+#define LOG_BIN_INT 1
+#define LOG_BIN_LONG 2
+#define LOG_BIN_LLONG 3
+#define LOG_BIN_SIZE 4
+#define LOG_BIN_DOUBLE 5
+#define LOG_BIN_LDOUBLE 6
+#define LOG_BIN_PTR 7
+#define LOG_BIN_STR 8
+
+/* The first call registers the site: log_async.c keeps a copy with
+ * interned strings and the parsed format, and records point at that copy,
+ * so they outlive a dlclosed library. The same site text maps to the same
+ * copy when the library is loaded again. */
+typedef struct log_bin_site {
+    const char *fmt;
+    const char *file;
+    const char *func;
+    int line;
+    int level;
+    int prefix;
+    int nargs; // parsed format, set on the registered copy
+    uint8_t kinds[LOG_BIN_MAX_ARGS];
+    uint32_t emitted; // writer generation that last stored the registered copy in the binary file
+    const struct log_bin_site *registered; // NULL until the first call
+} log_bin_site_t;
+
+#define LOG_BIN_SITE(level, prefix, fmt) {fmt, __FILE__, __FUNCTION__, __LINE__, level, prefix, -1, {0}, 0, NULL}
+
+void log_bin_write(log_bin_site_t *site, ...);
+
+// never called, lets the compiler check the arguments against the format
+static inline void __attribute__((format(printf, 1, 2))) log_bin_check(const char *fmt, ...)
+{
+    (void)fmt;
+}
+
+// log_binary.c, shared by the writer and log_decode
+int log_bin_parse(const char *fmt, uint8_t *kinds, int max_kinds);
+int log_bin_pack(const uint8_t *kinds, int nargs, va_list args, char *data, int size);
+int log_bin_format(const char *fmt, const char *data, int len, char *out, int out_size);
+
+/* Layout of LOG_ASYNC_BINARY_FILE_NAME, native byte order. Every record
+ * starts with one type byte. A header record starts each writer session and
+ * resets the site table, since site ids are addresses in that process. */
+#define LOG_BIN_FILE_MAGIC 0x474f4c59 // "YLOG"
+#define LOG_BIN_FILE_VERSION 1
+#define LOG_BIN_REC_HEADER 'H' // u32 magic, u32 version, i32 pid, u16 len, program name
+#define LOG_BIN_REC_SITE 'S'   // u64 id, u16 level, u8 prefix, i32 line, then u16 len + bytes for file, func, fmt
+#define LOG_BIN_REC_DATA 'B'   // u64 id, u64 time_ns, i32 tid, u16 len, packed arguments
+#define LOG_BIN_REC_TEXT 'T'   // u64 time_ns, i32 tid, u16 level, u8 prefix, i32 line, then u16 len + bytes for file, func, message
+
+int log_async_start(int sinks, const char *file_name);
+void log_async_stop(void);
+/* Takes effect at the writer's next pass. Rotation runs on the writer
+ * thread only, the logging threads never wait for rename or gzip. */
+void log_async_set_rotation(long max_size, int keep_files, int compress);
+void log_async_flush(void);
+uint64_t log_async_dropped(void);
+
+/* Handlers for SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT that write the
+ * queued lines before the previously installed handler runs. Called by
+ * log_async_start() when LOG_ASYNC_CRASH_FLUSH is set. */
+int log_async_install_crash_handler(void);
+/* Async-signal-safe: no locks, no allocation, nothing but write(2). Writes
+ * the writer's unflushed batch and every ring to the files, or to stderr
+ * without a file sink. Runs once, later calls return at once. sig is only
+ * used for the closing line, 0 for none. */
+void log_async_crash_flush(int sig);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _LOG_ASYNC_H
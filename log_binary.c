@@ -0,0 +1,353 @@
+/***************************************************************************
+ * Description: printf argument capture and replay for binary log records
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 15:02:36
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * A binary record carries the raw printf arguments of one log call, packed
+ * in the order of the conversions in the format string. Integers and
+ * floating point values are stored at their native size, %s is stored as a
+ * one byte length followed by the bytes, since the pointer is gone by the
+ * time the line is decoded. Records are read back on a host with the same
+ * ABI as the one that wrote them.
+ *
+ * The same spec parser decides how many bytes each argument takes on both
+ * sides, so the writer and the decoder can never disagree on the layout.
+ */
+
+#include "log_async.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct fmt_spec {
+    char text[32]; // the conversion with '*' still in place
+    int star_width;
+    int star_prec;
+    int kind;
+    char conv;
+} fmt_spec_t;
+
+static int arg_size(int kind)
+{
+    switch (kind) {
+    case LOG_BIN_INT:
+        return sizeof(int);
+    case LOG_BIN_LONG:
+        return sizeof(long);
+    case LOG_BIN_LLONG:
+        return sizeof(long long);
+    case LOG_BIN_SIZE:
+        return sizeof(size_t);
+    case LOG_BIN_DOUBLE:
+        return sizeof(double);
+    case LOG_BIN_LDOUBLE:
+        return sizeof(long double);
+    case LOG_BIN_PTR:
+        return sizeof(void *);
+    default:
+        return 0;
+    }
+}
+
+// parses the conversion that starts right after a '%', returns the position after it
+static const char *parse_spec(const char *p, fmt_spec_t *spec)
+{
+    int len = 0;
+    int lmod = 0; // 1 h, 2 hh, 3 l, 4 ll, 5 L, 6 z/j/t
+    memset(spec, 0, sizeof(*spec));
+    spec->text[len++] = '%';
+    while (*p && strchr("-+ #0'", *p) && len < (int)sizeof(spec->text) - 8) {
+        spec->text[len++] = *p++;
+    }
+    if (*p == '*') {
+        spec->star_width = 1;
+        spec->text[len++] = *p++;
+    }
+    while (*p >= '0' && *p <= '9' && len < (int)sizeof(spec->text) - 8) {
+        spec->text[len++] = *p++;
+    }
+    if (*p == '.') {
+        spec->text[len++] = *p++;
+        if (*p == '*') {
+            spec->star_prec = 1;
+            spec->text[len++] = *p++;
+        }
+        while (*p >= '0' && *p <= '9' && len < (int)sizeof(spec->text) - 8) {
+            spec->text[len++] = *p++;
+        }
+    }
+    while (*p && strchr("hlLqzjt", *p)) {
+        if (*p == 'h') {
+            lmod = lmod == 1 ? 2 : 1;
+        } else if (*p == 'l') {
+            lmod = lmod == 3 ? 4 : 3;
+        } else if (*p == 'L' || *p == 'q') {
+            lmod = *p == 'q' ? 4 : 5;
+        } else {
+            lmod = 6;
+        }
+        spec->text[len++] = *p++;
+    }
+    spec->conv = *p;
+    if (*p) {
+        spec->text[len++] = *p++;
+    }
+    spec->text[len] = '\0';
+
+    switch (spec->conv) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+        spec->kind = lmod == 3 ? LOG_BIN_LONG : lmod == 4 ? LOG_BIN_LLONG
+                                            : lmod == 6   ? LOG_BIN_SIZE
+                                                          : LOG_BIN_INT;
+        break;
+    case 'c':
+        spec->kind = LOG_BIN_INT;
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        spec->kind = lmod == 5 ? LOG_BIN_LDOUBLE : LOG_BIN_DOUBLE;
+        break;
+    case 's':
+        spec->kind = lmod == 3 ? LOG_BIN_PTR : LOG_BIN_STR; // %ls is not captured, only its address
+        break;
+    case 'p':
+    case 'n':
+        spec->kind = LOG_BIN_PTR;
+        break;
+    default:
+        spec->kind = LOG_BIN_NONE; // "%%" and anything unknown
+        break;
+    }
+    return p;
+}
+
+int log_bin_parse(const char *fmt, uint8_t *kinds, int max_kinds)
+{
+    int count = 0;
+    fmt_spec_t spec;
+    for (const char *p = fmt; *p;) {
+        if (*p++ != '%') {
+            continue;
+        }
+        p = parse_spec(p, &spec);
+        if (spec.star_width && count < max_kinds) {
+            kinds[count++] = LOG_BIN_INT;
+        }
+        if (spec.star_prec && count < max_kinds) {
+            kinds[count++] = LOG_BIN_INT;
+        }
+        if (spec.kind != LOG_BIN_NONE && count < max_kinds) {
+            kinds[count++] = (uint8_t)spec.kind;
+        }
+    }
+    return count;
+}
+
+int log_bin_pack(const uint8_t *kinds, int nargs, va_list args, char *data, int size)
+{
+    int len = 1;
+    int count = 0;
+    for (int i = 0; i < nargs; i++) {
+        int kind = kinds[i];
+        if (kind == LOG_BIN_STR) {
+            const char *s = va_arg(args, const char *);
+            size_t n = s ? strlen(s) : 6;
+            if (len + 1 > size) {
+                break;
+            }
+            if (n > 255) {
+                n = 255;
+            }
+            if (n > (size_t)(size - len - 1)) {
+                n = size - len - 1;
+            }
+            data[len++] = (char)n;
+            memcpy(data + len, s ? s : "(null)", n);
+            len += (int)n;
+            count++;
+            continue;
+        }
+        union {
+            int i;
+            long l;
+            long long ll;
+            size_t z;
+            double d;
+            long double ld;
+            void *p;
+        } value;
+        switch (kind) {
+        case LOG_BIN_INT:
+            value.i = va_arg(args, int);
+            break;
+        case LOG_BIN_LONG:
+            value.l = va_arg(args, long);
+            break;
+        case LOG_BIN_LLONG:
+            value.ll = va_arg(args, long long);
+            break;
+        case LOG_BIN_SIZE:
+            value.z = va_arg(args, size_t);
+            break;
+        case LOG_BIN_DOUBLE:
+            value.d = va_arg(args, double);
+            break;
+        case LOG_BIN_LDOUBLE:
+            value.ld = va_arg(args, long double);
+            break;
+        default:
+            value.p = va_arg(args, void *);
+            break;
+        }
+        int n = arg_size(kind);
+        if (len + n > size) {
+            break;
+        }
+        memcpy(data + len, &value, n);
+        len += n;
+        count++;
+    }
+    data[0] = (char)count;
+    return len;
+}
+
+// reads the next packed argument, returns 0 when the record ran out
+static int unpack(const char **data, const char *end, int *left, int kind, void *value, char *str)
+{
+    if (*left <= 0) {
+        return 0;
+    }
+    if (kind == LOG_BIN_STR) {
+        if (*data + 1 > end) {
+            return 0;
+        }
+        int n = (unsigned char)**data;
+        if (*data + 1 + n > end) {
+            return 0;
+        }
+        memcpy(str, *data + 1, n);
+        str[n] = '\0';
+        *data += 1 + n;
+    } else {
+        int n = arg_size(kind);
+        if (*data + n > end) {
+            return 0;
+        }
+        memcpy(value, *data, n);
+        *data += n;
+    }
+    (*left)--;
+    return 1;
+}
+
+int log_bin_format(const char *fmt, const char *data, int len, char *out, int out_size)
+{
+    const char *end = data + len;
+    int left = len > 0 ? (unsigned char)data[0] : 0;
+    int pos = 0;
+    char str[256];
+    fmt_spec_t spec;
+
+    data++;
+    if (out_size <= 0) {
+        return 0;
+    }
+    for (const char *p = fmt; *p && pos < out_size - 1;) {
+        if (*p != '%') {
+            out[pos++] = *p++;
+            continue;
+        }
+        p = parse_spec(p + 1, &spec);
+        if (spec.conv == '%') {
+            out[pos++] = '%';
+            continue;
+        }
+        int width = 0, prec = 0;
+        if ((spec.star_width && !unpack(&data, end, &left, LOG_BIN_INT, &width, str)) ||
+            (spec.star_prec && !unpack(&data, end, &left, LOG_BIN_INT, &prec, str))) {
+            pos += snprintf(out + pos, out_size - pos, "<?>");
+            continue;
+        }
+        union {
+            int i;
+            long l;
+            long long ll;
+            size_t z;
+            double d;
+            long double ld;
+            void *ptr;
+        } value;
+        if (spec.kind == LOG_BIN_NONE) {
+            continue;
+        }
+        if (!unpack(&data, end, &left, spec.kind, &value, str)) {
+            pos += snprintf(out + pos, out_size - pos, "<?>");
+            continue;
+        }
+        if (spec.conv == 'n') {
+            continue;
+        }
+        // turn the '*' into the captured numbers so one snprintf handles the rest
+        char conv[48];
+        int c = 0;
+        for (const char *s = spec.text; *s && c < (int)sizeof(conv) - 12; s++) {
+            if (*s == '*') {
+                c += snprintf(conv + c, sizeof(conv) - c, "%d", s[-1] == '.' ? prec : width);
+            } else {
+                conv[c++] = *s;
+            }
+        }
+        conv[c] = '\0';
+        int n = 0;
+        switch (spec.kind) {
+        case LOG_BIN_INT:
+            n = snprintf(out + pos, out_size - pos, conv, value.i);
+            break;
+        case LOG_BIN_LONG:
+            n = snprintf(out + pos, out_size - pos, conv, value.l);
+            break;
+        case LOG_BIN_LLONG:
+            n = snprintf(out + pos, out_size - pos, conv, value.ll);
+            break;
+        case LOG_BIN_SIZE:
+            n = snprintf(out + pos, out_size - pos, conv, value.z);
+            break;
+        case LOG_BIN_DOUBLE:
+            n = snprintf(out + pos, out_size - pos, conv, value.d);
+            break;
+        case LOG_BIN_LDOUBLE:
+            n = snprintf(out + pos, out_size - pos, conv, value.ld);
+            break;
+        case LOG_BIN_STR:
+            n = snprintf(out + pos, out_size - pos, conv, str);
+            break;
+        default:
+            n = spec.conv == 's' ? snprintf(out + pos, out_size - pos, "%p", value.ptr)
+                                 : snprintf(out + pos, out_size - pos, conv, value.ptr);
+            break;
+        }
+        if (n > 0) {
+            pos += n;
+        }
+    }
+    if (pos > out_size - 1) {
+        pos = out_size - 1;
+    }
+    out[pos] = '\0';
+    return pos;
+}
@@ -0,0 +1,263 @@
+/***************************************************************************
+ * Description: turn a binary log written by log_async.c back into text
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 15:40:18
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+// gcc log_decode.c log_binary.c -o log_decode
+// ./log_decode young.ylog [young.log]
+
+#include "log_async.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct site_entry {
+    uint64_t id;
+    int level;
+    int prefix;
+    int line;
+    char *file;
+    char *func;
+    char *fmt;
+} site_entry_t;
+
+typedef struct reader {
+    const char *start;
+    const char *pos;
+    const char *end;
+} reader_t;
+
+static site_entry_t *sites;
+static size_t site_count;
+static size_t site_cap;
+static char prog_name[256];
+static int prog_pid;
+
+static int get(reader_t *r, void *out, size_t len)
+{
+    if ((size_t)(r->end - r->pos) < len) {
+        return -1;
+    }
+    memcpy(out, r->pos, len);
+    r->pos += len;
+    return 0;
+}
+
+// u16 length and the bytes, returned as a new string
+static char *get_str(reader_t *r)
+{
+    uint16_t len = 0;
+    if (get(r, &len, sizeof(len)) != 0 || (size_t)(r->end - r->pos) < len) {
+        return NULL;
+    }
+    char *s = (char *)malloc(len + 1);
+    if (s) {
+        memcpy(s, r->pos, len);
+        s[len] = '\0';
+    }
+    r->pos += len;
+    return s;
+}
+
+static void clear_sites(void)
+{
+    for (size_t i = 0; i < site_count; i++) {
+        free(sites[i].file);
+        free(sites[i].func);
+        free(sites[i].fmt);
+    }
+    site_count = 0;
+}
+
+static site_entry_t *find_site(uint64_t id)
+{
+    // sites show up in first use order, recent ones are the likely hits
+    for (size_t i = site_count; i > 0; i--) {
+        if (sites[i - 1].id == id) {
+            return &sites[i - 1];
+        }
+    }
+    return NULL;
+}
+
+static const char *level_name(int level)
+{
+    switch (level) {
+    case 1:
+        return "ERROR";
+    case 2:
+        return "WARN";
+    case 3:
+        return "INFO";
+    default:
+        return "DEBUG";
+    }
+}
+
+static void print_line(FILE *out, uint64_t time_ns, int tid, int level, int prefix, const char *file, int line,
+                       const char *func, const char *msg)
+{
+    if (prefix) {
+        char head[512];
+        time_t sec = (time_t)(time_ns / 1000000000ULL);
+        struct tm tm_info;
+        localtime_r(&sec, &tm_info);
+        const char *name = strrchr(file, '/') ? strrchr(file, '/') + 1 : file;
+        snprintf(head, sizeof(head), "%04d-%02d-%02d %02d:%02d:%02d.%06ld %s [%d.%d] %s %s:%d @%s",
+                 tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday, tm_info.tm_hour, tm_info.tm_min,
+                 tm_info.tm_sec, (long)(time_ns % 1000000000ULL / 1000), prog_name, prog_pid, tid,
+                 level_name(level), name, line, func);
+        fprintf(out, "%-96s%s\n", head, msg);
+    } else {
+        fprintf(out, "%s\n", msg);
+    }
+}
+
+static int decode(reader_t *r, FILE *out)
+{
+    char msg[4096];
+    while (r->pos < r->end) {
+        uint8_t type = (uint8_t)*r->pos++;
+        if (type == LOG_BIN_REC_HEADER) {
+            uint32_t magic = 0, version = 0;
+            int32_t pid = 0;
+            if (get(r, &magic, sizeof(magic)) || get(r, &version, sizeof(version)) || get(r, &pid, sizeof(pid))) {
+                break;
+            }
+            if (magic != LOG_BIN_FILE_MAGIC || version != LOG_BIN_FILE_VERSION) {
+                fprintf(stderr, "unknown log file version %u\n", version);
+                return -1;
+            }
+            char *name = get_str(r);
+            if (name == NULL) {
+                break;
+            }
+            snprintf(prog_name, sizeof(prog_name), "%s", name);
+            free(name);
+            prog_pid = pid;
+            clear_sites();
+        } else if (type == LOG_BIN_REC_SITE) {
+            site_entry_t site = {0};
+            uint16_t level = 0;
+            uint8_t prefix = 0;
+            int32_t line = 0;
+            if (get(r, &site.id, sizeof(site.id)) || get(r, &level, sizeof(level)) ||
+                get(r, &prefix, sizeof(prefix)) || get(r, &line, sizeof(line))) {
+                break;
+            }
+            site.level = level;
+            site.prefix = prefix;
+            site.line = line;
+            site.file = get_str(r);
+            site.func = get_str(r);
+            site.fmt = get_str(r);
+            if (!site.file || !site.func || !site.fmt) {
+                free(site.file);
+                free(site.func);
+                free(site.fmt);
+                break;
+            }
+            if (site_count == site_cap) {
+                size_t cap = site_cap ? site_cap * 2 : 256;
+                site_entry_t *grown = (site_entry_t *)realloc(sites, cap * sizeof(*sites));
+                if (grown == NULL) {
+                    return -1;
+                }
+                sites = grown;
+                site_cap = cap;
+            }
+            sites[site_count++] = site;
+        } else if (type == LOG_BIN_REC_DATA) {
+            uint64_t id = 0, time_ns = 0;
+            int32_t tid = 0;
+            uint16_t len = 0;
+            if (get(r, &id, sizeof(id)) || get(r, &time_ns, sizeof(time_ns)) || get(r, &tid, sizeof(tid)) ||
+                get(r, &len, sizeof(len)) || (size_t)(r->end - r->pos) < len) {
+                break;
+            }
+            site_entry_t *site = find_site(id);
+            if (site == NULL) {
+                fprintf(out, "<record for unknown site 0x%llx>\n", (unsigned long long)id);
+            } else {
+                log_bin_format(site->fmt, r->pos, len, msg, sizeof(msg));
+                print_line(out, time_ns, tid, site->level, site->prefix, site->file, site->line, site->func, msg);
+            }
+            r->pos += len;
+        } else if (type == LOG_BIN_REC_TEXT) {
+            uint64_t time_ns = 0;
+            int32_t tid = 0, line = 0;
+            uint16_t level = 0;
+            uint8_t prefix = 0;
+            if (get(r, &time_ns, sizeof(time_ns)) || get(r, &tid, sizeof(tid)) || get(r, &level, sizeof(level)) ||
+                get(r, &prefix, sizeof(prefix)) || get(r, &line, sizeof(line))) {
+                break;
+            }
+            char *file = get_str(r);
+            char *func = get_str(r);
+            char *text = get_str(r);
+            if (file && func && text) {
+                print_line(out, time_ns, tid, level, prefix, file, line, func, text);
+            }
+            free(file);
+            free(func);
+            free(text);
+            if (!file || !func || !text) {
+                break;
+            }
+        } else {
+            fprintf(stderr, "corrupt record type 0x%02x at offset %ld\n", type, (long)(r->pos - 1 - r->start));
+            return -1;
+        }
+    }
+    if (r->pos < r->end) {
+        fprintf(stderr, "truncated record at the end of the file\n");
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        printf("Usage: %s <young.ylog> [output.log]\n", argv[0]);
+        return -1;
+    }
+    FILE *in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        printf("Failed to open %s\n", argv[1]);
+        return -1;
+    }
+    fseek(in, 0, SEEK_END);
+    long size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    char *data = (char *)malloc(size > 0 ? size : 1);
+    if (data == NULL || fread(data, 1, size, in) != (size_t)size) {
+        printf("Failed to read %s\n", argv[1]);
+        fclose(in);
+        free(data);
+        return -1;
+    }
+    fclose(in);
+
+    FILE *out = stdout;
+    if (argc > 2) {
+        out = fopen(argv[2], "w");
+        if (out == NULL) {
+            printf("Failed to open %s\n", argv[2]);
+            free(data);
+            return -1;
+        }
+    }
+    reader_t reader = {data, data, data + size};
+    int ret = decode(&reader, out);
+    if (out != stdout) {
+        fclose(out);
+    }
+    clear_sites();
+    free(sites);
+    free(data);
+    return ret;
+}
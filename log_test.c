@@ -8,9 +8,42 @@
 
 #include "log.h"
 
+#if USE_RUNTIME_LOG_LEVEL
+// the example of log.h: module rules keep their level whatever the position of "*"
+static int test_level_rules(void)
+{
+    log_module_t algo = {LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG, "AlgoAPI"};
+    log_module_t listener = {LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG, "socket/socket_listener.cpp"};
+    log_module_t other = {LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG, LOG_LEVEL_DEBUG, "chime_xml.c"};
+    int failed = 0;
+    log_module_register(&algo);
+    log_module_register(&listener);
+    log_module_register(&other);
+    log_level_apply("AlgoAPI=debug,socket_listener.cpp=warn,*=info");
+    failed |= log_level_get("AlgoAPI") != LOG_LEVEL_DEBUG;
+    failed |= log_level_get("socket_listener.cpp") != LOG_LEVEL_WARNING;
+    failed |= log_level_get("chime_xml") != LOG_LEVEL_INFO;
+    // a later default leaves the rules alone as well
+    log_level_apply("error");
+    failed |= log_level_get("AlgoAPI") != LOG_LEVEL_DEBUG;
+    failed |= log_level_get("chime_xml") != LOG_LEVEL_ERROR;
+    log_module_unregister(&algo);
+    log_module_unregister(&listener);
+    log_module_unregister(&other);
+    log_level_apply("*=debug");
+    printf("level rules: %s\n", failed ? "FAILED" : "ok");
+    return failed;
+}
+#endif
+
 int main()
 {
     char c = 'A';
+#if USE_RUNTIME_LOG_LEVEL
+    if (test_level_rules() != 0) {
+        return 1;
+    }
+#endif
 
     LOGD2("This is a debug log without context.");
     LOGD("This is a debug log with value: %1s", &c);
@@ -23,3 +56,7 @@ int main()
 
     return 0;
 }
+
+/* Compile Command:
+    gcc log_test.c log.c -lpthread -o log_test && ./log_test
+*/
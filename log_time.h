@@ -0,0 +1,105 @@
+/***************************************************************************
+ * Description: cheap timestamps and thread ids for log lines
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 16:12:40
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _LOG_TIME_H
+#define _LOG_TIME_H
+
+/*
+ * Every thread keeps an anchor pair of CLOCK_REALTIME and CLOCK_MONOTONIC
+ * readings plus the broken-down local time of the anchor second. A
+ * timestamp costs one vDSO read of CLOCK_MONOTONIC, and the calendar time
+ * is only rebuilt with localtime_r when the second changes. The anchor is
+ * taken again at that point, so a clock step shows up within a second.
+ * CLOCK_MONOTONIC_COARSE would save a few nanoseconds but only ticks every
+ * few milliseconds, and the log lines print microseconds.
+ *
+ * pid and tid are cached per thread as well and reset in a forked child.
+ */
+
+#if defined(__linux__) || defined(__QNX__) || defined(__ANDROID__)
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct log_time {
+    struct tm tm;
+    long usec;
+} log_time_t;
+
+typedef struct log_time_cache {
+    uint64_t wall_base_ns;
+    uint64_t mono_base_ns;
+    time_t sec;
+    struct tm tm;
+    int pid;
+    int tid;
+} log_time_cache_t;
+
+static __thread log_time_cache_t log_time_cache_;
+static int log_time_atfork_ = 0;
+
+static inline uint64_t log_time_clock_ns_(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// the forking thread is the only one left in the child, its ids changed
+static inline void log_time_fork_child_(void)
+{
+    log_time_cache_.pid = 0;
+    log_time_cache_.tid = 0;
+}
+
+static inline int log_time_tid(void)
+{
+    if (__builtin_expect(log_time_cache_.tid == 0, 0)) {
+        if (!__atomic_exchange_n(&log_time_atfork_, 1, __ATOMIC_RELAXED)) {
+            pthread_atfork(NULL, NULL, log_time_fork_child_);
+        }
+        log_time_cache_.tid = (int)syscall(SYS_gettid);
+    }
+    return log_time_cache_.tid;
+}
+
+static inline int log_time_pid(void)
+{
+    if (__builtin_expect(log_time_cache_.pid == 0, 0)) {
+        log_time_tid();
+        log_time_cache_.pid = (int)getpid();
+    }
+    return log_time_cache_.pid;
+}
+
+// wall clock in ns, monotonic within a second
+static inline uint64_t log_time_wall_ns(void)
+{
+    log_time_cache_t *c = &log_time_cache_;
+    uint64_t mono = log_time_clock_ns_(CLOCK_MONOTONIC);
+    uint64_t wall = c->wall_base_ns + (mono - c->mono_base_ns);
+    if (__builtin_expect((time_t)(wall / 1000000000ULL) != c->sec || c->wall_base_ns == 0, 0)) {
+        c->wall_base_ns = wall = log_time_clock_ns_(CLOCK_REALTIME);
+        c->mono_base_ns = log_time_clock_ns_(CLOCK_MONOTONIC);
+        c->sec = (time_t)(wall / 1000000000ULL);
+        localtime_r(&c->sec, &c->tm);
+    }
+    return wall;
+}
+
+static inline void log_time_now(log_time_t *t)
+{
+    uint64_t wall = log_time_wall_ns();
+    t->tm = log_time_cache_.tm;
+    t->usec = (long)(wall % 1000000000ULL / 1000);
+}
+#endif
+
+#endif // _LOG_TIME_H
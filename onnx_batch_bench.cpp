@@ -0,0 +1,126 @@
+/* **************************************************************
+ * @Description: throughput and added latency of OnnxBatcher against batch size and deadline
+ * @Date: 2026-10-20 00:52:14
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+#include "OnnxBatcher.hpp"
+#include "log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#define FRAMES 1024
+#define RUN_SECONDS 1.0
+#define MAX_STREAMS 64
+
+static bool pointwise = true;
+
+// every stream in its own thread, processing blocks back to back
+static void run_streams(test::OnnxBatcher *batcher, int streams, double seconds)
+{
+    std::vector<std::thread> threads;
+    for (int s = 0; s < streams; s++) {
+        threads.emplace_back([batcher, s, seconds]() {
+            float input[FRAMES], output[FRAMES];
+            for (int i = 0; i < FRAMES; i++) {
+                input[i] = sinf(0.01f * i * (s + 1));
+            }
+            struct timespec start, now;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            do {
+                if (batcher->process(s, input, output) != 0) {
+                    return;
+                }
+                clock_gettime(CLOCK_MONOTONIC, &now);
+            } while (now.tv_sec - start.tv_sec + (now.tv_nsec - start.tv_nsec) / 1e9 < seconds);
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+// batched results have to match the same blocks run one by one
+static int check(const char *model, int streams)
+{
+    test::onnx_batch_config_t config = {model, FRAMES, streams, 1, 0, 1, pointwise};
+    test::OnnxBatcher single(&config);
+    config.max_batch = streams;
+    config.deadline_us = 100000;
+    test::OnnxBatcher batched(&config);
+    if (!single.is_ready() || !batched.is_ready()) {
+        return -1;
+    }
+    std::vector<float> input((size_t)streams * FRAMES), expect(input.size()), output(input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = (float)(rand() / (double)RAND_MAX * 2 - 1);
+    }
+    for (int s = 0; s < streams; s++) {
+        single.process(s, &input[(size_t)s * FRAMES], &expect[(size_t)s * FRAMES]);
+        batched.submit(s, &input[(size_t)s * FRAMES], &output[(size_t)s * FRAMES]);
+    }
+    for (int s = 0; s < streams; s++) {
+        batched.wait(s);
+    }
+    test::onnx_batch_stats_t stats;
+    batched.get_stats(&stats);
+    if (memcmp(expect.data(), output.data(), input.size() * sizeof(float)) != 0 || stats.batches != 1) {
+        printf("batched results differ from single runs, %llu batches\n", (unsigned long long)stats.batches);
+        return -1;
+    }
+    printf("%d streams in one batch match single runs\n", streams);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *model = argc > 1 ? argv[1] : "reduce_15db.onnx";
+    int streams = argc > 2 ? atoi(argv[2]) : 16;
+    int threads = argc > 3 ? atoi(argv[3]) : 1;
+    pointwise = argc > 4 ? atoi(argv[4]) != 0 : true;
+    if (streams <= 0 || streams > MAX_STREAMS) {
+        printf("Usage: %s [model] [streams up to %d] [intra-op threads] [pointwise 0/1]\n", argv[0], MAX_STREAMS);
+        return -1;
+    }
+    if (check(model, streams) != 0) {
+        return -1;
+    }
+
+    const int batches[] = {1, 4, 8, 16, 32, 64};
+    const int deadlines_us[] = {200, 1000};
+    printf("%d streams of %d samples, %d intra-op threads\n", streams, FRAMES, threads);
+    printf("%6s %12s %11s %13s %15s %15s %15s\n", "batch", "deadline us", "mean batch", "blocks/s", "run us/block",
+           "added p50 us", "added p99 us");
+    for (size_t d = 0; d < sizeof(deadlines_us) / sizeof(deadlines_us[0]); d++) {
+        for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]) && batches[b] <= streams; b++) {
+            test::onnx_batch_config_t config = {model, FRAMES, streams, batches[b], deadlines_us[d], threads,
+                                                pointwise};
+            test::OnnxBatcher batcher(&config);
+            if (!batcher.is_ready()) {
+                return -1;
+            }
+            run_streams(&batcher, streams, 0.1); // warm up
+            batcher.reset_stats();
+            run_streams(&batcher, streams, RUN_SECONDS);
+            test::onnx_batch_stats_t stats;
+            batcher.get_stats(&stats);
+            printf("%6d %12d %11.2f %13.0f %15.2f %15.1f %15.1f\n", batches[b], deadlines_us[d], stats.mean_batch,
+                   stats.blocks_per_s, stats.run_us_per_block, stats.added.p50_us, stats.added.p99_us);
+        }
+    }
+    return 0;
+}
+
+/* Compile Command:
+Linux, with the onnxruntime-linux-x64 release unpacked in $ORT:
+    g++ -O2 onnx_batch_bench.cpp OnnxBatcher.cpp AlgoStats.cpp log.c -I$ORT/include -L$ORT/lib -lonnxruntime \
+        -Wl,-rpath,$ORT/lib -lpthread -o onnx_batch_bench
+    ./onnx_batch_bench [model] [streams] [intra-op threads] [pointwise 0/1]
+reduce_15db.onnx pins its batch dimension to 1 and is batched pointwise, a model exported with a dynamic batch
+dimension runs as [batch, 1024] with pointwise 0.
+*/
@@ -0,0 +1,267 @@
+/* **************************************************************
+ * @Description: FP32 against FP16 model variants through libalgo_onnx.so, and the variant it picks
+ * @Date: 2026-10-20 01:37:45
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+#include "AlgoAPI.hpp"
+#include "AlgoStats.hpp"
+#include "wav.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+#define SAMPLE_RATE 48000
+#define SECONDS 10
+#define WARMUP_BLOCKS 16
+
+// as in algo_onnx.h, whose algo_param_t clashes with the one of AlgoAPI.hpp
+#define PARAM_MODEL SET_PARAM3
+#define MAX_FRAMES 4096
+#define MAX_PATH 512
+#define DEFAULT_MIN_SNR 60.0f
+#define FP16_SUFFIX "_fp16"
+#define MODEL_ENV "ALGO_ONNX_MODEL"
+#define MIN_SNR_ENV "ALGO_ONNX_MIN_SNR"
+#define CACHE_DIR_ENV "ALGO_ONNX_CACHE_DIR"
+#define VARIANT_FILE "algo_onnx_variants"
+
+typedef struct variant_result {
+    double init_ms;
+    double rss_mb;          // resident memory the handle added over init and the first pass
+    double file_kb;
+    double rtf;
+    double msmp_per_s;
+    test::algo_latency_t latency;
+    std::vector<float> output;
+} variant_result_t;
+
+static uint64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static double rss_mb()
+{
+    long pages = 0, resident = 0;
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (fp != NULL) {
+        if (fscanf(fp, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(fp);
+    }
+    return resident * (double)sysconf(_SC_PAGESIZE) / (1 << 20);
+}
+
+// first channel of a 16 bit PCM or 32 bit float wav, or tones and noise rising from -40 dBFS to full scale
+static int load_source(const char *file, std::vector<float> &source)
+{
+    if (file == NULL) {
+        source.resize((size_t)SAMPLE_RATE * SECONDS);
+        uint32_t seed = 12345;
+        for (size_t i = 0; i < source.size(); i++) {
+            double t = (double)i / SAMPLE_RATE;
+            seed = seed * 1664525u + 1013904223u;
+            double sum = 0.4 * sin(2 * M_PI * 220 * t) + 0.3 * sin(2 * M_PI * 1000 * t) +
+                         0.2 * sin(2 * M_PI * 5000 * t) + 0.1 * ((seed >> 8) / 8388608.0 - 1.0);
+            source[i] = (float)(sum * pow(10.0, (-40.0 + 40.0 * i / source.size()) / 20.0));
+        }
+        return 0;
+    }
+
+    WavFile *wav = wav_open(file, WAV_OPEN_READ);
+    if (wav == NULL || wav_err()->code != WAV_OK) {
+        printf("Failed to open %s: %s\n", file, wav_err()->message);
+        return -1;
+    }
+    int channels = wav_get_num_channels(wav);
+    size_t frames = wav_get_length(wav);
+    size_t sample_size = wav_get_sample_size(wav);
+    WavU16 format = wav_get_format(wav);
+    if (!((format == WAV_FORMAT_PCM && sample_size == 2) || (format == WAV_FORMAT_IEEE_FLOAT && sample_size == 4))) {
+        printf("Unsupported wav format %d with %zu bytes per sample\n", format, sample_size);
+        wav_close(wav);
+        return -1;
+    }
+    std::vector<unsigned char> raw(frames * channels * sample_size);
+    frames = wav_read(wav, raw.data(), frames);
+    wav_close(wav);
+
+    source.resize(frames);
+    for (size_t i = 0; i < frames; i++) {
+        if (sample_size == 2) {
+            source[i] = ((const int16_t *)raw.data())[i * channels] / 32768.0f;
+        } else {
+            source[i] = ((const float *)raw.data())[i * channels];
+        }
+    }
+    return 0;
+}
+
+// runs source through model as given, ALGO_ONNX_MIN_SNR below zero keeps the plugin from swapping it
+static int run_variant(test::AlgoAPI *algo, const char *model, const std::vector<float> &source, int block,
+                       variant_result_t *result)
+{
+    setenv(MODEL_ENV, model, 1);
+    setenv(MIN_SNR_ENV, "-1", 1);
+    double rss_before = rss_mb();
+    uint64_t start = now_ns();
+    void *handle = algo->algo_init();
+    result->init_ms = (now_ns() - start) / 1e6;
+    if (handle == NULL) {
+        printf("algo_init with %s failed\n", model);
+        return -1;
+    }
+
+    size_t blocks = source.size() / block;
+    std::vector<float> scratch(block);
+    result->output.assign(blocks * block, 0.0f);
+    for (int b = 0; b < WARMUP_BLOCKS && b < (int)blocks; b++) {
+        algo->algo_process(handle, (void *)&source[b * block], scratch.data(), block);
+    }
+    test::AlgoLatencyHistogram histogram;
+    uint64_t total_ns = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        uint64_t begin = now_ns();
+        int ret = algo->algo_process(handle, (void *)&source[b * block], &result->output[b * block], block);
+        uint64_t ns = now_ns() - begin;
+        if (ret != 0) {
+            printf("algo_process with %s failed: %d\n", model, ret);
+            algo->algo_deinit(handle);
+            return -1;
+        }
+        histogram.record(ns);
+        total_ns += ns;
+    }
+    result->rss_mb = rss_mb() - rss_before;
+    histogram.get_latency(&result->latency);
+    result->rtf = total_ns / 1e9 / ((double)blocks * block / SAMPLE_RATE);
+    result->msmp_per_s = (double)blocks * block / (total_ns / 1e3);
+
+    FILE *fp = fopen(model, "rb");
+    result->file_kb = 0.0;
+    if (fp != NULL) {
+        fseek(fp, 0, SEEK_END);
+        result->file_kb = ftell(fp) / 1024.0;
+        fclose(fp);
+    }
+    algo->algo_deinit(handle);
+    return 0;
+}
+
+// the variant picked for bound, once measured into an empty cache and once found in it
+static int show_choice(test::AlgoAPI *algo, const char *model, float bound)
+{
+    char value[32], chosen[MAX_PATH] = "";
+    double init_ms[2];
+    snprintf(value, sizeof(value), "%.1f", bound);
+    setenv(MODEL_ENV, model, 1);
+    setenv(MIN_SNR_ENV, value, 1);
+    for (int pass = 0; pass < 2; pass++) {
+        uint64_t start = now_ns();
+        void *handle = algo->algo_init();
+        init_ms[pass] = (now_ns() - start) / 1e6;
+        if (handle == NULL) {
+            printf("algo_init with a %.1f dB bound failed\n", bound);
+            return -1;
+        }
+        algo->get_algo_param(handle, PARAM_MODEL, chosen, sizeof(chosen));
+        algo->algo_deinit(handle);
+    }
+    printf("%10.1f %32s %14.1f %14.1f\n", bound, chosen, init_ms[0], init_ms[1]);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        printf("Usage: %s <libalgo_onnx.so> [fp32 model] [input.wav] [block]\n", argv[0]);
+        return -1;
+    }
+    const char *model = argc > 2 ? argv[2] : "reduce_15db.onnx";
+    const char *input = argc > 3 && strcmp(argv[3], "-") != 0 ? argv[3] : NULL;
+    int block = argc > 4 ? atoi(argv[4]) : 1024;
+    if (block <= 0 || block > MAX_FRAMES) {
+        printf("block %d is not in 1..%d\n", block, MAX_FRAMES);
+        return -1;
+    }
+
+    // the sibling name the plugin looks for
+    char fp16[MAX_PATH];
+    const char *dot = strrchr(model, '.');
+    int stem = dot != NULL && strchr(dot, '/') == NULL ? (int)(dot - model) : (int)strlen(model);
+    snprintf(fp16, sizeof(fp16), "%.*s%s%s", stem, model, FP16_SUFFIX, model + stem);
+    const char *variants[2] = {model, fp16};
+
+    std::vector<float> source;
+    if (load_source(input, source) != 0 || source.size() < (size_t)block) {
+        return -1;
+    }
+    test::AlgoAPI *algo = new test::AlgoAPI(argv[1]);
+    if (algo->shared_lib_handle == NULL) {
+        delete algo;
+        return -1;
+    }
+    printf("Source %s: %zu frames, blocks of %d\n", input ? input : "tones and noise, -40 to 0 dBFS", source.size(),
+           block);
+    printf("%32s %9s %8s %8s %9s %9s %8s %9s %11s %9s\n", "variant", "init(ms)", "file(KB)", "rss(MB)", "Msmp/s",
+           "RTF", "p50(us)", "p99(us)", "max abs err", "SNR(dB)");
+
+    variant_result_t results[2];
+    for (int v = 0; v < 2; v++) {
+        if (run_variant(algo, variants[v], source, block, &results[v]) != 0) {
+            delete algo;
+            return -1;
+        }
+        // scored against the FP32 output, the first variant
+        double power = 0.0, noise = 0.0, max_abs = 0.0;
+        for (size_t i = 0; i < results[v].output.size(); i++) {
+            double error = (double)results[v].output[i] - results[0].output[i];
+            power += (double)results[0].output[i] * results[0].output[i];
+            noise += error * error;
+            max_abs = fabs(error) > max_abs ? fabs(error) : max_abs;
+        }
+        double snr = noise > 0.0 ? 10.0 * log10(power / noise) : INFINITY;
+        printf("%32s %9.1f %8.1f %8.1f %9.2f %9.5f %8.1f %9.1f %11.3g %9.1f\n", variants[v], results[v].init_ms,
+               results[v].file_kb, results[v].rss_mb, results[v].msmp_per_s, results[v].rtf,
+               results[v].latency.p50_us, results[v].latency.p99_us, max_abs, snr);
+    }
+
+    // a cache directory of its own so the first init of every bound measures
+    char cache_dir[] = "/tmp/onnx_variant_bench.XXXXXX", cache[sizeof(cache_dir) + sizeof(VARIANT_FILE)];
+    if (mkdtemp(cache_dir) == NULL) {
+        printf("Failed to create a variant cache directory\n");
+        delete algo;
+        return -1;
+    }
+    snprintf(cache, sizeof(cache), "%s/%s", cache_dir, VARIANT_FILE);
+    setenv(CACHE_DIR_ENV, cache_dir, 1);
+    printf("%10s %32s %14s %14s\n", "bound(dB)", "chosen", "measured(ms)", "cached(ms)");
+    const float bounds[] = {40.0f, DEFAULT_MIN_SNR, 80.0f};
+    int failed = 0;
+    for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); b++) {
+        failed |= show_choice(algo, model, bounds[b]);
+    }
+    unlink(cache);
+    rmdir(cache_dir);
+    delete algo;
+    return failed;
+}
+
+/* Compile Command:
+Linux, with libalgo_onnx.so built as in algo_onnx.h and reduce_15db_fp16.onnx next to reduce_15db.onnx:
+    gcc -O2 -c wav.c
+    g++ -O2 onnx_variant_bench.cpp AlgoAPI.cpp AlgoStats.cpp wav.o log.c -ldl -lpthread \
+        -o onnx_variant_bench
+    ./onnx_variant_bench ./libalgo_onnx.so [reduce_15db.onnx] [input.wav or - for the test signal] [block]
+The FP16 SNR is against the FP32 output of the same input. A variant's rss counts what its session and first
+pass added to the process, the model file size is listed beside it.
+*/
@@ -127,3 +127,8 @@ int main(int argc, char *argv[])
 
     return 0;
 }
+
+/* Compile Command:
+    g++ parseChimeConfigXMLAndGetFilePath.cpp log.c -I/usr/include/libxml2 -lxml2 -lpthread -o parseChimeConfigXMLAndGetFilePath
+    ./parseChimeConfigXMLAndGetFilePath chime3D.xml <soundposition>
+*/
@@ -439,3 +439,7 @@ int main(int argc, char **argv)
 
     return 0;
 }
+
+/* Compile Command:
+    gcc pcm_to_wave.c log.c -lpthread -o pcm_to_wave
+*/
@@ -90,3 +90,8 @@ int main() {
 
     return 0;
 }
+
+/* Compile Command:
+Linux:
+    g++ read_from_shared_memory.cpp log.c -lpthread -o read_from_shared_memory
+*/
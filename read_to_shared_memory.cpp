@@ -158,3 +158,8 @@ int main() {
 
     return 0;
 }
+
+/* Compile Command:
+Linux:
+    g++ read_to_shared_memory.cpp log.c -lpthread -o read_to_shared_memory
+*/
@@ -1,3 +1,4 @@
+#include "../log.h"
 #include "portaudio.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -67,12 +68,12 @@ static int paCallback(
         if (ctx->format.bitsPerSample == 16) {
             // 16-bit PCM processing (amplitude inversion)
             size_t samples = bytesToCopy / sizeof(short);
-            printf("[PROCESS] Applying amplitude inversion to %zu 16-bit samples\n", samples);
+            LOGI_RATE(1, "[PROCESS] Applying amplitude inversion to %zu 16-bit samples", samples);
             preprocess_pcm_buffer((short *)output, samples);
         } else if (ctx->format.bitsPerSample == 32) {
             // 32-bit float processing (amplitude inversion)
             size_t samples = bytesToCopy / sizeof(float);
-            printf("[PROCESS] Applying amplitude inversion to %zu 32-bit float samples\n", samples);
+            LOGI_RATE(1, "[PROCESS] Applying amplitude inversion to %zu 32-bit float samples", samples);
             preprocess_float_buffer((float *)output, samples);
         }
 
@@ -383,10 +384,10 @@ int main(int argc, char *argv[])
 
 /* Compile Command:
     Linux:
-        gcc portAudio_play_wav.c  -lportaudio -o portAudio_play_wav
+        gcc portAudio_play_wav.c ../log.c -lportaudio -lpthread -o portAudio_play_wav
     Windows:
         call "C:\Program Files\Microsoft Visual Studio\2022\Community\VC\Auxiliary\Build\vcvars64.bat"
-        cl portAudio_play_wav.c ^
+        cl portAudio_play_wav.c ..\log.c ^
         /I "portaudio-19.7.0\include" ^
         /link /LIBPATH:"portaudio-19.7.0\libs\x64\Release" portaudio_x64.lib
 */
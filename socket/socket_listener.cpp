@@ -6,6 +6,7 @@
  * Copyright (c) 2024 by Panda-Young, All Rights Reserved.
  **************************************************************************/
 
+#include "../log.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,7 +35,7 @@ void ProcessClient(LPVOID lpParam)
         if (rev_size <= 0) {
             break;
         }
-        printf("received %d Bytes.\n", rev_size);
+        LOGI_EVERY_N(1000, "received %d Bytes.", rev_size);
 
 #if DEBUG_DATA
         for (int i = 0; i < rev_size; i++) {
@@ -110,7 +111,7 @@ void ProcessClient(int clientSocket)
         if (rev_size <= 0) {
             break;
         }
-        printf("received %d Bytes.\n", rev_size);
+        LOGI_EVERY_N(1000, "received %d Bytes.", rev_size);
 #if DEBUG_DATA
         for (int i = 0; i < rev_size; i++) {
             printf("%02x ", buffer[i]);
@@ -160,3 +161,10 @@ int main()
     return 0;
 }
 #endif
+
+/* Compile Command:
+    Linux:
+        g++ socket_listener.cpp ../log.c -lpthread -o socket_listener
+    MinGW:
+        g++ socket_listener.cpp ../log.c -lws2_32 -o socket_listener.exe
+*/
@@ -0,0 +1,227 @@
+/***************************************************************************
+ * Description: streaming STFT analysis and overlap-add resynthesis on planar buffers
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 23:12:40
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+/*
+ * Input collects in a buffer of one frame per channel. It starts out filled
+ * with fft_size - hop samples of silence, so every hop samples fed in
+ * complete a frame. The frame is windowed, transformed, handed to the
+ * spectral callback, transformed back, windowed again and added into the
+ * overlap-add accumulator. The first hop samples of the accumulator have
+ * then had every frame that overlaps them and become the output. The first
+ * of them goes out in place of the sample that completed the frame, the
+ * rest during the next hop. That fixes the latency at fft_size - 1 samples,
+ * the least a fixed delay allows when blocks may be of any length and a
+ * frame can complete on their last sample.
+ *
+ * Blocks are copied in and out in runs up to the next frame boundary rather
+ * than sample by sample, and the per frame work is window multiplies,
+ * multiply-adds and moves over whole arrays, all restrict-qualified loops
+ * the compiler vectorizes.
+ *
+ * Sums of shifted windows are flat only for particular window and hop
+ * pairs. Instead of insisting on those, the synthesis window is divided by
+ * the sum of analysis times synthesis over the frames that overlap each
+ * sample, which is periodic in the hop when the hop divides the frame. The
+ * 1 / fft_size of the unnormalized inverse FFT goes in there as well.
+ */
+
+#include "stft.h"
+#include "log.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__)
+#define RESTRICT __restrict__
+#else
+#define RESTRICT
+#endif
+
+#define STRIDE_FLOATS 16 // 64 bytes
+#define MIN_OVERLAP_SUM 1e-3
+
+static double window_value(stft_window_t window, int n, int size)
+{
+    double phase = 2.0 * M_PI * n / size;
+    switch (window) {
+    case STFT_WINDOW_HANN:
+        return 0.5 - 0.5 * cos(phase);
+    case STFT_WINDOW_SQRT_HANN:
+        return sqrt(0.5 - 0.5 * cos(phase));
+    case STFT_WINDOW_HAMMING:
+        return 0.54 - 0.46 * cos(phase);
+    case STFT_WINDOW_BLACKMAN:
+        return 0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase);
+    case STFT_WINDOW_RECT:
+    default:
+        return 1.0;
+    }
+}
+
+static int make_windows(stft_t *stft)
+{
+    int size = stft->config.fft_size, hop = stft->config.hop;
+    for (int n = 0; n < size; n++) {
+        stft->analysis[n] = (float)window_value(stft->config.analysis, n, size);
+    }
+    for (int r = 0; r < hop; r++) {
+        double sum = 0;
+        for (int n = r; n < size; n += hop) {
+            sum += window_value(stft->config.analysis, n, size) * window_value(stft->config.synthesis, n, size);
+        }
+        if (sum < MIN_OVERLAP_SUM) {
+            LOGE("stft: windows %d and %d leave sample %d of every hop of %d uncovered", stft->config.analysis,
+                 stft->config.synthesis, r, hop);
+            return -1;
+        }
+        for (int n = r; n < size; n += hop) {
+            stft->synthesis[n] = (float)(window_value(stft->config.synthesis, n, size) / (sum * size));
+        }
+    }
+    return 0;
+}
+
+int stft_init(stft_t *stft, const stft_config_t *config)
+{
+    memset(stft, 0, sizeof(*stft));
+    int size = config->fft_size, hop = config->hop;
+    if (size <= 0 || size % 2 || hop <= 0 || hop > size || size % hop || config->channels <= 0) {
+        LOGE("stft: frame %d, hop %d, %d channels not supported, the hop must divide an even frame", size, hop,
+             config->channels);
+        return -1;
+    }
+    stft->config = *config;
+    stft->bins = size / 2 + 1;
+    stft->stride = (size + STRIDE_FLOATS - 1) / STRIDE_FLOATS * STRIDE_FLOATS;
+
+    stft->forward = fft_plan_cache_get(size, FFT_R2C, 0);
+    stft->inverse = fft_plan_cache_get(size, FFT_C2R, 0);
+    if (stft->forward == NULL || stft->inverse == NULL) {
+        LOGE("stft: no %d point FFT", size);
+        stft_free(stft);
+        return -1;
+    }
+    size_t planar = (size_t)config->channels * stft->stride;
+    stft->analysis = fftwf_alloc_real(size);
+    stft->synthesis = fftwf_alloc_real(size);
+    stft->input = fftwf_alloc_real(planar);
+    stft->accum = fftwf_alloc_real(planar);
+    stft->output = fftwf_alloc_real(planar);
+    stft->frame = fftwf_alloc_real(size);
+    stft->spectra = (fftwf_complex **)calloc(config->channels, sizeof(fftwf_complex *));
+    int ok = stft->analysis && stft->synthesis && stft->input && stft->accum && stft->output && stft->frame &&
+             stft->spectra;
+    for (int ch = 0; ok && ch < config->channels; ch++) {
+        stft->spectra[ch] = fftwf_alloc_complex(stft->bins);
+        ok = stft->spectra[ch] != NULL;
+    }
+    if (!ok) {
+        LOGE("stft: out of memory for %d channels of %d samples", config->channels, size);
+        stft_free(stft);
+        return -1;
+    }
+    if (make_windows(stft) != 0) {
+        stft_free(stft);
+        return -1;
+    }
+    stft_reset(stft);
+    return 0;
+}
+
+void stft_free(stft_t *stft)
+{
+    if (stft->spectra) {
+        for (int ch = 0; ch < stft->config.channels; ch++) {
+            fftwf_free(stft->spectra[ch]);
+        }
+        free(stft->spectra);
+    }
+    fftwf_free(stft->analysis);
+    fftwf_free(stft->synthesis);
+    fftwf_free(stft->input);
+    fftwf_free(stft->accum);
+    fftwf_free(stft->output);
+    fftwf_free(stft->frame);
+    // the plans stay in the cache
+    memset(stft, 0, sizeof(*stft));
+}
+
+void stft_reset(stft_t *stft)
+{
+    size_t planar = (size_t)stft->config.channels * stft->stride;
+    memset(stft->input, 0, planar * sizeof(float));
+    memset(stft->accum, 0, planar * sizeof(float));
+    memset(stft->output, 0, planar * sizeof(float));
+    stft->fill = stft->config.fft_size - stft->config.hop;
+}
+
+int stft_latency(const stft_t *stft)
+{
+    return stft->config.fft_size - 1;
+}
+
+static void window_mul(float *RESTRICT out, const float *RESTRICT in, const float *RESTRICT window, int count)
+{
+    for (int i = 0; i < count; i++) {
+        out[i] = in[i] * window[i];
+    }
+}
+
+static void window_mac(float *RESTRICT accum, const float *RESTRICT in, const float *RESTRICT window, int count)
+{
+    for (int i = 0; i < count; i++) {
+        accum[i] += in[i] * window[i];
+    }
+}
+
+static void run_frame(stft_t *stft)
+{
+    int size = stft->config.fft_size, hop = stft->config.hop, channels = stft->config.channels;
+    for (int ch = 0; ch < channels; ch++) {
+        window_mul(stft->frame, stft->input + (size_t)ch * stft->stride, stft->analysis, size);
+        fftwf_execute_dft_r2c(stft->forward->plan, stft->frame, stft->spectra[ch]);
+    }
+    if (stft->config.process) {
+        stft->config.process(stft->config.user, stft->spectra, channels, stft->bins);
+    }
+    for (int ch = 0; ch < channels; ch++) {
+        float *input = stft->input + (size_t)ch * stft->stride;
+        float *accum = stft->accum + (size_t)ch * stft->stride;
+        fftwf_execute_dft_c2r(stft->inverse->plan, stft->spectra[ch], stft->frame);
+        window_mac(accum, stft->frame, stft->synthesis, size);
+        memcpy(stft->output + (size_t)ch * stft->stride, accum, hop * sizeof(float));
+        memmove(accum, accum + hop, (size - hop) * sizeof(float));
+        memset(accum + size - hop, 0, hop * sizeof(float));
+        memmove(input, input + hop, (size - hop) * sizeof(float));
+    }
+}
+
+void stft_process(stft_t *stft, const float *const *in, float *const *out, int frames)
+{
+    int size = stft->config.fft_size, start = size - stft->config.hop;
+    for (int done = 0; done < frames;) {
+        int count = size - stft->fill < frames - done ? size - stft->fill : frames - done;
+        // every sample but the last of a frame reads from the frame before
+        int previous = size - 1 - stft->fill < count ? size - 1 - stft->fill : count;
+        for (int ch = 0; ch < stft->config.channels; ch++) {
+            // input first, so out may be the very buffer it came from
+            memcpy(stft->input + (size_t)ch * stft->stride + stft->fill, in[ch] + done, count * sizeof(float));
+            memcpy(out[ch] + done, stft->output + (size_t)ch * stft->stride + stft->fill - start + 1,
+                   previous * sizeof(float));
+        }
+        stft->fill += count;
+        done += count;
+        if (stft->fill == size) {
+            run_frame(stft);
+            for (int ch = 0; ch < stft->config.channels; ch++) {
+                out[ch][done - 1] = stft->output[(size_t)ch * stft->stride];
+            }
+            stft->fill = start;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/***************************************************************************
+ * Description: streaming STFT analysis and overlap-add resynthesis on planar buffers
+ * version: 0.1.0
+ * Author: Panda-Young
+ * Date: 2026-10-19 23:12:40
+ * Copyright (c) 2026 by Panda-Young, All Rights Reserved.
+ **************************************************************************/
+
+#ifndef _STFT_H
+#define _STFT_H
+
+#include "fft_plan_cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    STFT_WINDOW_HANN,      // periodic
+    STFT_WINDOW_SQRT_HANN, // on both sides, a Hann in total
+    STFT_WINDOW_HAMMING,
+    STFT_WINDOW_BLACKMAN,
+    STFT_WINDOW_RECT
+} stft_window_t;
+
+/* Called once per hop with the spectra of every channel, fft_size / 2 + 1
+ * bins each. Whatever it leaves in them is resynthesized. */
+typedef void (*stft_spectrum_fn)(void *user, fftwf_complex **spectra, int channels, int bins);
+
+typedef struct stft_config {
+    int fft_size;          // frame length, even
+    int hop;               // samples between frames, must divide fft_size
+    int channels;
+    stft_window_t analysis;
+    stft_window_t synthesis;
+    stft_spectrum_fn process; // NULL passes the spectra through unchanged
+    void *user;
+} stft_config_t;
+
+typedef struct stft {
+    stft_config_t config;
+    int bins;
+    int stride;            // floats between channels, padded to cache lines
+    int fill;              // samples in input, from fft_size - hop up to fft_size
+    const fft_cached_plan_t *forward;
+    const fft_cached_plan_t *inverse;
+    float *analysis;       // fft_size
+    float *synthesis;      // fft_size, with the overlap-add and 1 / fft_size gain folded in
+    float *input;          // channels * stride, the last fft_size input samples
+    float *accum;          // channels * stride, overlap-add of frames not finished yet
+    float *output;         // channels * stride, the hop of finished samples being read out
+    float *frame;          // fft_size, windowed time signal of one channel
+    fftwf_complex **spectra;
+} stft_t;
+
+/* Allocates everything the stream will ever need and takes the FFT plans
+ * from fft_plan_cache. The synthesis window is normalized so that the
+ * overlapping analysis and synthesis windows sum to one at every sample,
+ * so any window pair whose product covers every sample reconstructs the
+ * input exactly. Returns 0, or -1 with nothing allocated. */
+int stft_init(stft_t *stft, const stft_config_t *config);
+void stft_free(stft_t *stft);
+
+// clears the history, the next output is latency samples of silence again
+void stft_reset(stft_t *stft);
+
+// fft_size - 1, the delay of the output behind the input
+int stft_latency(const stft_t *stft);
+
+/* Feeds frames samples of each channel in and takes as many out, planar
+ * like WavInput::GetAudio. frames may be any count, a frame is analyzed
+ * and resynthesized every time hop new samples have arrived, so output is
+ * the input delayed by exactly stft_latency samples whatever the block
+ * sizes. in and out may be the same buffers. No allocation and no lock. */
+void stft_process(stft_t *stft, const float *const *in, float *const *out, int frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _STFT_H
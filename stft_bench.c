@@ -0,0 +1,164 @@
+/* **************************************************************
+ * @Description: reconstruction and cost of the streaming STFT
+ * @Date: 2026-10-19 23:31:08
+ * @Version: 0.1.0
+ * @Author: 1641140221@qq.com
+ * @Copyright (c) 2026 by @Panda-Young, All Rights Reserved.
+ **************************************************************/
+// gcc -O3 -march=native stft_bench.c stft.c fft_plan_cache.c log.c -lfftw3f -lm -lpthread -o stft_bench
+// ./stft_bench [fft size] [hop] [channels]
+// With the spectra passed through unchanged the output has to be the input
+// delayed by the latency, fed in blocks of random length the way audio
+// callbacks and WavInput::GetAudio hand them over.
+
+#include "stft.h"
+#include "log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_FFT_SIZE 1024
+#define DEFAULT_HOP 256
+#define DEFAULT_CHANNELS 2
+#define SAMPLE_RATE 48000
+#define RUN_SECONDS 0.5
+#define CHECK_SAMPLES 20000
+#define MAX_CHANNELS 16
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static float noise(unsigned *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return (float)((*state >> 8) / 16777216.0 * 2.0 - 1.0);
+}
+
+// half the spectrum, so the check also sees the callback's result come through
+static void halve(void *user, fftwf_complex **spectra, int channels, int bins)
+{
+    (void)user;
+    for (int ch = 0; ch < channels; ch++) {
+        for (int i = 0; i < bins; i++) {
+            spectra[ch][i][0] *= 0.5f;
+            spectra[ch][i][1] *= 0.5f;
+        }
+    }
+}
+
+static double check(stft_config_t config)
+{
+    stft_t stft;
+    config.process = halve;
+    if (stft_init(&stft, &config) != 0) {
+        return INFINITY;
+    }
+    float *in[MAX_CHANNELS], *out[MAX_CHANNELS];
+    unsigned seed = 5;
+    for (int ch = 0; ch < config.channels; ch++) {
+        in[ch] = (float *)malloc(CHECK_SAMPLES * sizeof(float));
+        out[ch] = (float *)malloc(CHECK_SAMPLES * sizeof(float));
+        for (int i = 0; i < CHECK_SAMPLES; i++) {
+            in[ch][i] = noise(&seed);
+        }
+    }
+    for (int done = 0; done < CHECK_SAMPLES;) {
+        int block = 1 + rand() % (2 * config.fft_size);
+        block = block < CHECK_SAMPLES - done ? block : CHECK_SAMPLES - done;
+        const float *block_in[MAX_CHANNELS];
+        float *block_out[MAX_CHANNELS];
+        for (int ch = 0; ch < config.channels; ch++) {
+            block_in[ch] = in[ch] + done;
+            block_out[ch] = out[ch] + done;
+        }
+        stft_process(&stft, block_in, block_out, block);
+        done += block;
+    }
+    int latency = stft_latency(&stft);
+    double worst = 0;
+    for (int ch = 0; ch < config.channels; ch++) {
+        for (int i = 0; i < CHECK_SAMPLES; i++) {
+            float expect = i < latency ? 0.0f : 0.5f * in[ch][i - latency];
+            worst = fmax(worst, fabs(out[ch][i] - expect));
+        }
+        free(in[ch]);
+        free(out[ch]);
+    }
+    stft_free(&stft);
+    return worst;
+}
+
+int main(int argc, char *argv[])
+{
+    stft_config_t config = {0};
+    config.fft_size = argc > 1 ? atoi(argv[1]) : DEFAULT_FFT_SIZE;
+    config.hop = argc > 2 ? atoi(argv[2]) : DEFAULT_HOP;
+    config.channels = argc > 3 ? atoi(argv[3]) : DEFAULT_CHANNELS;
+    if (config.channels <= 0 || config.channels > MAX_CHANNELS) {
+        printf("Usage: %s [fft size] [hop] [channels up to %d]\n", argv[0], MAX_CHANNELS);
+        return -1;
+    }
+    fft_plan_cache_init(NULL);
+
+    static const struct {
+        stft_window_t analysis, synthesis;
+        const char *name;
+    } pairs[] = {
+        {STFT_WINDOW_SQRT_HANN, STFT_WINDOW_SQRT_HANN, "sqrt hann / sqrt hann"},
+        {STFT_WINDOW_HANN, STFT_WINDOW_RECT, "hann / rect"},
+        {STFT_WINDOW_HAMMING, STFT_WINDOW_HAMMING, "hamming / hamming"},
+        {STFT_WINDOW_BLACKMAN, STFT_WINDOW_HANN, "blackman / hann"},
+    };
+    for (size_t p = 0; p < sizeof(pairs) / sizeof(pairs[0]); p++) {
+        stft_config_t pair = config;
+        pair.analysis = pairs[p].analysis;
+        pair.synthesis = pairs[p].synthesis;
+        double error = check(pair);
+        printf("%-24s largest difference to the delayed input %.2e\n", pairs[p].name, error);
+        if (error > 1e-4) {
+            printf("reconstruction is wrong\n");
+            return -1;
+        }
+    }
+
+    stft_t stft;
+    config.analysis = config.synthesis = STFT_WINDOW_SQRT_HANN;
+    if (stft_init(&stft, &config) != 0) {
+        return -1;
+    }
+    const int block = 480; // 10 ms, not a multiple of the hop
+    float *buffers[MAX_CHANNELS];
+    unsigned seed = 1;
+    for (int ch = 0; ch < config.channels; ch++) {
+        buffers[ch] = (float *)malloc(block * sizeof(float));
+        for (int i = 0; i < block; i++) {
+            buffers[ch][i] = noise(&seed);
+        }
+    }
+    long blocks = 0;
+    double elapsed, start = now_seconds();
+    do {
+        for (int b = 0; b < 16; b++) {
+            stft_process(&stft, (const float *const *)buffers, buffers, block);
+        }
+        blocks += 16;
+        elapsed = now_seconds() - start;
+    } while (elapsed < RUN_SECONDS);
+    double per_sample = elapsed / blocks / block;
+    printf("fft %d, hop %d, %d channels, latency %d samples (%.1f ms)\n", config.fft_size, config.hop,
+           config.channels, stft_latency(&stft), 1e3 * stft_latency(&stft) / SAMPLE_RATE);
+    printf("%.1f ns per sample per channel, %.2f%% of one core at 48 kHz\n", per_sample * 1e9 / config.channels,
+           100.0 * per_sample * SAMPLE_RATE);
+    for (int ch = 0; ch < config.channels; ch++) {
+        free(buffers[ch]);
+    }
+    stft_free(&stft);
+    fft_plan_cache_cleanup();
+    return 0;
+}
@@ -2,7 +2,6 @@
 #include <vector>
 #include <iostream>
 #include <array>
-#include <windows.h>
 #include <stdexcept>
 #include <random>
 
@@ -14,16 +13,16 @@ int main() {
         std::cout << "[INFO] Creating session options..." << std::endl;
         Ort::SessionOptions session_options;
 
-        std::wstring model_path = L"reduce_15db.onnx";
-        std::wcout << L"[INFO] Loading model: " << model_path << std::endl;
-        Ort::Session session(env, model_path.c_str(), session_options);
+        const ORTCHAR_T* model_path = ORT_TSTR("reduce_15db.onnx");
+        std::cout << "[INFO] Loading model: reduce_15db.onnx" << std::endl;
+        Ort::Session session(env, model_path, session_options);
 
         // Model input information
         size_t num_input_nodes = session.GetInputCount();
         std::cout << "[INFO] Model has " << num_input_nodes << " input(s)." << std::endl;
         for (size_t i = 0; i < num_input_nodes; ++i) {
-            char* input_name = session.GetInputNameAllocated(i, Ort::AllocatorWithDefaultOptions()).get();
-            std::cout << "[INFO] Input[" << i << "] name: " << input_name << std::endl;
+            Ort::AllocatedStringPtr input_name = session.GetInputNameAllocated(i, Ort::AllocatorWithDefaultOptions());
+            std::cout << "[INFO] Input[" << i << "] name: " << input_name.get() << std::endl;
         }
 
         // Set the input length to 1*1024
@@ -98,5 +97,8 @@ int main() {
 }
 
 /* Compile with:
+Linux, with the onnxruntime-linux-x64 release unpacked in $ORT:
+    g++ test_reduce_db_onnx.cpp -I$ORT/include -L$ORT/lib -lonnxruntime -Wl,-rpath,$ORT/lib -o test_reduce_db_onnx && ./test_reduce_db_onnx
+Windows:
     cl test_reduce_db_onnx.cpp /I C:\Users\young\Desktop\onnxruntime-win-x64-1.17.0\include /link /LIBPATH:C:\Users\young\Desktop\onnxruntime-win-x64-1.17.0\lib onnxruntime.lib && test_reduce_db_onnx.exe
 */
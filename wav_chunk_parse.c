@@ -259,3 +259,7 @@ int main(int argc, char *argv[])
 
     return 0;
 }
+
+/* Compile Command:
+    gcc wav_chunk_parse.c log.c -lpthread -o wav_chunk_parse && ./wav_chunk_parse sample.wav
+*/